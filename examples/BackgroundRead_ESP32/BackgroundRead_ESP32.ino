@@ -16,9 +16,9 @@
  *
  * Detailed documentation can be found on the GitHub Wiki pages at
  * https://github.com/Zanduino/INA/wiki \n\n Since the INA library allows multiple devices of
- * different types and this program demonstrates interrupts and background processing, it will limit
- * itself to using the first INA226 detected. This is easily changed in the if another device type
- * or device number to test is required.\n
+ * different types, the program samples every device found which can signal a finished conversion on
+ * its ALERT pin. The ALERT pins are open-drain, so those of several devices can be wired together
+ * to the one interrupt pin.\n
  *
  * This example is for a INA226 set up to measure a 5-Volt load with a 0.1Ohm resistor in place,
  * this is the same setup that can be found in the Adafruit INA226 breakout board.  The complex
@@ -29,10 +29,10 @@
  * information is returned using 32-bit integers the precision remains the same.\n The INA226 is set
  * up to measure using the maximum conversion length (and maximum accuracy) and then average those
  * readings 64 times. This results in readings taking 8.244ms x 64 = 527.616ms or just less than 2
- * times a second. The pin-change interrupt handler is called when a reading is finished and the
- * INA226 pulls the pin down to ground, it resets the pin status and adds the readings to the global
- * variables. The main program will do whatever processing it has to and every 5 seconds it will
- * display the current averaged readings and reset them.\n
+ * times a second. When a reading is finished the INA226 pulls the pin down to ground and the
+ * interrupt handler only passes this on to the "INA_AlertSampler", which makes no I2C transfers in
+ * the handler. The main program collects the readings with the sampler, adds them to the sums and
+ * every 10 readings it will display the averaged readings and reset them.\n
  *
  * The datasheet for the INA226 can be found at http://www.ti.com/lit/ds/symlink/INA226.pdf and it
  * contains the information required in order to hook up the device. Unfortunately it comes as a
@@ -82,28 +82,22 @@
 /**************************************************************************************************
 ** Declare program Constants, global variables and instantiate classes                           **
 **************************************************************************************************/
-INA_Class         INA;                          ///< INA class instantiation
-const uint8_t     INA_ALERT_PIN   = A0;         ///< Pin-Change used for INA "ALERT" functionality
-const uint32_t    SERIAL_SPEED    = 115200;     ///< Use fast serial speed
-volatile uint8_t  deviceNumber    = UINT8_MAX;  ///< Device Number to use in example
-volatile uint64_t sumBusMillVolts = 0;          ///< Sum of bus voltage readings
-volatile int64_t  sumBusMicroAmps = 0;          ///< Sum of bus amperage readings
-volatile uint8_t  readings        = 0;          ///< Number of measurements taken
-portMUX_TYPE      mux             = portMUX_INITIALIZER_UNLOCKED;  ///< Synchronization variable
+INA_Class        INA;                       ///< INA class instantiation
+INA_AlertSampler sampler(INA);              ///< Collects the readings signalled on the ALERT pin
+const uint8_t    INA_ALERT_PIN   = A0;      ///< Pin-Change used for INA "ALERT" functionality
+const uint32_t   SERIAL_SPEED    = 115200;  ///< Use fast serial speed
+uint8_t          devicesFound    = 0;       ///< Number of devices found
+uint64_t         sumBusMillVolts = 0;       ///< Sum of bus voltage readings
+int64_t          sumBusMicroAmps = 0;       ///< Sum of bus amperage readings
+uint8_t          readings        = 0;       ///< Number of measurements taken
 
 void IRAM_ATTR InterruptHandler() {
   /*!
     @brief Interrupt service routine for the INA pin
-    @details Routine is called whenever the INA_ALERT_PIN changes value
+    @details Routine is called on the falling edge of the INA_ALERT_PIN, it only passes this on to
+             the sampler, the devices are read in "loop()"
   */
-  portENTER_CRITICAL_ISR(&mux);
-  sei();                                                  // Enable interrupts (for I2C calls)
-  sumBusMillVolts += INA.getBusMilliVolts(deviceNumber);  // Add current value to sum
-  sumBusMicroAmps += INA.getBusMicroAmps(deviceNumber);   // Add current value to sum
-  readings++;
-  INA.waitForConversion(deviceNumber);  // Wait for conv and reset interrupt
-  cli();                                // Disable interrupts
-  portEXIT_CRITICAL_ISR(&mux);
+  sampler.alertISR();  // Record the time of the ALERT
 }  // of ISR for handling interrupts
 
 void setup() {
@@ -115,49 +109,47 @@ void setup() {
    @return   void
   */
   pinMode(INA_ALERT_PIN, INPUT_PULLUP);
-  attachInterrupt(digitalPinToInterrupt(INA_ALERT_PIN), InterruptHandler, FALLING);
   Serial.begin(SERIAL_SPEED);
   Serial.print(F("\n\nBackground INA Read V1.0.1\n"));
-  uint8_t devicesFound = 0;
-  while (deviceNumber == UINT8_MAX)  // Loop until we find the first device
+  uint8_t devicesSampled = 0;
+  while (devicesSampled == 0)  // Loop until we find a device with an ALERT pin
   {
     devicesFound = INA.begin(1, 100000);  // +/- 1 Amps maximum for 0.1 Ohm resistor
-    Serial.println(INA.getDeviceName(devicesFound - 1));
-    for (uint8_t i = 0; i < devicesFound; i++) {
-      /* Change the "INA226" in the following statement to whatever device you have attached and
-         want to measure */
-      if (strcmp(INA.getDeviceName(i), "INA219") == 0) {
-        deviceNumber = i;
-        INA.reset(deviceNumber);  // Reset device to default settings
-        break;
-      }  // of if-then we have found an INA226
-    }    // of for-next loop through all devices found
-    if (deviceNumber == UINT8_MAX) {
-      Serial.print(F("No INA found. Waiting 5s and retrying...\n"));
+    INA.reset();                          // Reset devices to default settings
+    INA.configure(INA_MODE_CONTINUOUS_BOTH, 64, 8244, 8244);  // Continuous, 64 averages, 8.244ms
+    devicesSampled = sampler.begin();     // Make the alert pins go low on finish
+    if (devicesSampled == 0) {
+      Serial.print(F("No INA with an ALERT pin found. Waiting 5s and retrying...\n"));
       delay(5000);
-    }  // of if-then no INA226 found
-  }    // of if-then no device found
-  Serial.print(F("Found INA at device number "));
-  Serial.println(deviceNumber);
-  Serial.println();
-  INA.setAveraging(64, deviceNumber);                   // Average each reading 64 times
-  INA.setBusConversion(8244, deviceNumber);             // Maximum conversion time 8.244ms
-  INA.setShuntConversion(8244, deviceNumber);           // Maximum conversion time 8.244ms
-  INA.setMode(INA_MODE_CONTINUOUS_BOTH, deviceNumber);  // Bus/shunt measured continuously
-  INA.alertOnConversion(true, deviceNumber);            // Make alert pin go low on finish
+    }  // of if-then no device found
+  }    // of while-loop no device found
+  Serial.print(F("Sampling "));
+  Serial.print(devicesSampled);
+  Serial.print(F(" device(s)\n\n"));
+  attachInterrupt(digitalPinToInterrupt(INA_ALERT_PIN), InterruptHandler, FALLING);
 }  // of method setup()
 
 void loop() {
   /*!
    @brief    Arduino method for the main program loop
    @details  This is the main program for the Arduino IDE, it is called in an infinite loop. The
-             INA226 measurements are triggered by the interrupt handler each time a conversion is
-             ready and stored in variables. The main program doesn't call any INA library functions,
-             that is done in the interrupt handler. Each time 10 readings have been collected the
-             program will output the averaged values and measurements resume from that point onwards
+             interrupt handler only records that a conversion has finished, the sampler reads the
+             devices when "service()" is called here and the readings are added to the sums. Each
+             time 10 readings have been collected the program will output the averaged values and
+             measurements resume from that point onwards
    @return   void
   */
-  static long lastMillis = millis();  // Store the last time we printed something
+  static long    lastMillis = millis();  // Store the last time we printed something
+  inaMeasurement measurement;            // Readings of one device
+  if (sampler.service()) {               // Read the devices which have finished a conversion
+    for (uint8_t i = 0; i < devicesFound; i++) {
+      if (sampler.read(measurement, i)) {
+        sumBusMillVolts += measurement.busMilliVolts;  // Add current value to sum
+        sumBusMicroAmps += measurement.busMicroAmps;   // Add current value to sum
+        readings++;
+      }  // of if-then device has a new reading
+    }    // of for-next each device
+  }      // of if-then new readings
   if (readings >= 10) {
     Serial.print(F("Averaging readings taken over "));
     Serial.print((float)(millis() - lastMillis) / 1000, 2);
@@ -166,11 +158,9 @@ void loop() {
     Serial.print(F("V\nBus amperage:  "));
     Serial.print((float)sumBusMicroAmps / readings / 1000.0, 4);
     Serial.print(F("mA\n\n"));
-    lastMillis = millis();
-    cli();  // Disable interrupts to reset values
+    lastMillis      = millis();
     readings        = 0;
     sumBusMillVolts = 0;
     sumBusMicroAmps = 0;
-    sei();  // Enable interrupts again
-  }         // of if-then we've reached the required amount of readings
+  }  // of if-then we've reached the required amount of readings
 }  // of method loop()
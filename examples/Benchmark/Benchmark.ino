@@ -0,0 +1,126 @@
+/*!
+ @file Benchmark.ino
+
+ @brief Example program for the INA Library measuring the time taken by the library calls
+
+ @section Benchmark_section Description
+
+ Program to measure how long the INA library takes to return readings when more than one device is
+ attached. When started, the library searches the I2C bus for all INA2xx devices and then the
+ program repeatedly times the "getBusMicroAmps()" call, first reading the same device over and over
+ and then alternating between all devices found, which is the typical pattern when monitoring many
+ power rails in a loop. The results are displayed as the average number of microseconds per call.\n\n
+
+ Since every library call also includes the I2C transactions to the device, the difference between
+ the two figures shows the overhead of switching between devices. With the resident device table
+ which "begin()" builds there should be no measurable difference between the two, earlier versions
+ of the library reloaded the device's data from EEPROM and recomputed it on every device change.\n\n
+
+ The program also compares reading all 4 values of a device using the individual "getBus...()" and
+ "getShunt...()" calls against a single "readMeasurement()" call, which only reads each of the
+ device's registers once.\n\n
+
+ Detailed documentation can be found on the GitHub Wiki pages at
+ https://github.com/Zanduino/INA/wiki \n\n This example is for INA devices set up to measure a
+ 5-Volt load with a 0.1 Ohm resistor in place, this is the same setup that can be found in the
+ Adafruit INA219 breakout board.
+
+ @section Benchmark_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+
+#if ARDUINO >= 100  // Arduino IDE versions before 100 need to use the older library
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+#include <INA.h>  // Zanshin INA Library
+
+/**************************************************************************************************
+** Declare program constants, global variables and instantiate INA class                         **
+**************************************************************************************************/
+const uint32_t SERIAL_SPEED{115200};     ///< Use fast serial speed
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint16_t ITERATIONS{1000};         ///< Number of calls to time for each measurement
+uint8_t        devicesFound{0};          ///< Number of INAs found
+INA_Class      INA;                      ///< INA class instantiation to use EEPROM
+
+void setup() {
+  /*!
+   * @brief    Arduino method called once at startup to initialize the system
+   * @details  This is an Arduino IDE method which is called first upon boot or restart. It is only
+   *           called one time and then control goes to the "loop()" method, from which control
+   *           never returns. The serial port is initialized and the INA.begin() method called to
+   *           find all INA devices on the I2C bus.
+   * @return   void
+   */
+  Serial.begin(SERIAL_SPEED);
+#ifdef __AVR_ATmega32U4__  // If a 32U4 processor, then wait 2 seconds to initialize serial port
+  delay(2000);
+#endif
+  Serial.print(F("\n\nINA Benchmark V1.0.0\n"));
+  devicesFound = INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);  // Expected max Amp & shunt resistance
+  while (devicesFound == 0) {
+    Serial.println(F("No INA device found, retrying in 10 seconds..."));
+    delay(10000);                                             // Wait 10 seconds before retrying
+    devicesFound = INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);  // Expected max Amp & shunt resistance
+  }                                                           // while no devices detected
+  Serial.print(F(" - Detected "));
+  Serial.print(devicesFound);
+  Serial.println(F(" INA devices on the I2C bus"));
+}  // method setup()
+
+void loop() {
+  /*!
+   * @brief    Arduino method for the main program loop
+   * @details  Times the "getBusMicroAmps()" call when reading one device repeatedly and when
+   *           alternating between all devices found, then times reading all 4 values of the first
+   *           device individually and with "readMeasurement()". The average microseconds per call
+   *           are displayed before waiting and repeating the measurements.
+   * @return   void
+   */
+  uint32_t       startMicros, sameMicros, alternateMicros, gettersMicros, measureMicros;  // Timing
+  inaMeasurement measurement;  // Structure for the combined readings
+  startMicros = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    INA.getBusMicroAmps(0);  // Always read the first device
+  }                          // for-next each iteration
+  sameMicros  = micros() - startMicros;
+  startMicros = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    INA.getBusMicroAmps(i % devicesFound);  // Round-robin through all devices
+  }                                         // for-next each iteration
+  alternateMicros = micros() - startMicros;
+  startMicros     = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    INA.getBusMilliVolts(0);  // Read all 4 values individually
+    INA.getShuntMicroVolts(0);
+    INA.getBusMicroAmps(0);
+    INA.getBusMicroWatts(0);
+  }  // for-next each iteration
+  gettersMicros = micros() - startMicros;
+  startMicros   = micros();
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    INA.readMeasurement(measurement, 0);  // Read all 4 values in one call
+  }                                       // for-next each iteration
+  measureMicros = micros() - startMicros;
+  Serial.print(F("Same device:        "));
+  Serial.print(sameMicros / ITERATIONS);
+  Serial.print(F("us per call\nAlternating device: "));
+  Serial.print(alternateMicros / ITERATIONS);
+  Serial.print(F("us per call\n4 getter calls:     "));
+  Serial.print(gettersMicros / ITERATIONS);
+  Serial.print(F("us per set\nreadMeasurement(): "));
+  Serial.print(measureMicros / ITERATIONS);
+  Serial.print(F("us per set\n\n"));
+  delay(5000);  // Wait 5 seconds before next measurement
+}  // method loop()
@@ -0,0 +1,152 @@
+/*!
+ @file AutoRange.cpp
+
+ @brief Host program checking the automatic shunt range of the INA219 and INA228
+
+ @section AutoRange_section Description
+
+ Program for Linux which turns on "setAutoRange()" for a simulated INA219 and INA228, see
+ "INA_Simulator.h", and steps the voltage across their shunts down and up through the PHASES. In
+ each phase the devices are read READINGS times with "readMeasurement()", one conversion time
+ apart. The library source is compiled into this program with "micros()" and
+ "delayMicroseconds()" replaced by the simulator's virtual clock, so that every run gives the same
+ results. The checks are, for each device and phase:\n
+ - at the end of the phase the device uses the expected range, either after switching or because
+   the hysteresis kept it in the range it was in\n
+ - a phase which stays within the hysteresis doesn't switch at all\n
+ - every reading without the "rangeSwitch" flag has the correct shunt voltage and current,
+   whichever range it was taken in\n
+ - the flag is only set on the reading which switched and on the SETTLE_READINGS after it. It is
+   always set on a reading which switched up, since it may be clipped, and on the first one after
+   a switch\n\n
+
+ The program prints the range, switches and flagged readings of each phase and returns 1 if a
+ check fails.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -I../../src ../../src/INA_Simulator.cpp AutoRange.cpp -o AutoRange
+ && ./AutoRange
+
+ @section AutoRange_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+
+/**************************************************************************************************
+** Declare program constants, the phases, global variables and the library's clock               **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{2};          ///< Max expected amps, 200mV across the shunt
+const uint8_t  READINGS{3 * INA_RANGE_SAMPLES};  ///< Readings in each phase
+const uint8_t  SETTLE_READINGS{2};  ///< Readings after a switch which may be flagged, INA228
+const int32_t  SHUNT_SLACK{20};     ///< Shunt readings may be off by 2 INA219 LSB, in uV
+const int32_t  AMPS_SLACK{200};     ///< Plus 1%, current readings may be off by 2 INA219 LSB in uA
+/*! Shunt voltage of a phase and the range each device has to be in at its end */
+struct phase {
+  int32_t     shuntMicroVolts;  ///< Voltage across the shunt
+  uint8_t     range[2];         ///< Range of the INA219 and of the INA228 at the end
+  bool        stays;            ///< Set when the hysteresis keeps both devices in their range
+  const char* description;      ///< Printed with the results
+};
+const phase PHASES[]{
+    {5000, {0, 0}, false, "5mV, down to the smallest range"},
+    {30000, {0, 0}, true, "30mV, stays below the switch up"},
+    {38000, {1, 1}, false, "38mV, up from the smallest range"},
+    {30000, {1, 1}, true, "30mV again, stays above the switch down"},
+    {120000, {2, 1}, false, "120mV"},
+    {150000, {3, 1}, false, "150mV, the largest range"},
+    {5000, {0, 0}, false, "5mV, down to the smallest range at once"},
+    {-120000, {2, 1}, false, "-120mV"}};  ///< Phases, in this order
+const uint8_t  DEVICES{2};                ///< INA219 and INA228
+const char*    NAMES[DEVICES]{"INA219", "INA228"};  ///< Names printed
+INA_Simulator  simulator;                           ///< Simulated bus
+bool           passed{true};                        ///< Cleared when a check fails
+
+#define micros() ((uint32_t)(simulator.getNanos() / 1000))  ///< Library's clock, the simulator's
+#define delayMicroseconds(us) simulator.advance((us))       ///< Library's sleep, on the same clock
+#include <INA.cpp>  // Zanshin INA Library, compiled with the clock above
+
+void report(const uint8_t device, const char* check, const bool result) {
+  /*!
+   * @brief    Prints a failed check
+   * @param[in] device Device checked
+   * @param[in] check Description of the check
+   * @param[in] result "true" if the check passed
+   */
+  if (!result) printf("%s %s FAILED\n", NAMES[device], check);
+  passed &= result;
+}  // of function report()
+
+bool correct(const inaMeasurement& measurement, const int32_t shuntMicroVolts) {
+  /*!
+   * @brief    Compares readings with the voltage across the shunt
+   * @param[in] measurement Readings
+   * @param[in] shuntMicroVolts Voltage across the shunt
+   * @return   "true" if shunt voltage and current are within SHUNT_SLACK and AMPS_SLACK
+   */
+  int32_t microAmps = (int64_t)shuntMicroVolts * 1000000 / SHUNT_MICRO_OHM;
+  int32_t slack     = AMPS_SLACK + (microAmps < 0 ? -microAmps : microAmps) / 100;
+  return measurement.shuntMicroVolts >= shuntMicroVolts - SHUNT_SLACK &&
+         measurement.shuntMicroVolts <= shuntMicroVolts + SHUNT_SLACK &&
+         measurement.busMicroAmps >= microAmps - slack &&
+         measurement.busMicroAmps <= microAmps + slack;
+}  // of function correct()
+
+int main() {
+  /*!
+   @brief    Runs the checks and prints the results
+   @return   Exit code, 1 if a check failed
+  */
+  INA_Class INA;
+  simulator.addDevice(0x40, INA219);
+  simulator.addDevice(0x41, INA228);
+  INA.addBus(simulator);
+  INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  INA.setAutoRange(true);
+  uint8_t sinceSwitch[DEVICES]{UINT8_MAX, UINT8_MAX};  // Readings since the last switch
+  printf("device phase                                     range switches flagged\n");
+  for (const phase& step : PHASES) {
+    for (uint8_t i = 0; i < DEVICES; i++) {
+      simulator.setInputs(0x40 + i, 12000000, step.shuntMicroVolts * 1000);
+    }  // for-next each device
+    for (uint8_t i = 0; i < DEVICES; i++) {
+      uint8_t switches{0}, flagged{0};
+      bool    readingsCorrect{true}, flagsCorrect{true};
+      for (uint8_t n = 0; n < READINGS; n++) {
+        uint8_t        range = INA.getShuntRange(i);
+        inaMeasurement measurement;
+        simulator.advance(INA.getConversionMicros(i));  // Converted with the current input
+        INA.readMeasurement(measurement, i);
+        if (sinceSwitch[i] < UINT8_MAX) sinceSwitch[i]++;
+        if (INA.getShuntRange(i) != range) {
+          switches++;
+          sinceSwitch[i] = 0;
+          flagsCorrect &= INA.getShuntRange(i) < range || measurement.rangeSwitch;  // Up flagged
+        }  // of if-then switched
+        flagsCorrect &= sinceSwitch[i] != 1 || measurement.rangeSwitch;  // First one after it
+        if (measurement.rangeSwitch) {
+          flagged++;
+          flagsCorrect &= sinceSwitch[i] <= SETTLE_READINGS;
+        } else {
+          readingsCorrect &= correct(measurement, step.shuntMicroVolts);
+        }  // of if-then-else flagged
+      }  // for-next each reading
+      printf("%-6s %-41s %5u %8u %7u\n", NAMES[i], step.description, INA.getShuntRange(i),
+             switches, flagged);
+      report(i, "range at the end of the phase", INA.getShuntRange(i) == step.range[i]);
+      report(i, "no switch within the hysteresis", !step.stays || switches == 0);
+      report(i, "readings without the flag are correct", readingsCorrect);
+      report(i, "the flag is only set around a switch, when up and right after it", flagsCorrect);
+    }  // for-next each device
+  }    // for-next each phase
+  return passed ? 0 : 1;
+}  // of function main()
@@ -0,0 +1,139 @@
+/*!
+ @file BackgroundThread.cpp
+
+ @brief Host program running the INA_BackgroundSampler on its std::thread against simulated devices
+
+ @section BackgroundThread_section Description
+
+ Program for Linux which starts the "INA_BackgroundSampler" on its own thread, as on an ESP32 with
+ a FreeRTOS task, to sample two simulated INA226 devices, see "INA_Simulator.h". The thread owns
+ the simulated bus while it runs, this program's thread only uses the sampler's thread safe calls
+ and reads the INA_LatestTable. The checks are, in this order:\n
+ - "start()" starts the thread once, a second call is refused\n
+ - the readings reach both the table and the callback, with the simulated inputs' values, at
+   about the rate of PERIOD_MICROS\n
+ - "setPeriod()" takes effect while the sampler runs, a longer period lowers the rate of one device
+   and a period of 0 stops sampling another\n
+ - "stop()" ends the thread and no callback comes after it\n\n
+
+ The thread is scheduled by the host, so the rates are checked with a generous TOLERANCE_PERCENT.
+ The program prints the rates and returns 1 if a check fails.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -pthread -I../../src ../../src/INA.cpp ../../src/INA_Simulator.cpp
+ BackgroundThread.cpp -o BackgroundThread && ./BackgroundThread
+
+ @section BackgroundThread_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+
+#include <atomic>
+
+/**************************************************************************************************
+** Declare program constants and global variables                                                **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint32_t PERIOD_MICROS{10000};     ///< Period of both devices at the start
+const uint32_t PHASE_MICROS{500000};     ///< Duration of each phase whose rates are checked
+const uint8_t  TOLERANCE_PERCENT{40};    ///< Deviation of a rate accepted from the expected one
+INA_Simulator  simulator;                ///< Simulated bus, only used by the sampler's thread
+INA_Class      INA;                      ///< Library instance whose devices are sampled
+std::atomic<uint32_t> callbacks[2];      ///< Callbacks of each device
+std::atomic<uint32_t> wrongValues{0};    ///< Callbacks whose readings differ from the inputs
+bool                  passed{true};      ///< Cleared when a check fails
+
+void report(const char* check, const bool result) {
+  /*!
+   * @brief    Prints the result of a check
+   * @param[in] check Description of the check
+   * @param[in] result "true" if the check passed
+   */
+  printf("%-62s %s\n", check, result ? "ok" : "FAILED");
+  passed &= result;
+}  // of function report()
+
+bool correct(const inaMeasurement& measurement) {
+  /*!
+   * @brief    Checks readings against the simulated inputs, 12V and 2.5mV across the shunt
+   * @param[in] measurement Readings to check
+   * @return   "true" if the readings are those of the inputs
+   */
+  return measurement.busMilliVolts == 12000 && measurement.shuntMicroVolts == 2500;
+}  // of function correct()
+
+void count(const uint8_t deviceNumber, const inaMeasurement& measurement, const uint32_t) {
+  /*!
+   * @brief    Sampler callback, counts the readings of each device, on the sampler's thread
+   * @param[in] deviceNumber Device read
+   * @param[in] measurement Readings
+   */
+  if (deviceNumber < 2) callbacks[deviceNumber]++;
+  if (!correct(measurement)) wrongValues++;
+}  // of function count()
+
+bool rateNear(const char* check, const uint8_t deviceNumber, const uint32_t periodMicros) {
+  /*!
+   * @brief    Counts the callbacks of a device over PHASE_MICROS and compares them to a period
+   * @param[in] check Description printed
+   * @param[in] deviceNumber Device to count
+   * @param[in] periodMicros Expected period, 0 when no callback is expected
+   * @return   "true" if the count is within TOLERANCE_PERCENT of the expected one
+   */
+  uint32_t start = callbacks[deviceNumber];
+  delayMicroseconds(PHASE_MICROS);
+  uint32_t counted  = callbacks[deviceNumber] - start;
+  uint32_t expected = periodMicros ? PHASE_MICROS / periodMicros : 0;
+  bool     near     = counted * 100 >= expected * (100 - TOLERANCE_PERCENT) &&
+               counted * 100 <= expected * (100 + TOLERANCE_PERCENT) + 100;  // 1 in flight
+  printf("%s: %u readings, %u expected\n", check, counted, expected);
+  return near;
+}  // of function rateNear()
+
+int main() {
+  /*!
+   @brief    Runs the checks and prints the results
+   @return   Exit code, 1 if a check failed
+  */
+  for (uint8_t i = 0; i < 2; i++) {
+    simulator.addDevice(0x40 + i, INA226);
+    simulator.setInputs(0x40 + i, 12000000, 2500000);  // 12V bus, 2.5mV across the shunt
+  }                                                     // for-next each device
+  INA.addBus(simulator);
+  INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  INA.setI2CSpeed(INA_I2C_FAST_MODE);  // Leaves room for both periods on the bus
+  INA_LatestTable       table(INA);
+  INA_BackgroundSampler sampler(INA);
+  table.begin();
+  sampler.begin(PERIOD_MICROS);
+  sampler.setTable(&table);
+  sampler.setCallback(count);
+  report("start() starts the thread", sampler.start() && sampler.running());
+  report("a second start() is refused", !sampler.start());
+  report("device 0 is read at its period", rateNear("device 0", 0, PERIOD_MICROS));
+  inaMeasurement latest;
+  bool           published = true;
+  for (uint8_t i = 0; i < 2; i++) published &= table.read(latest, i) && correct(latest);
+  report("the readings reach the table", published);
+  report("the readings reach the callback with the inputs' values",
+         callbacks[1] > 0 && wrongValues == 0);
+  report("setPeriod() while running lowers the rate",
+         sampler.setPeriod(0, 5 * PERIOD_MICROS) && rateNear("device 0", 0, 5 * PERIOD_MICROS));
+  report("setPeriod() of 0 while running stops the device",
+         sampler.setPeriod(1, 0) && rateNear("device 1", 1, 0));
+  sampler.stop();
+  uint32_t stopped = callbacks[0];
+  delayMicroseconds(5 * PERIOD_MICROS);
+  report("stop() ends the thread", !sampler.running() && callbacks[0] == stopped);
+  return passed ? 0 : 1;
+}  // of function main()
@@ -0,0 +1,112 @@
+/*!
+ @file ConversionDue.cpp
+
+ @brief Host program checking the predicted end of a conversion, also for a stale start time
+
+ @section ConversionDue_section Description
+
+ Program for Linux which checks "getConversionDue()" and its users "waitForConversion()" and
+ "INA_Sampler::poll()" against a simulated INA226, see "INA_Simulator.h". The library source is
+ compiled into this program with "micros()" and "delayMicroseconds()" replaced by a clock of its
+ own, which moves in step with the simulator's virtual clock, so that the checks don't depend on
+ the host's timing and can let 40 minutes pass at once.\n\n
+
+ The device converts continuously, so the start of its conversion is only moved when the library
+ reads its conversion ready flag. The checks are, in this order:\n
+ - right after "configure()" the conversion is due one conversion time later\n
+ - half way through it is due after the other half\n
+ - after STALE_MICROS without a read of the flag, more than 2^31 microseconds, it is due now and
+   not in the distant future the wrapped 32 bit time would give\n
+ - "waitForConversion()" then returns without sleeping\n
+ - "INA_Sampler::poll()" collects the device within two calls after another STALE_MICROS\n\n
+
+ The library pauses for I2C_DELAY after some transactions, which moves the clock during the calls,
+ so the first two times and the sleep are checked to within SLACK_MICROS. The program prints the
+ results and returns 1 if a check fails.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -I../../src ../../src/INA_Simulator.cpp ConversionDue.cpp -o ConversionDue
+ && ./ConversionDue
+
+ @section ConversionDue_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+
+/**************************************************************************************************
+** Declare program constants, global variables and the clock compiled into the library           **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};   ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};           ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint32_t STALE_MICROS{2400000000};  ///< 40 minutes, more than 2^31 microseconds
+const uint32_t SLACK_MICROS{100};         ///< Covers the I2C_DELAY pauses of the calls checked
+INA_Simulator  simulator;                 ///< Simulated bus
+uint32_t       clockMicros{1000};         ///< Library's micros(), starting at an arbitrary time
+bool           passed{true};              ///< Cleared when a check fails
+
+void elapse(const uint32_t microSeconds) {
+  /*!
+   * @brief    Lets time pass on the library's clock and the simulator's
+   * @param[in] microSeconds Time to pass
+   */
+  clockMicros += microSeconds;
+  simulator.advance(microSeconds);
+}  // of function elapse()
+
+#define micros() (clockMicros)              ///< Library's clock, see "elapse()"
+#define delayMicroseconds(us) elapse((us))  ///< Library's sleep, see "elapse()"
+#include <INA.cpp>                          // Zanshin INA Library, compiled with the clock above
+
+void report(const char* check, const bool result) {
+  /*!
+   * @brief    Prints the result of a check
+   * @param[in] check Description of the check
+   * @param[in] result "true" if the check passed
+   */
+  printf("%-60s %s\n", check, result ? "ok" : "FAILED");
+  passed &= result;
+}  // of function report()
+
+int main() {
+  /*!
+   @brief    Runs the checks and prints the results
+   @return   Exit code, 1 if a check failed
+  */
+  INA_Class INA;
+  simulator.addDevice(0x40, INA226);
+  INA.addBus(simulator);
+  INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  INA.configure(INA_MODE_CONTINUOUS_BOTH, 1, 1100, 1100, 0);  // Restarts the conversion
+  uint32_t duration = INA.getConversionMicros(0);
+  uint32_t ahead    = INA.getConversionDue(0) - clockMicros;
+  report("due one conversion time after configure()",
+         ahead <= duration && ahead + SLACK_MICROS >= duration);
+  elapse(duration / 2);
+  ahead = INA.getConversionDue(0) - clockMicros;
+  report("due after the other half half way through",
+         ahead <= duration - duration / 2 && ahead + SLACK_MICROS >= duration - duration / 2);
+  elapse(STALE_MICROS);
+  ahead = INA.getConversionDue(0) - clockMicros;
+  printf("stale start: due %u us ahead\n", ahead);
+  report("due now after 40 minutes without reading the flag", ahead == 0);
+  uint32_t start = clockMicros;
+  INA.waitForConversion(0);
+  report("waitForConversion() doesn't sleep for a stale start",
+         clockMicros - start < SLACK_MICROS);
+  INA_Sampler sampler(INA);
+  sampler.begin();
+  elapse(STALE_MICROS);
+  uint8_t collected = sampler.poll();  // Moves to the wait state, continuous mode isn't triggered
+  collected += sampler.poll();
+  report("INA_Sampler::poll() collects after a stale start", collected == 1);
+  return passed ? 0 : 1;
+}  // of function main()
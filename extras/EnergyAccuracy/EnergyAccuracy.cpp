@@ -0,0 +1,150 @@
+/*!
+ @file EnergyAccuracy.cpp
+
+ @brief Host program checking the software energy and charge accumulators against a known load
+
+ @section EnergyAccuracy_section Description
+
+ Program for Linux which runs the software accumulators of "INA_Class::resetEnergy()" against
+ simulated devices, see "INA_Simulator.h", without hardware accumulators: an INA219, INA226,
+ INA260 and the first channel of an INA3221. The simulated clock is kept in step with the host's
+ "micros()", which the accumulators use to time the readings, so the devices convert and are read
+ in real time.\n\n
+
+ All devices see the same load profile, phases of a fixed bus voltage and current which include a
+ negative current. The currents are multiples of the coarsest current LSB, the INA260's 1.25mA
+ and the INA3221's 40uV over the shunt, so that the results only show the accumulators' errors.
+ The devices are read with "readRawSample()" about every millisecond. The load is changed right
+ after a reading and the next reading is only made after SETTLE_MICROS, when the devices have
+ converted the new load. The accumulators multiply each reading by the time since the previous
+ one, so the exact totals are computed over the same intervals, using the readings' times. Delays
+ of the host therefore don't affect the comparison. What remains is the rounding of the devices'
+ registers, e.g. the INA226 computes its power register from the truncated current and bus
+ registers, which is about 0.12% low for this profile.\n\n
+
+ The errors are relative to the integral of the absolute values, since the negative current
+ cancels part of the totals. The program prints them for each device and returns 1 if any of them
+ is more than TOLERANCE_PPM.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -I../../src ../../src/INA.cpp ../../src/INA_Simulator.cpp
+ EnergyAccuracy.cpp -o EnergyAccuracy && ./EnergyAccuracy
+
+ @section EnergyAccuracy_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <math.h>
+#include <stdio.h>
+
+/**************************************************************************************************
+** Declare program constants, the load profile and global variables                              **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint32_t TOLERANCE_PPM{2000};      ///< Largest error accepted, in parts per million
+const uint32_t SETTLE_MICROS{10000};     ///< Wait after a load change, > INA3221 conversion cycle
+const uint8_t  DEVICE_TYPES[]{INA219, INA226, INA260, INA3221_0};  ///< Devices, from 0x40 on
+/*! One phase of the load profile */
+struct phase {
+  uint32_t milliSeconds;   ///< Duration
+  int32_t  busMicroVolts;  ///< Bus voltage
+  int32_t  microAmps;      ///< Current, negative when flowing back
+};
+const phase PROFILE[]{{1000, 24000000, 20000},
+                      {1000, 5000000, -10000},
+                      {500, 24000000, 20000}};  ///< Load seen by all devices
+/*! INA_Simulator whose clock follows the host's micros() */
+class RealTimeSimulator : public INA_Simulator {
+ public:
+  uint32_t startMicros{0};  ///< micros() at simulated time 0
+  void     sync() {
+    /*! @brief  Advances the simulated clock to the host's time */
+    uint64_t now = (uint64_t)(micros() - startMicros) * 1000;
+    if (now > getNanos()) advance((now - getNanos()) / 1000);
+  }  // of method sync()
+  uint8_t write(const uint8_t deviceAddress, const uint8_t* data, const uint8_t length) {
+    sync();
+    return INA_Simulator::write(deviceAddress, data, length);
+  }  // of method write()
+  uint8_t read(const uint8_t deviceAddress, uint8_t* data, const uint8_t length) {
+    sync();
+    return INA_Simulator::read(deviceAddress, data, length);
+  }  // of method read()
+  uint8_t readRegister(const uint8_t deviceAddress, const uint8_t reg, uint8_t* data,
+                       const uint8_t length) {
+    sync();
+    return INA_Simulator::readRegister(deviceAddress, reg, data, length);
+  }  // of method readRegister()
+};  // of class RealTimeSimulator
+INA_Class         INA;        ///< Library instance being checked
+RealTimeSimulator simulator;  ///< Simulated bus
+
+int main() {
+  /*!
+   @brief    Runs the load profile and compares the accumulated totals with the exact ones
+   @return   Exit code, 1 if a total is outside of the tolerance
+  */
+  const uint8_t devices = sizeof(DEVICE_TYPES);
+  uint32_t      lastMicros[devices];                     // Time of each device's last reading
+  double        joules[devices]{}, coulombs[devices]{};  // Exact totals up to that reading
+  double        scaleJoules[devices]{}, scaleCoulombs[devices]{};  // Totals of absolute values
+  for (uint8_t i = 0; i < devices; i++) simulator.addDevice(0x40 + i, DEVICE_TYPES[i]);
+  INA.addBus(simulator);
+  uint8_t found = INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);  // The INA3221 has 3 device numbers
+  INA.setI2CSpeed(INA_I2C_HIGH_SPEED_MODE);  // Keep the reads short compared to the interval
+  INA.configure(INA_MODE_CONTINUOUS_BOTH, 1, 588, 588);
+  simulator.startMicros = micros() - (uint32_t)(simulator.getNanos() / 1000);
+  for (const phase& load : PROFILE) {
+    simulator.sync();  // The load changes now, not at the last transaction
+    for (uint8_t i = 0; i < devices; i++) {
+      int64_t microOhm = DEVICE_TYPES[i] == INA260 ? 2000 : SHUNT_MICRO_OHM;  // Internal shunt
+      simulator.setInputs(0x40 + i, load.busMicroVolts, load.microAmps * microOhm / 1000);
+    }                                   // for-next each device
+    delayMicroseconds(SETTLE_MICROS);  // Let the devices convert the new load
+    if (&load == PROFILE) {
+      INA.resetEnergy();
+      for (uint8_t i = 0; i < devices; i++) lastMicros[i] = micros();
+    }  // of if-then first phase
+    double   watts = load.busMicroVolts / 1e6 * load.microAmps / 1e6;
+    uint32_t start = micros();
+    while (micros() - start < load.milliSeconds * 1000) {
+      for (uint8_t i = 0; i < found; i++) {
+        inaRawSample sample;
+        INA.readRawSample(sample, i);
+        if (i >= devices) continue;  // Second and third INA3221 channel
+        double seconds = (sample.micros - lastMicros[i]) / 1e6;
+        lastMicros[i]  = sample.micros;
+        joules[i] += watts * seconds;
+        coulombs[i] += load.microAmps / 1e6 * seconds;
+        scaleJoules[i] += fabs(watts) * seconds;
+        scaleCoulombs[i] += fabs(load.microAmps / 1e6) * seconds;
+      }  // for-next each device number
+      delayMicroseconds(1000);
+    }  // of while-loop phase running
+  }    // for-next each phase
+  bool passed{true};
+  for (uint8_t deviceNumber = 0; deviceNumber < devices; deviceNumber++) {  // INA3221 channel 1
+    inaEnergy energy;                                                        // is the last one
+    INA.readEnergy(energy, deviceNumber);
+    double energyError =
+        (energy.microJoules / 1e6 - joules[deviceNumber]) / scaleJoules[deviceNumber] * 1e6;
+    double chargeError =
+        (energy.microCoulombs / 1e6 - coulombs[deviceNumber]) / scaleCoulombs[deviceNumber] * 1e6;
+    bool good = fabs(energyError) <= TOLERANCE_PPM && fabs(chargeError) <= TOLERANCE_PPM;
+    printf("%-7s %9.6f J (exact %9.6f, %5.0f ppm) %9.6f C (exact %9.6f, %5.0f ppm) %s\n",
+           INA.getDeviceName(deviceNumber), energy.microJoules / 1e6, joules[deviceNumber],
+           energyError, energy.microCoulombs / 1e6, coulombs[deviceNumber], chargeError,
+           good ? "ok" : "FAILED");
+    passed &= good;
+  }  // for-next each device
+  return passed ? 0 : 1;
+}  // of function main()
@@ -0,0 +1,246 @@
+/*!
+ @file HostBenchmark.cpp
+
+ @brief Host program measuring the I2C traffic and CPU time of every public INA_Class method
+
+ @section HostBenchmark_section Description
+
+ Program for Linux which runs every public method of the INA_Class against simulated devices, see
+ "INA_Simulator.h", for each supported device type and for 1 to 32 devices. For each method it
+ reports the average number of I2C transactions, the bytes transferred, the time these take on the
+ bus at 100KHz, 400KHz and 1MHz and the host CPU time per call. The results are written to stdout
+ as comma separated values with a header line, so they can be compared between library versions
+ or loaded into a spreadsheet.\n\n
+
+ Methods which take an optional device number are called once for each device found and, where
+ the method also works on all devices at once, once more without a device number ("(all)" in the
+ method column) to show how the cost grows with the number of devices. The INA3221 has 3 device
+ numbers per device, so fewer INA3221 devices are simulated to stay within 32 device numbers. More
+ than 16 devices are put on a second simulated bus.\n\n
+
+ The bus times are computed from the transactions and bytes and don't include the I2C_DELAY
+ pauses after writes. Conversions in the simulator progress with the bus traffic at 100KHz, so
+ the number of polls made by "waitForConversion()" and "sweep()" is that of a 100KHz bus. The CPU
+ time includes the time taken by the simulator itself.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -I../../src ../../src/INA.cpp ../../src/INA_Simulator.cpp HostBenchmark.cpp
+ -o HostBenchmark && ./HostBenchmark [iterations] > results.csv
+
+ @section HostBenchmark_results Recorded results
+
+ The resident table of computed device structures which "begin()" builds was measured before this
+ program existed, with the round-robin loop of the "Benchmark" example on a host build with an
+ emulated TwoWire bus: 100000 "getBusMicroAmps()" calls alternating between 6 devices took 19.9ms
+ before the table, when each device change reloaded the EEPROM record and recomputed its LSBs,
+ and 7.7ms with it, i.e. 199ns and 77ns per call without the bus time. This program measures the
+ same with the table in the "cpu_ns" column of "getBusMicroAmps", which stays the same from 1 to
+ 32 devices, e.g. 81 to 124ns per call for the INA226 with 100 iterations, simulator included.\n\n
+
+ @section HostBenchmark_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**************************************************************************************************
+** Declare program constants, global variables and the list of methods to time                   **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint8_t  DEVICE_COUNTS[]{1, 2, 4, 8, 16, 32};  ///< Number of device numbers to test with
+const uint8_t  DEVICE_TYPES[]{INA219, INA226, INA228, INA230,
+                             INA231, INA260, INA3221_0};  ///< Device types to test with
+const uint8_t  BUS_DEVICES{16};                            ///< Devices on each simulated bus
+uint16_t       iterations{10};                             ///< Calls of each method per device
+INA_Simulator* simulators[2]{nullptr, nullptr};            ///< Simulated buses
+INA_Class*     INA{nullptr};                               ///< Library instance being measured
+uint8_t        devicesFound{0};                            ///< Number of INAs found
+inaMeasurement measurements[32];                           ///< Readings of "sweep()"
+
+/*! typedef contains one method to time, "perDevice" calls are made once for each device number */
+typedef struct {
+  const char* name;                           ///< Name shown in the results
+  bool        perDevice;                      ///< Call for each device, otherwise once
+  void (*call)(const uint8_t deviceNumber);  ///< Function making the call
+} benchmarkCall;                              // of structure
+/*! List of the methods to time, "reset()" is last as it undoes the settings of begin() */
+const benchmarkCall CALLS[]{
+    {"begin(device)", true,
+     [](const uint8_t d) { INA->begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM, d); }},
+    {"setI2CSpeed", false, [](const uint8_t) { INA->setI2CSpeed(INA_I2C_STANDARD_MODE); }},
+    {"setMode", true, [](const uint8_t d) { INA->setMode(INA_MODE_CONTINUOUS_BOTH, d); }},
+    {"setMode(all)", false, [](const uint8_t) { INA->setMode(INA_MODE_CONTINUOUS_BOTH); }},
+    {"setAveraging", true, [](const uint8_t d) { INA->setAveraging(4, d); }},
+    {"setAveraging(all)", false, [](const uint8_t) { INA->setAveraging(4); }},
+    {"setBusConversion", true, [](const uint8_t d) { INA->setBusConversion(1100, d); }},
+    {"setBusConversion(all)", false, [](const uint8_t) { INA->setBusConversion(1100); }},
+    {"setShuntConversion", true, [](const uint8_t d) { INA->setShuntConversion(1100, d); }},
+    {"setShuntConversion(all)", false, [](const uint8_t) { INA->setShuntConversion(1100); }},
+    {"configure", true,
+     [](const uint8_t d) { INA->configure(INA_MODE_CONTINUOUS_BOTH, 4, 1100, 1100, d); }},
+    {"configure(all)", false,
+     [](const uint8_t) { INA->configure(INA_MODE_CONTINUOUS_BOTH, 4, 1100, 1100); }},
+    {"getBusMilliVolts", true, [](const uint8_t d) { INA->getBusMilliVolts(d); }},
+    {"getBusRaw", true, [](const uint8_t d) { INA->getBusRaw(d); }},
+    {"getShuntMicroVolts", true, [](const uint8_t d) { INA->getShuntMicroVolts(d); }},
+    {"getShuntRaw", true, [](const uint8_t d) { INA->getShuntRaw(d); }},
+    {"getBusMicroAmps", true, [](const uint8_t d) { INA->getBusMicroAmps(d); }},
+    {"getBusMicroWatts", true, [](const uint8_t d) { INA->getBusMicroWatts(d); }},
+    {"readMeasurement", true,
+     [](const uint8_t d) {
+       inaMeasurement measurement;
+       INA->readMeasurement(measurement, d);
+     }},
+    {"sweep(all)", false, [](const uint8_t) { INA->sweep(measurements); }},
+    {"getDeviceName", true, [](const uint8_t d) { INA->getDeviceName(d); }},
+    {"getDeviceAddress", true, [](const uint8_t d) { INA->getDeviceAddress(d); }},
+    {"getDeviceBus", true, [](const uint8_t d) { INA->getDeviceBus(d); }},
+    {"conversionFinished", true, [](const uint8_t d) { INA->conversionFinished(d); }},
+    {"waitForConversion", true, [](const uint8_t d) { INA->waitForConversion(d); }},
+    {"waitForConversion(all)", false, [](const uint8_t) { INA->waitForConversion(); }},
+    {"alertOnConversion", true, [](const uint8_t d) { INA->alertOnConversion(false, d); }},
+    {"alertOnShuntOverVoltage", true,
+     [](const uint8_t d) { INA->alertOnShuntOverVoltage(false, 0, d); }},
+    {"alertOnShuntUnderVoltage", true,
+     [](const uint8_t d) { INA->alertOnShuntUnderVoltage(false, 0, d); }},
+    {"alertOnBusOverVoltage", true,
+     [](const uint8_t d) { INA->alertOnBusOverVoltage(false, 0, d); }},
+    {"alertOnBusUnderVoltage", true,
+     [](const uint8_t d) { INA->alertOnBusUnderVoltage(false, 0, d); }},
+    {"alertOnPowerOverLimit", true,
+     [](const uint8_t d) { INA->alertOnPowerOverLimit(false, 0, d); }},
+    {"reset", true, [](const uint8_t d) { INA->reset(d); }}};
+
+uint64_t cpuNanos() {
+  /*!
+   * @brief    Returns the CPU time used by the process
+   * @return   CPU time in nanoseconds
+   */
+  struct timespec now;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}  // of function cpuNanos()
+
+void readCounters(uint32_t& transactions, uint32_t& bytes) {
+  /*!
+   * @brief    Adds the transaction and byte counts of the simulated buses and resets them
+   * @param[in,out] transactions Transactions are added to this value
+   * @param[in,out] bytes Bytes are added to this value
+   */
+  for (uint8_t bus = 0; bus < 2; bus++) {
+    transactions += simulators[bus]->getTransactions();
+    bytes += simulators[bus]->getBytes();
+    simulators[bus]->resetCounters();
+  }  // for-next each bus
+}  // of function readCounters()
+
+void printResult(const char* method, const uint32_t calls, const uint32_t transactions,
+                 const uint32_t bytes, const uint64_t cpuTime) {
+  /*!
+   * @brief    Writes one line of results with the averages per call
+   * @param[in] method Name of the method timed
+   * @param[in] calls Number of calls made
+   * @param[in] transactions I2C transactions of all calls
+   * @param[in] bytes Bytes transferred by all calls
+   * @param[in] cpuTime CPU time of all calls in nanoseconds
+   */
+  static const uint32_t CLOCK_SPEEDS[3]{INA_I2C_STANDARD_MODE, INA_I2C_FAST_MODE,
+                                        INA_I2C_FAST_MODE_PLUS};
+  double bits = (double)bytes * 9 + (double)transactions * 2;  // Bytes with ACK, start and stop
+  printf("%s,%u,%s,%u,%.2f,%.2f", INA->getDeviceName(0), devicesFound, method, calls,
+         (double)transactions / calls, (double)bytes / calls);
+  for (uint8_t i = 0; i < 3; i++) printf(",%.1f", bits * 1000000 / CLOCK_SPEEDS[i] / calls);
+  printf(",%.0f\n", (double)cpuTime / calls);
+}  // of function printResult()
+
+void setupDevices(const uint8_t type, const uint8_t count) {
+  /*!
+   * @brief    Creates the simulated buses with the devices and a new INA_Class instance using them
+   * @param[in] type Device type, see "ina_Type"
+   * @param[in] count Number of devices to simulate
+   */
+  delete INA;
+  for (uint8_t bus = 0; bus < 2; bus++) {
+    delete simulators[bus];
+    simulators[bus] = new INA_Simulator();
+  }  // for-next each bus
+  for (uint8_t i = 0; i < count; i++) {
+    INA_Simulator* simulator = simulators[i / BUS_DEVICES];
+    uint8_t        address   = 0x40 + i % BUS_DEVICES;
+    simulator->addDevice(address, type);
+    for (uint8_t channel = 0; channel < (type == INA3221_0 ? 3 : 1); channel++) {
+      simulator->setInputs(address, 12000000, 2500000, channel);  // 12V with 25mA in 0.1 Ohm
+    }  // for-next each channel
+  }    // for-next each device
+  INA = new INA_Class();
+  for (uint8_t bus = 0; bus < 2; bus++) INA->addBus(*simulators[bus]);
+}  // of function setupDevices()
+
+void benchmark(const uint8_t type, const uint8_t count) {
+  /*!
+   * @brief    Times "begin()" and then each of the methods in CALLS for one set of devices
+   * @param[in] type Device type, see "ina_Type"
+   * @param[in] count Number of devices to simulate
+   */
+  uint64_t cpuTime{0}, cpuStart;
+  uint32_t transactions{0}, bytes{0}, calls;
+  for (uint16_t i = 0; i < iterations; i++) {  // "begin()" only searches on the first call
+    setupDevices(type, count);
+    cpuStart     = cpuNanos();
+    devicesFound = INA->begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+    cpuTime += cpuNanos() - cpuStart;
+    readCounters(transactions, bytes);
+  }  // for-next each iteration
+  printResult("begin", iterations, transactions, bytes, cpuTime);
+  for (const benchmarkCall& call : CALLS) {
+    transactions = 0;
+    bytes        = 0;
+    calls        = 0;
+    cpuStart     = cpuNanos();
+    for (uint16_t i = 0; i < iterations; i++) {
+      if (call.perDevice) {
+        for (uint8_t deviceNumber = 0; deviceNumber < devicesFound; deviceNumber++) {
+          call.call(deviceNumber);
+          calls++;
+        }  // for-next each device
+      } else {
+        call.call(UINT8_MAX);
+        calls++;
+      }  // of if-then-else call for each device
+    }    // for-next each iteration
+    cpuTime = cpuNanos() - cpuStart;
+    readCounters(transactions, bytes);
+    printResult(call.name, calls, transactions, bytes, cpuTime);
+  }  // for-next each method
+}  // of function benchmark()
+
+int main(int argc, char* argv[]) {
+  /*!
+   * @brief    Runs the benchmark for each device type and number of devices
+   * @param[in] argc Number of arguments
+   * @param[in] argv Optional number of iterations as the first argument
+   * @return   0
+   */
+  if (argc > 1 && atoi(argv[1]) > 0) iterations = atoi(argv[1]);
+  printf("type,devices,method,calls,transactions,bytes,bus_us_100k,bus_us_400k,bus_us_1M,cpu_ns\n");
+  for (const uint8_t type : DEVICE_TYPES) {
+    uint8_t lastCount{0};
+    for (const uint8_t deviceNumbers : DEVICE_COUNTS) {
+      uint8_t count = (type == INA3221_0) ? (deviceNumbers + 2) / 3 : deviceNumbers;  // 3 each
+      if (count != lastCount) benchmark(type, count);
+      lastCount = count;
+    }  // for-next each number of devices
+  }    // for-next each device type
+  return 0;
+}  // of function main()
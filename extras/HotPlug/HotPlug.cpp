@@ -0,0 +1,201 @@
+/*!
+ @file HotPlug.cpp
+
+ @brief Host program checking rescan() with devices unplugged, plugged back and added, and
+        beginFromStored() after a restart
+
+ @section HotPlug_section Description
+
+ Program for Linux which unplugs, power cycles and adds simulated devices, see "INA_Simulator.h",
+ between calls to "rescan()". An unplugged device doesn't acknowledge its address. It starts with
+ an INA226 at 0x40 and an INA219 at 0x41. The checks are, in this order:\n
+ - "rescan()" without changes adds nothing and leaves the devices online\n
+ - an unplugged device is marked offline and can't be read, the other one still reads correctly\n
+ - once plugged back in after a power cycle, which cleared its calibration, the device is online
+   again and reads correctly, so it has been initialized again\n
+ - an INA3221 added at 0x44 is appended as devices 2-4 and all devices read correctly, also the
+   one which the library had loaded before the rescan\n
+ - the end marker for "beginFromStored()" is stored after the added devices\n
+ - after a restart "beginFromStored()" finds all five devices with fewer transactions than
+   "begin()", and they read correctly\n
+ - after a restart with a stored device unplugged "beginFromStored()" searches with "begin()"
+   instead\n\n
+
+ The structures "begin()" stores are kept in an array of the INA_Class instance on hosts without
+ EEPROM, so a restart is modelled by copying that array into a new instance. The private members
+ are made public for this, the standard headers are included before so that they aren't changed.
+ The program prints the results and returns 1 if a check fails.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -pthread -I../../src ../../src/INA_Simulator.cpp HotPlug.cpp -o HotPlug
+ && ./HotPlug
+
+ @section HotPlug_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <errno.h>           // The standard headers which the library includes
+#include <fcntl.h>           // ...
+#include <linux/i2c-dev.h>   // ...
+#include <linux/i2c.h>       // ...
+#include <stdint.h>          // ...
+#include <stdio.h>           // ...
+#include <string.h>          // ...
+#include <sys/ioctl.h>       // ...
+#include <time.h>            // ...
+#include <unistd.h>          // ...
+#include <thread>            // ...
+#define private public       ///< Gives access to the stored structures, see "restart()"
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <INA.cpp>           // Zanshin INA Library, compiled with public members
+#undef private
+
+/**************************************************************************************************
+** Declare program constants, the unpluggable bus and global variables                           **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const int32_t  MICRO_AMPS{24000};        ///< Current of the inputs, a multiple of the shunt LSBs
+const int32_t  AMPS_SLACK{100};          ///< Current readings may be off by a few LSB
+const uint32_t SETTLE_MICROS{100000};    ///< Lets initialized devices finish their conversions
+/*! INA_Simulator whose devices can be unplugged, they then don't acknowledge their address */
+class UnpluggableSimulator : public INA_Simulator {
+ public:
+  uint16_t unplugged{0};  ///< Bit set for each address 0x40-0x4F which is unplugged
+  uint8_t  write(const uint8_t deviceAddress, const uint8_t* data, const uint8_t length) {
+    if (bitRead(unplugged, deviceAddress & 0x0F)) return 2;  // Address not acknowledged
+    return INA_Simulator::write(deviceAddress, data, length);
+  }  // of method write()
+  uint8_t read(const uint8_t deviceAddress, uint8_t* data, const uint8_t length) {
+    if (bitRead(unplugged, deviceAddress & 0x0F)) return 0;
+    return INA_Simulator::read(deviceAddress, data, length);
+  }  // of method read()
+};                              // of class UnpluggableSimulator
+UnpluggableSimulator simulator;  ///< Simulated bus
+bool                 passed{true};  ///< Cleared when a check fails
+
+void report(const char* check, const bool result) {
+  /*!
+   * @brief    Prints the result of a check
+   * @param[in] check Description of the check
+   * @param[in] result "true" if the check passed
+   */
+  printf("%-68s %s\n", check, result ? "ok" : "FAILED");
+  passed &= result;
+}  // of function report()
+
+bool readsCorrectly(INA_Class& INA, const uint8_t deviceNumber) {
+  /*!
+   * @brief    Reads a device and compares the readings with the inputs, 12V and 24mA
+   * @param[in] INA Library instance
+   * @param[in] deviceNumber Device to read
+   * @return   "true" if the device was read and the readings match the inputs
+   */
+  inaMeasurement measurement;
+  if (!INA.readMeasurement(measurement, deviceNumber)) return false;
+  return measurement.busMilliVolts == 12000 &&
+         measurement.busMicroAmps > MICRO_AMPS - AMPS_SLACK &&
+         measurement.busMicroAmps < MICRO_AMPS + AMPS_SLACK;
+}  // of function readsCorrectly()
+
+bool allReadCorrectly(INA_Class& INA, const uint8_t devices) {
+  /*!
+   * @brief    Reads all devices once their conversions have finished, see "readsCorrectly()"
+   * @param[in] INA Library instance
+   * @param[in] devices Number of devices
+   * @return   "true" if all devices read correctly
+   */
+  bool correct{true};
+  simulator.advance(SETTLE_MICROS);
+  for (uint8_t i = 0; i < devices; i++) correct &= readsCorrectly(INA, i);
+  return correct;
+}  // of function allReadCorrectly()
+
+void restart(INA_Class& restarted, const INA_Class& before) {
+  /*!
+   * @brief    Models a restart, the new instance gets the stored structures of the old one
+   * @param[out] restarted New instance, not yet started
+   * @param[in] before Instance whose structures were stored
+   */
+  memcpy(restarted._EEPROMEmulation, before._EEPROMEmulation, sizeof(before._EEPROMEmulation));
+  restarted.addBus(simulator);
+}  // of function restart()
+
+void setInputs(const uint8_t deviceAddress, const uint8_t channels) {
+  /*!
+   * @brief    Sets 12V and MICRO_AMPS through the shunt on all channels of a device
+   * @param[in] deviceAddress Address of the device
+   * @param[in] channels Number of channels
+   */
+  for (uint8_t channel = 0; channel < channels; channel++) {
+    simulator.setInputs(deviceAddress, 12000000, MICRO_AMPS * SHUNT_MICRO_OHM / 1000, channel);
+  }  // for-next each channel
+}  // of function setInputs()
+
+int main() {
+  /*!
+   @brief    Runs the checks and prints the results
+   @return   Exit code, 1 if a check failed
+  */
+  simulator.addDevice(0x40, INA226);
+  simulator.addDevice(0x41, INA219);
+  setInputs(0x40, 1);
+  setInputs(0x41, 1);
+  INA_Class INA;
+  INA.addBus(simulator);
+  report("begin() finds both devices", INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 2);
+  report("rescan() without changes adds nothing",
+         INA.rescan(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 0 && INA.isOnline(0) && INA.isOnline(1));
+  bitSet(simulator.unplugged, 1);
+  inaMeasurement measurement;
+  report("an unplugged device is marked offline",
+         INA.rescan(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 0 && !INA.isOnline(1));
+  report("an offline device isn't read", !INA.readMeasurement(measurement, 1));
+  report("the other device still reads correctly", INA.isOnline(0) && readsCorrectly(INA, 0));
+  const uint8_t reset[3]{INA_CONFIGURATION_REGISTER, 0x80, 0x00};  // Power cycle
+  simulator.INA_Simulator::write(0x41, reset, 3);  // Also while unplugged
+  bitClear(simulator.unplugged, 1);
+  report("a device plugged back in is online again",
+         INA.rescan(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 0 && INA.isOnline(1));
+  simulator.advance(SETTLE_MICROS);
+  report("it has been initialized again and reads correctly", readsCorrectly(INA, 1));
+  simulator.addDevice(0x44, INA3221_0);
+  setInputs(0x44, 3);
+  report("an INA3221 plugged in is added as three devices",
+         INA.rescan(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 3 &&
+             strcmp(INA.getDeviceName(4), "INA3221") == 0);
+  report("all devices read correctly after the rescan", allReadCorrectly(INA, 5));
+  report("the end marker is stored after the added devices",
+         INA._EEPROMEmulation[4].type == INA3221_2 &&
+             INA._EEPROMEmulation[5].type == INA_UNKNOWN);
+  report("another rescan() adds nothing", INA.rescan(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 0);
+  INA_Class searched;
+  restart(searched, INA);
+  simulator.resetCounters();
+  searched.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  uint32_t searchTransactions = simulator.getTransactions();
+  INA_Class stored;
+  restart(stored, INA);
+  simulator.resetCounters();
+  report("after a restart beginFromStored() finds all devices",
+         stored.beginFromStored(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 5);
+  printf("transactions: begin() %u, beginFromStored() %u\n", searchTransactions,
+         simulator.getTransactions());
+  report("it needs fewer transactions than begin()",
+         simulator.getTransactions() < searchTransactions);
+  report("all devices read correctly after beginFromStored()", allReadCorrectly(stored, 5));
+  bitSet(simulator.unplugged, 0);
+  INA_Class fallback;
+  restart(fallback, INA);
+  report("with a stored device unplugged beginFromStored() searches instead",
+         fallback.beginFromStored(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 4 &&
+             strcmp(fallback.getDeviceName(0), "INA219") == 0 && allReadCorrectly(fallback, 4));
+  return passed ? 0 : 1;
+}  // of function main()
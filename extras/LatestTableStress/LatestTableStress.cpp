@@ -0,0 +1,149 @@
+/*!
+ @file LatestTableStress.cpp
+
+ @brief Host program checking that INA_LatestTable readers never get a torn entry
+
+ @section LatestTableStress_section Description
+
+ Program for Linux which has one writer thread store UPDATES readings into an "INA_LatestTable"
+ with "publish()" as fast as it can, while READERS reader threads copy the same entry with
+ "read()" in a loop. Every field of the n-th reading, and its time, is derived from n, so a reader
+ can tell a copy which mixes two readings from a consistent one. The checks are, in this order:\n
+ - the sequence counter is 32 bits wide on the host, so that it can't wrap round to the same
+   value while a reader copies an entry\n
+ - no reader gets a torn entry, i.e. fields from two different readings\n
+ - no reader gets an older reading after a newer one\n
+ - the readers do get readings while the writer is busy, "read()" doesn't just fail\n
+ - after the writer has finished the last reading is returned\n\n
+
+ The readers don't wait for each other or the writer, the threads run on as many cores as the
+ host gives them. The program prints the number of reads and returns 1 if a check fails.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -pthread -I../../src ../../src/INA.cpp ../../src/INA_Simulator.cpp
+ LatestTableStress.cpp -o LatestTableStress && ./LatestTableStress
+
+ @section LatestTableStress_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+
+#include <atomic>
+#include <thread>
+
+/**************************************************************************************************
+** Declare program constants and global variables                                                **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint32_t UPDATES{5000000};         ///< Readings stored by the writer
+const uint8_t  READERS{3};               ///< Reader threads
+std::atomic<bool> writing{true};         ///< Cleared when the writer has stored all readings
+bool              passed{true};          ///< Cleared when a check fails
+/*! Results of one reader thread */
+struct readerResult {
+  uint32_t reads{0};      ///< Successful reads
+  uint32_t failed{0};     ///< Reads which returned "false"
+  uint32_t torn{0};       ///< Reads which mixed two readings
+  uint32_t backwards{0};  ///< Reads older than the one before
+};
+
+void report(const char* check, const bool result) {
+  /*!
+   * @brief    Prints the result of a check
+   * @param[in] check Description of the check
+   * @param[in] result "true" if the check passed
+   */
+  printf("%-62s %s\n", check, result ? "ok" : "FAILED");
+  passed &= result;
+}  // of function report()
+
+inaMeasurement reading(const uint32_t n) {
+  /*!
+   * @brief    Returns the n-th reading, every field is derived from n
+   * @param[in] n Number of the reading
+   * @return   The reading
+   */
+  inaMeasurement measurement;
+  measurement.busMilliVolts   = (uint16_t)n;
+  measurement.shuntMicroVolts = (int32_t)n;
+  measurement.busMicroAmps    = -(int32_t)n;
+  measurement.busMicroWatts   = (int64_t)n * 1000003;
+  measurement.rangeSwitch     = n & 1;
+  return measurement;
+}  // of function reading()
+
+void readLoop(const INA_LatestTable* table, readerResult* result) {
+  /*!
+   * @brief    Reader thread, copies the entry of device 0 until the writer has finished
+   * @param[in] table Table to read
+   * @param[out] result Counts of the reads
+   */
+  uint32_t last{0};  // Number of the newest reading seen
+  while (writing) {
+    inaMeasurement measurement;
+    uint32_t       n;
+    if (!table->read(measurement, 0, &n)) {
+      result->failed++;
+      continue;
+    }  // of if-then not read
+    inaMeasurement expected = reading(n);
+    if (measurement.busMilliVolts != expected.busMilliVolts ||
+        measurement.shuntMicroVolts != expected.shuntMicroVolts ||
+        measurement.busMicroAmps != expected.busMicroAmps ||
+        measurement.busMicroWatts != expected.busMicroWatts ||
+        measurement.rangeSwitch != expected.rangeSwitch) {
+      result->torn++;
+    }  // of if-then fields of different readings
+    if (n < last) result->backwards++;
+    last = n;
+    result->reads++;
+  }  // of while-loop writer busy
+}  // of function readLoop()
+
+int main() {
+  /*!
+   @brief    Runs the checks and prints the results
+   @return   Exit code, 1 if a check failed
+  */
+  INA_Simulator simulator;
+  INA_Class     INA;
+  simulator.addDevice(0x40, INA226);
+  INA.addBus(simulator);
+  INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  INA_LatestTable table(INA);
+  table.begin();
+  report("the sequence counter is 32 bits wide", sizeof(inaSequence) == 4);
+  readerResult results[READERS];
+  std::thread  readers[READERS];
+  for (uint8_t i = 0; i < READERS; i++) readers[i] = std::thread(readLoop, &table, &results[i]);
+  for (uint32_t n = 1; n <= UPDATES; n++) table.publish(0, reading(n), n);
+  writing = false;
+  readerResult total;
+  for (uint8_t i = 0; i < READERS; i++) {
+    readers[i].join();
+    printf("reader %u: %u reads, %u failed, %u torn, %u backwards\n", i, results[i].reads,
+           results[i].failed, results[i].torn, results[i].backwards);
+    total.reads += results[i].reads;
+    total.torn += results[i].torn;
+    total.backwards += results[i].backwards;
+  }  // for-next each reader
+  report("no reader gets a torn entry", total.torn == 0);
+  report("no reader gets an older reading after a newer one", total.backwards == 0);
+  report("the readers get readings while the writer is busy", total.reads > 0);
+  inaMeasurement measurement;
+  uint32_t       n{0};
+  report("the last reading is returned after the writer finished",
+         table.read(measurement, 0, &n) && n == UPDATES &&
+             measurement.busMicroWatts == reading(UPDATES).busMicroWatts);
+  return passed ? 0 : 1;
+}  // of function main()
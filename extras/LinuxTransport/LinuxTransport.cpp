@@ -0,0 +1,149 @@
+/*!
+ @file LinuxTransport.cpp
+
+ @brief Host program checking the Linux i2c-dev transport against a fake bus
+
+ @section LinuxTransport_section Description
+
+ Program for Linux which runs the "INA_LinuxI2C" transport without an I2C adapter. The kernel's
+ "i2c-stub" module only supports SMBus transfers, so "FakeAdapter" overrides the transport's
+ "transfer()" instead and hands each I2C_RDWR message to simulated devices, see "INA_Simulator.h".
+ It also checks that every transfer has the form the transport promises: a single message for
+ writes and reads, and a register read as one write of the register pointer followed by a read
+ from the same address with a repeated start.\n\n
+
+ The same devices are put on a second simulator which is added directly, and both library
+ instances must find the same devices and read the same values. Each register read must take one
+ ioctl() call, where the direct transport writes the pointer and reads in two transactions. A write
+ to an address without a device must fail with the "TwoWire" code 2. The library header is
+ included twice, which has to compile. The program prints the results and returns 1 if a check
+ fails.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -I../../src ../../src/INA.cpp ../../src/INA_Simulator.cpp
+ LinuxTransport.cpp -o LinuxTransport && ./LinuxTransport
+
+ @section LinuxTransport_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA.h>            // Zanshin INA Library, included again by the next header
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+/**************************************************************************************************
+** Declare program constants, the fake adapter and global variables                              **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint8_t  DEVICE_TYPES[]{INA219, INA226, INA228, INA230,
+                             INA231, INA260, INA3221_0};  ///< Devices, from 0x40 on
+/*! INA_LinuxI2C whose I2C_RDWR transfers go to simulated devices instead of an adapter */
+class FakeAdapter : public INA_LinuxI2C {
+ public:
+  INA_Simulator simulator;             ///< Devices answering the transfers
+  uint32_t      transfers{0};          ///< Calls of transfer(), each one ioctl()
+  bool          wellFormed{true};      ///< Cleared when a transfer has an unexpected form
+  FakeAdapter() : INA_LinuxI2C("/dev/i2c-fake") {}
+
+ protected:
+  int transfer(struct i2c_msg* messages, const uint8_t count) {
+    /*!
+     * @brief    Performs the messages on the simulated devices
+     * @param[in,out] messages Messages to transfer
+     * @param[in] count Number of messages
+     * @return   Number of messages transferred, -1 with errno set to ENXIO for a missing device
+     */
+    transfers++;
+    if (count == 2) {  // Register read, a pointer write and a read with a repeated start
+      wellFormed &= messages[0].flags == 0 && messages[0].len == 1 &&
+                    messages[1].flags == I2C_M_RD && messages[1].addr == messages[0].addr;
+    } else {
+      wellFormed &= count == 1;
+    }  // of if-then-else a combined transfer
+    for (uint8_t i = 0; i < count; i++) {
+      struct i2c_msg& message = messages[i];
+      bool            done;
+      if (message.flags & I2C_M_RD) {
+        done = simulator.read(message.addr, message.buf, message.len) == message.len;
+      } else {
+        done = simulator.write(message.addr, message.buf, message.len) == 0;
+      }  // of if-then-else a read
+      if (!done) {
+        errno = ENXIO;  // What the i2c-dev driver returns for an address without a device
+        return -1;
+      }  // of if-then not acknowledged
+    }    // for-next each message
+    return count;
+  }  // of method transfer()
+};   // of class FakeAdapter
+FakeAdapter   adapter;     ///< Bus of the library instance using the Linux transport
+INA_Simulator direct;      ///< Bus of the library instance used for comparison
+INA_Class     linuxINA;    ///< Library instance using the Linux transport
+INA_Class     directINA;   ///< Library instance using the simulator directly
+bool          passed{true};  ///< Cleared when a check fails
+
+void report(const char* check, const bool result) {
+  /*!
+   * @brief    Prints the result of a check
+   * @param[in] check Description of the check
+   * @param[in] result "true" if the check passed
+   */
+  printf("%-56s %s\n", check, result ? "ok" : "FAILED");
+  passed &= result;
+}  // of function report()
+
+int main() {
+  /*!
+   @brief    Runs the checks and prints the results
+   @return   Exit code, 1 if a check failed
+  */
+  for (uint8_t i = 0; i < sizeof(DEVICE_TYPES); i++) {
+    adapter.simulator.addDevice(0x40 + i, DEVICE_TYPES[i]);
+    direct.addDevice(0x40 + i, DEVICE_TYPES[i]);
+    adapter.simulator.setInputs(0x40 + i, 5000000 + i * 1000000, 1000000 * (i + 1));
+    direct.setInputs(0x40 + i, 5000000 + i * 1000000, 1000000 * (i + 1));
+  }  // for-next each device type
+  linuxINA.addBus(adapter);
+  directINA.addBus(direct);
+  uint8_t found = linuxINA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  bool    same  = found == directINA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  for (uint8_t i = 0; i < found && same; i++) {
+    same = strcmp(linuxINA.getDeviceName(i), directINA.getDeviceName(i)) == 0 &&
+           linuxINA.getDeviceAddress(i) == directINA.getDeviceAddress(i);
+  }  // for-next each device
+  report("begin() finds the same devices", same && found == sizeof(DEVICE_TYPES) + 2);
+  adapter.simulator.advance(100000);  // Let all devices convert
+  direct.advance(100000);
+  uint32_t registerReads{0}, directTransactions{0};
+  adapter.transfers = 0;
+  direct.resetCounters();
+  for (uint8_t i = 0; i < found && same; i++) {
+    inaMeasurement viaLinux, viaDirect;
+    linuxINA.readMeasurement(viaLinux, i);
+    directINA.readMeasurement(viaDirect, i);
+    same = viaLinux.busMilliVolts == viaDirect.busMilliVolts &&
+           viaLinux.shuntMicroVolts == viaDirect.shuntMicroVolts &&
+           viaLinux.busMicroAmps == viaDirect.busMicroAmps &&
+           viaLinux.busMicroWatts == viaDirect.busMicroWatts;
+    const char* name = linuxINA.getDeviceName(i);
+    registerReads += strcmp(name, "INA260") == 0 ? 3 : strncmp(name, "INA3221", 7) == 0 ? 2 : 4;
+  }  // for-next each device
+  directTransactions = direct.getTransactions();
+  report("readMeasurement() reads the same values", same);
+  printf("%u register reads: %u ioctl() calls, %u transactions on the direct transport\n",
+         registerReads, adapter.transfers, directTransactions);
+  report("each register read is one ioctl() call", adapter.transfers == registerReads);
+  report("transfers are single messages or pointer write and read", adapter.wellFormed);
+  report("a write to a missing device fails with code 2", adapter.write(0x4F, nullptr, 0) == 2);
+  return passed ? 0 : 1;
+}  // of function main()
@@ -0,0 +1,125 @@
+/*!
+ @file MeasurementReads.cpp
+
+ @brief Host program checking that readMeasurement() matches the getters with fewer transactions
+
+ @section MeasurementReads_section Description
+
+ Program for Linux which reads simulated devices, see "INA_Simulator.h", of each supported type
+ with "readMeasurement()" and with the four "getBus...()" and "getShunt...()" calls, in continuous
+ and in triggered mode. The inputs are stepped through INPUT_STEPS bus and shunt voltages over
+ each type's range, including negative shunt voltages, and both ways of reading must give the same
+ values for every step.\n\n
+
+ The I2C transactions of each way are counted as well. "readMeasurement()" has to read each of the
+ registers the type needs once, the bus, shunt, current and power registers of the INA219, INA226
+ family and INA228, no shunt register on the INA260 and only the bus and shunt registers on the
+ INA3221, and to start a triggered conversion just once. As every register read needs the pointer
+ written first, that is at most 2 transactions per register plus the trigger, see "EXPECTED". The
+ trigger is one write of the configuration register, whose value is kept by the library, except on
+ the INA228 which needs its ADC_CONFIG register read and written.\n\n
+
+ The program prints the transactions for each type and mode and returns 1 when a value differs or
+ "readMeasurement()" needs more transactions than expected.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -I../../src ../../src/INA.cpp ../../src/INA_Simulator.cpp
+ MeasurementReads.cpp -o MeasurementReads && ./MeasurementReads
+
+ @section MeasurementReads_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+
+/**************************************************************************************************
+** Declare program constants and the expected transactions                                       **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint16_t INPUT_STEPS{200};         ///< Input voltages checked for each type and mode
+/*! One device type with its input ranges and the transactions readMeasurement() may take */
+struct deviceCase {
+  uint8_t     type;                 ///< Type, see "ina_Type"
+  const char* name;                 ///< Name printed
+  int32_t     maxBusMicroVolts;     ///< Largest bus voltage stepped through
+  int32_t     maxShuntNanoVolts;    ///< Largest absolute shunt voltage stepped through
+  uint8_t     registers;            ///< Registers readMeasurement() has to read
+  uint8_t     triggerTransactions;  ///< Transactions to start a triggered conversion
+};
+const deviceCase EXPECTED[]{
+    {INA219, "INA219", 26000000, 40000000, 4, 1},   {INA226, "INA226", 36000000, 80000000, 4, 1},
+    {INA228, "INA228", 85000000, 40000000, 4, 3},   {INA230, "INA230", 28000000, 80000000, 4, 1},
+    {INA231, "INA231", 28000000, 80000000, 4, 1},   {INA260, "INA260", 36000000, 30000000, 3, 1},
+    {INA3221_0, "INA3221", 26000000, 160000000, 2, 1}};  ///< Each type checked
+
+int main() {
+  /*!
+   @brief    Checks every device type in both modes and prints the transaction counts
+   @return   Exit code, 1 if a value differs or readMeasurement() needs too many transactions
+  */
+  bool passed{true};
+  printf("type     mode       getters readMeasurement expected\n");
+  for (const deviceCase& expected : EXPECTED) {
+    INA_Simulator simulator;
+    INA_Class     INA;
+    simulator.addDevice(0x40, expected.type);
+    INA.addBus(simulator);
+    INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+    for (uint8_t triggered = 0; triggered < 2; triggered++) {
+      INA.setMode(triggered ? INA_MODE_TRIGGERED_BOTH : INA_MODE_CONTINUOUS_BOTH);
+      uint32_t settleMicros = 2 * simulator.getConversionMicros(0x40);  // Simulated time
+      uint32_t getterTransactions{0}, readTransactions{0};
+      uint16_t differences{0};
+      for (int32_t step = 0; step < INPUT_STEPS; step++) {
+        int32_t busMicroVolts  = (int64_t)expected.maxBusMicroVolts * step / INPUT_STEPS;
+        int32_t shuntNanoVolts = (int64_t)expected.maxShuntNanoVolts * (2 * step - INPUT_STEPS) /
+                                 INPUT_STEPS;  // From the negative to the positive maximum
+        if (expected.type == INA260) shuntNanoVolts /= 1000;  // 2mOhm internal shunt
+        simulator.setInputs(0x40, busMicroVolts, shuntNanoVolts);
+        simulator.advance(settleMicros);  // Finish the conversion in progress
+        inaMeasurement measurement;
+        INA.readMeasurement(measurement, 0);  // Triggers a conversion of the new inputs
+        simulator.advance(settleMicros);
+        simulator.resetCounters();
+        inaMeasurement getters;
+        getters.busMilliVolts   = INA.getBusMilliVolts(0);
+        getters.shuntMicroVolts = INA.getShuntMicroVolts(0);
+        getters.busMicroAmps    = INA.getBusMicroAmps(0);
+        getters.busMicroWatts   = INA.getBusMicroWatts(0);
+        getterTransactions += simulator.getTransactions();
+        simulator.advance(settleMicros);  // The getters have triggered another conversion
+        simulator.resetCounters();
+        INA.readMeasurement(measurement, 0);
+        readTransactions += simulator.getTransactions();
+        if (measurement.busMilliVolts != getters.busMilliVolts ||
+            measurement.shuntMicroVolts != getters.shuntMicroVolts ||
+            measurement.busMicroAmps != getters.busMicroAmps ||
+            measurement.busMicroWatts != getters.busMicroWatts) {
+          if (differences++ == 0) {
+            printf("%s %umV %duV %duA %lduW differs from the getters' %umV %duV %duA %lduW\n",
+                   expected.name, measurement.busMilliVolts, measurement.shuntMicroVolts,
+                   measurement.busMicroAmps, (long)measurement.busMicroWatts,
+                   getters.busMilliVolts, getters.shuntMicroVolts, getters.busMicroAmps,
+                   (long)getters.busMicroWatts);
+          }  // of if-then first difference
+        }    // of if-then values differ
+      }      // for-next each input step
+      uint8_t allowed = 2 * expected.registers + (triggered ? expected.triggerTransactions : 0);
+      float   reads   = (float)readTransactions / INPUT_STEPS;
+      printf("%-8s %-10s %7.2f %15.2f %8u%s\n", expected.name,
+             triggered ? "triggered" : "continuous", (float)getterTransactions / INPUT_STEPS,
+             reads, allowed, differences ? " VALUES DIFFER" : reads > allowed ? " FAILED" : "");
+      passed &= differences == 0 && reads <= allowed;
+    }  // for-next continuous and triggered mode
+  }    // for-next each device type
+  return passed ? 0 : 1;
+}  // of function main()
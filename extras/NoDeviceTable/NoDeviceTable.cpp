@@ -0,0 +1,170 @@
+/*!
+ @file NoDeviceTable.cpp
+
+ @brief Host program checking that the devices are still used when the device table can't be
+        allocated
+
+ @section NoDeviceTable_section Description
+
+ Program for Linux which makes every array allocation fail while "begin()" and "rescan()" run, as
+ on a microcontroller without enough free RAM, so that the library has no resident device table
+ and reads each device's stored structure whenever another device is accessed. It searches for an
+ INA226 at 0x40, an INA219 at 0x41 and an INA3221 at 0x44, see "INA_Simulator.h". The checks are,
+ in this order:\n
+ - "begin()" still finds all five devices, they are named correctly and read correctly, also
+   when they are read alternately\n
+ - "readChannels()" reads all three INA3221 channels\n
+ - a changed configuration is kept, the stored structure is read again after it is written\n
+ - "setAutoRange()" is refused, the ranges are only kept in the table\n
+ - an INA226 added at 0x45 is found by "rescan()" and read correctly without the table\n
+ - once memory is available again "begin()" builds the table and the devices read correctly\n\n
+
+ On the host "new" throws instead of returning a null pointer as on a microcontroller, so the
+ program replaces the array "operator new[]" and is built with "-fcheck-new", so that no
+ constructors are run on a failed allocation. The program prints the results and returns 1 if a
+ check fails.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -fcheck-new -I../../src ../../src/INA.cpp ../../src/INA_Simulator.cpp
+ NoDeviceTable.cpp -o NoDeviceTable && ./NoDeviceTable
+
+ @section NoDeviceTable_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+/**************************************************************************************************
+** Declare program constants, global variables and the failing allocation                        **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const int32_t  MICRO_AMPS{24000};        ///< Current of the inputs, a multiple of the shunt LSBs
+const int32_t  AMPS_SLACK{100};          ///< Current readings may be off by a few LSB
+INA_Simulator  simulator;                ///< Simulated bus
+bool           passed{true};             ///< Cleared when a check fails
+bool           outOfMemory{false};       ///< Set while array allocations fail
+
+void* operator new[](size_t size) {
+  /*!
+   * @brief    Array allocation which fails while "outOfMemory" is set
+   * @param[in] size Bytes requested
+   * @return   The memory, a null pointer while "outOfMemory" is set
+   */
+  if (outOfMemory) return nullptr;
+  void* memory = malloc(size ? size : 1);
+  if (memory == nullptr) throw std::bad_alloc();
+  return memory;
+}  // of function operator new[]()
+void operator delete[](void* memory) noexcept {
+  /*!
+   * @brief    Frees memory of "operator new[]()"
+   * @param[in] memory Memory to free, may be a null pointer
+   */
+  free(memory);
+}  // of function operator delete[]()
+
+void report(const char* check, const bool result) {
+  /*!
+   * @brief    Prints the result of a check
+   * @param[in] check Description of the check
+   * @param[in] result "true" if the check passed
+   */
+  printf("%-68s %s\n", check, result ? "ok" : "FAILED");
+  passed &= result;
+}  // of function report()
+
+bool correct(const inaMeasurement& measurement) {
+  /*!
+   * @brief    Compares readings with the inputs, 12V and MICRO_AMPS
+   * @param[in] measurement Readings to compare
+   * @return   "true" if the readings match the inputs
+   */
+  return measurement.busMilliVolts == 12000 &&
+         measurement.busMicroAmps > MICRO_AMPS - AMPS_SLACK &&
+         measurement.busMicroAmps < MICRO_AMPS + AMPS_SLACK;
+}  // of function correct()
+
+bool allReadCorrectly(INA_Class& INA, const uint8_t devices) {
+  /*!
+   * @brief    Reads all devices twice, alternating between them, and compares the readings
+   * @param[in] INA Library instance
+   * @param[in] devices Number of devices
+   * @return   "true" if all devices read correctly
+   */
+  bool correctAll{true};
+  simulator.advance(100000);  // Lets initialized devices finish their conversions
+  for (uint8_t n = 0; n < 2 * devices; n++) {
+    inaMeasurement measurement;
+    uint8_t        i = n % devices;
+    correctAll &= INA.readMeasurement(measurement, i) && correct(measurement) &&
+                  INA.getBusMilliVolts(i) == 12000;
+  }  // for-next each reading
+  return correctAll;
+}  // of function allReadCorrectly()
+
+void setInputs(const uint8_t deviceAddress, const uint8_t channels) {
+  /*!
+   * @brief    Sets 12V and MICRO_AMPS through the shunt on all channels of a device
+   * @param[in] deviceAddress Address of the device
+   * @param[in] channels Number of channels
+   */
+  for (uint8_t channel = 0; channel < channels; channel++) {
+    simulator.setInputs(deviceAddress, 12000000, MICRO_AMPS * SHUNT_MICRO_OHM / 1000, channel);
+  }  // for-next each channel
+}  // of function setInputs()
+
+int main() {
+  /*!
+   @brief    Runs the checks and prints the results
+   @return   Exit code, 1 if a check failed
+  */
+  simulator.addDevice(0x40, INA226);
+  simulator.addDevice(0x41, INA219);
+  simulator.addDevice(0x44, INA3221_0);
+  setInputs(0x40, 1);
+  setInputs(0x41, 1);
+  setInputs(0x44, 3);
+  INA_Class INA;
+  INA.addBus(simulator);
+  outOfMemory = true;
+  report("begin() finds all devices without the table",
+         INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 5);
+  report("they are named correctly", strcmp(INA.getDeviceName(0), "INA226") == 0 &&
+                                         strcmp(INA.getDeviceName(1), "INA219") == 0 &&
+                                         strcmp(INA.getDeviceName(4), "INA3221") == 0);
+  report("they read correctly, also alternately", allReadCorrectly(INA, 5));
+  inaMeasurement channels[3];
+  report("readChannels() reads all INA3221 channels", INA.readChannels(channels, 3) == 3 &&
+                                                          correct(channels[0]) &&
+                                                          correct(channels[2]));
+  uint32_t continuousMicros = INA.getReadMicros(1);
+  INA.setMode(INA_MODE_TRIGGERED_BOTH, 1);
+  INA.getDeviceName(0);  // Another device, the next call reads the stored structure again
+  report("a changed mode is kept", INA.getReadMicros(1) > continuousMicros &&
+                                       allReadCorrectly(INA, 5));
+  report("setAutoRange() is refused", !INA.setAutoRange(true, 1));
+  simulator.addDevice(0x45, INA226);
+  setInputs(0x45, 1);
+  report("rescan() adds a device without the table",
+         INA.rescan(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 1 && allReadCorrectly(INA, 6));
+  outOfMemory = false;
+  INA_Class withTable;
+  withTable.addBus(simulator);
+  report("with memory begin() builds the table",
+         withTable.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 6 && withTable.setAutoRange(true, 1) &&
+             allReadCorrectly(withTable, 6));
+  return passed ? 0 : 1;
+}  // of function main()
@@ -0,0 +1,126 @@
+/*!
+ @file PointerTracking.cpp
+
+ @brief Host program counting the transactions saved by tracking the devices' register pointers
+
+ @section PointerTracking_section Description
+
+ Program for Linux which runs sequences of register reads against a simulated INA226, see
+ "INA_Simulator.h", and counts their I2C transactions. The INA devices keep their register pointer
+ between transactions, so the library only writes the pointer when the last transaction left it at
+ another register and otherwise just reads. Each sequence has the number of transactions it takes
+ with the pointer tracked and without, when every read writes the pointer first. Writes and resets
+ move the pointer, so the first read after them has to write it again.\n\n
+
+ The simulated device answers a read from the register its pointer is at, so a read which relied
+ on a wrong pointer would return another register's value. The inputs don't change, so every value
+ read is compared with the register value they give, SHUNT_REGISTER and BUS_REGISTER. The program
+ prints the transactions of each sequence and returns 1 if a count differs from the expected one or
+ a value is wrong.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -I../../src ../../src/INA.cpp ../../src/INA_Simulator.cpp
+ PointerTracking.cpp -o PointerTracking && ./PointerTracking
+
+ @section PointerTracking_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+
+/**************************************************************************************************
+** Declare program constants, global variables and the sequences to count                        **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint8_t  REPEATS{10};              ///< Reads of the same register in the repeated sequences
+INA_Simulator  simulator;                ///< Simulated bus
+INA_Class      INA;                      ///< Library instance being checked
+const int32_t  SHUNT_REGISTER{1000};     ///< 2.5mV in the INA226's 2.5uV LSB
+const uint32_t BUS_REGISTER{9600};       ///< 12V in the INA226's 1.25mV LSB
+bool           valuesCorrect{true};      ///< Cleared when a value read is wrong
+
+void expectShunt(const int32_t raw) {
+  /*!
+   * @brief    Checks a shunt reading against the shunt register's value
+   * @param[in] raw Shunt reading to check
+   */
+  valuesCorrect &= raw == SHUNT_REGISTER;
+}  // of function expectShunt()
+
+void expectBus(const uint32_t raw) {
+  /*!
+   * @brief    Checks a bus reading against the bus register's value
+   * @param[in] raw Bus reading to check
+   */
+  valuesCorrect &= raw == BUS_REGISTER;
+}  // of function expectBus()
+
+/*! typedef contains one sequence of reads with its expected transaction counts */
+typedef struct {
+  const char* name;       ///< Name shown in the results
+  uint16_t    tracked;    ///< Expected transactions with pointer tracking
+  uint16_t    untracked;  ///< Transactions if every read wrote the pointer
+  void (*prepare)();      ///< Leaves the pointer where the sequence starts, not counted
+  void (*run)();          ///< Sequence whose transactions are counted
+} sequence;               // of structure
+const sequence SEQUENCES[]{
+    {"repeated shunt reads", REPEATS + 1, 2 * REPEATS, []() { INA.getBusRaw(); },
+     []() {
+       for (uint8_t i = 0; i < REPEATS; i++) expectShunt(INA.getShuntRaw());
+     }},
+    {"alternating bus and shunt reads", 4 * REPEATS, 4 * REPEATS, []() { INA.getBusRaw(); },
+     []() {
+       for (uint8_t i = 0; i < REPEATS; i++) {
+         int32_t  shunt = INA.getShuntRaw();
+         uint32_t bus   = INA.getBusRaw();
+         expectShunt(shunt);
+         expectBus(bus);
+       }  // for-next each pair
+     }},
+    {"polling the ready flag", REPEATS + 1, 2 * REPEATS, []() { INA.getBusRaw(); },
+     []() {
+       for (uint8_t i = 0; i < REPEATS; i++) INA.conversionFinished();
+     }},
+    {"shunt read after setMode()", 2, 2, []() { INA.setMode(INA_MODE_CONTINUOUS_BOTH); },
+     []() { expectShunt(INA.getShuntRaw()); }},
+    {"shunt read after reset()", 2, 2,
+     []() {
+       INA.getShuntRaw();
+       INA.reset();
+       simulator.advance(10000);  // The reset cleared the results, wait for a conversion
+     },
+     []() { expectShunt(INA.getShuntRaw()); }}};
+
+int main() {
+  /*!
+   @brief    Counts the transactions of each sequence and prints them
+   @return   Exit code, 1 if a count differs from the expected one or a value is wrong
+  */
+  simulator.addDevice(0x40, INA226);
+  simulator.setInputs(0x40, 12000000, 2500000);  // 12V bus, 2.5mV across the shunt
+  INA.addBus(simulator);
+  INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  simulator.advance(10000);  // Let the first conversion finish
+  bool passed{true};
+  printf("sequence                          tracked untracked expected\n");
+  for (const sequence& test : SEQUENCES) {
+    test.prepare();
+    simulator.resetCounters();
+    test.run();
+    uint32_t transactions = simulator.getTransactions();
+    printf("%-33s %7u %9u %8u%s\n", test.name, transactions, test.untracked, test.tracked,
+           transactions == test.tracked ? "" : " FAILED");
+    passed &= transactions == test.tracked;
+  }  // for-next each sequence
+  if (!valuesCorrect) printf("A value read relied on a wrong register pointer\n");
+  return passed && valuesCorrect ? 0 : 1;
+}  // of function main()
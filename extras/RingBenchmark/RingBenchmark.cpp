@@ -0,0 +1,155 @@
+/*!
+ @file RingBenchmark.cpp
+
+ @brief Host program measuring the sustained throughput of the INA_SampleRing between two threads
+
+ @section RingBenchmark_section Description
+
+ Program for Linux which runs the producer and consumer of an "INA_SampleRing" on two threads, the
+ same way an ESP32 program would sample on one core and log on the other. It makes 2 runs:\n
+ "ring" - the producer pushes copies of one sample as fast as it can, which measures the ring
+ itself\n
+ "simulator" - the producer reads raw samples from simulated devices with "readRawSample()", see
+ "INA_Simulator.h", which measures the library's sampling path\n\n
+
+ In both runs the consumer takes the samples out with "drain()" in batches of up to BATCH_SIZE
+ and converts them with "convertSample()". It checks that the samples arrive in the order they
+ were pushed, taking the reported drops into account, so that a torn or reordered sample is
+ detected. For each run the program prints the samples produced, drained and reported as dropped
+ per second and the average batch size. Drops after the last sample drained are not reported. On a
+ host with a single CPU the two threads only alternate at the scheduler's time slices, so the
+ results are only meaningful with at least 2 cores. Compile with e.g. "-DINA_RING_SIZE=128" to try other ring sizes.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -pthread -I../../src ../../src/INA.cpp ../../src/INA_Simulator.cpp
+ RingBenchmark.cpp -o RingBenchmark && ./RingBenchmark [seconds]
+
+ @section RingBenchmark_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <thread>
+
+/**************************************************************************************************
+** Declare program constants and global variables                                                **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint8_t  SIMULATED_DEVICES{8};     ///< INA226 devices on the simulated bus
+const uint8_t  BATCH_SIZE{8};            ///< Samples taken out by each drain() call
+INA_Class         INA;                   ///< Library instance being sampled
+INA_Simulator     simulator;             ///< Simulated bus
+std::atomic<bool> running{false};        ///< Cleared to stop the producer
+std::atomic<bool> producing{false};      ///< Set while the producer thread runs
+uint32_t          produced{0};           ///< Samples made by the producer in the last run
+
+void produce(INA_SampleRing* ring, const bool useSimulator) {
+  /*!
+   @brief    Producer thread, adds samples until "running" is cleared
+   @details  Each sample's "micros" field is replaced by a sequence number so that the consumer
+             can check the order. Without the simulator the producer waits while the ring is full,
+             which measures the lossless throughput. With the simulator a sample which finds
+             the ring full is dropped, as a sampling task would do
+   @param[in] ring Ring to add the samples to
+   @param[in] useSimulator "true" to read the samples from the simulated devices
+  */
+  inaRawSample sample{};  // Sample to add
+  uint32_t     sequence{0};
+  uint8_t      deviceNumber{0};
+  while (running.load(std::memory_order_relaxed)) {
+    if (useSimulator) {
+      INA.readRawSample(sample, deviceNumber);
+      deviceNumber = (deviceNumber + 1) % SIMULATED_DEVICES;
+    }  // of if-then read from the simulator
+    sample.micros = sequence++;
+    while (!useSimulator && ring->full()) std::this_thread::yield();  // Let the consumer drain
+    ring->push(sample);
+  }  // of while-loop running
+  produced = sequence;
+  producing.store(false, std::memory_order_release);
+}  // of function produce()
+
+void benchmark(const char* name, const bool useSimulator, const uint32_t seconds) {
+  /*!
+   @brief    Runs the producer thread and consumes its samples on this thread
+   @param[in] name Name of the run to print
+   @param[in] useSimulator "true" to read the samples from the simulated devices
+   @param[in] seconds Duration of the run
+  */
+  INA_SampleRing ring;                 // Ring being measured
+  inaRawSample   samples[BATCH_SIZE];  // Samples taken out of the ring
+  inaMeasurement measurement;          // Converted sample
+  uint64_t       drained{0}, batches{0}, errors{0};
+  int64_t        checksum{0};  // Keeps the conversions from being optimized away
+  uint32_t       expected{0};  // Sequence number of the next sample
+  running.store(true);
+  producing.store(true);
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  std::thread producer(produce, &ring, useSimulator);
+  std::thread timer([seconds]() {
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running.store(false);
+  });
+  while (producing.load(std::memory_order_acquire) || ring.available()) {
+    uint8_t count = ring.drain(samples, BATCH_SIZE);
+    if (count == 0) continue;
+    batches++;
+    for (uint8_t i = 0; i < count; i++) {
+      expected += samples[i].dropped;  // Skip the samples the producer dropped
+      if (samples[i].dropped == UINT8_MAX ? samples[i].micros < expected  // Count saturated
+                                          : samples[i].micros != expected) {
+        errors++;
+      }  // of if-then sample out of order
+      expected = samples[i].micros + 1;
+      if (useSimulator && INA.convertSample(samples[i], measurement)) {
+        checksum += measurement.busMicroAmps;
+      }  // of if-then sample converted
+    }    // for-next each sample
+    drained += count;
+  }  // of while-loop samples to drain
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  producer.join();
+  timer.join();
+  double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  printf("%-9s produced %10.0f/s drained %10.0f/s dropped %10.0f/s batch %4.2f order errors %llu\n",
+         name, produced / elapsed, drained / elapsed, ring.getOverruns() / elapsed,
+         batches ? (double)drained / batches : 0.0, (unsigned long long)errors);
+  if (checksum == 1) printf("\n");  // Use the checksum
+}  // of function benchmark()
+
+int main(int argc, char* argv[]) {
+  /*!
+   @brief    Sets up the simulated devices and makes both runs
+   @param[in] argc Number of command line arguments
+   @param[in] argv Command line arguments, the optional first one is the duration of each run
+   @return   Exit code
+  */
+  uint32_t seconds = argc > 1 ? atoi(argv[1]) : 2;
+  for (uint8_t i = 0; i < SIMULATED_DEVICES; i++) {
+    simulator.addDevice(0x40 + i, INA226);
+    simulator.setInputs(0x40 + i, 12000000 + i * 1000000, 2500000);
+  }  // for-next each simulated device
+  INA.addBus(simulator);
+  if (INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM) != SIMULATED_DEVICES) {
+    printf("Simulated devices not found\n");
+    return 1;
+  }  // of if-then devices missing
+  printf("INA_RING_SIZE %u, batches of up to %u samples, %u seconds per run\n", INA_RING_SIZE,
+         BATCH_SIZE, seconds);
+  benchmark("ring", false, seconds);
+  benchmark("simulator", true, seconds);
+  return 0;
+}  // of function main()
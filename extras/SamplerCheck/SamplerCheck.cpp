@@ -0,0 +1,154 @@
+/*!
+ @file SamplerCheck.cpp
+
+ @brief Host program checking that INA_Sampler collects each conversion of each device once
+
+ @section SamplerCheck_section Description
+
+ Program for Linux which calls "INA_Sampler::poll()" every STEP_MICROS for WINDOW_MICROS against
+ simulated devices in both modes, see "INA_Simulator.h":\n
+ - an INA226 at 0x40 in triggered mode\n
+ - an INA219 at 0x41 in continuous mode\n
+ - an INA3221 at 0x42 in triggered mode, whose three channels share one configuration register
+   and one conversion ready flag\n\n
+
+ The library source is compiled into this program with "micros()" and "delayMicroseconds()"
+ replaced by the simulator's virtual clock, so that every run gives the same results. Before each
+ transaction the bus voltage inputs are set from the virtual clock, see "TimedSimulator", so that
+ the readings of each conversion differ from those of the one before. The checks are, in this
+ order:\n
+ - "begin()" picks up all five devices\n
+ - no device is collected twice for the same conversion, i.e. two readings in a row always
+   differ\n
+ - the continuous device is collected for every conversion it finishes, the triggered ones for no
+   more conversions than fit into the time passed. The bus traffic moves the virtual clock too, so
+   more time than WINDOW_MICROS passes\n
+ - the INA3221 channels are collected together, in the same call, and equally often\n\n
+
+ The program prints the number of readings of each device and returns 1 if a check fails.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -I../../src ../../src/INA_Simulator.cpp SamplerCheck.cpp -o SamplerCheck
+ && ./SamplerCheck
+
+ @section SamplerCheck_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+
+/**************************************************************************************************
+** Declare program constants, the simulator, global variables and the library's clock           **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint32_t STEP_MICROS{100};         ///< Time between two calls to "poll()"
+const uint32_t WINDOW_MICROS{500000};    ///< Time slept between the calls to "poll()"
+const uint8_t  DEVICES{5};               ///< INA226, INA219 and the three INA3221 channels
+const uint8_t  ADDRESSES[DEVICES]{0x40, 0x41, 0x42, 0x42, 0x42};  ///< Address of each device
+const bool     TRIGGERED[DEVICES]{true, false, true, true, true};  ///< Mode of each device
+const uint16_t SAMPLES[DEVICES]{1, 4, 1, 1, 1};     ///< Conversions longer than a call to "poll()"
+/*! INA_Simulator whose bus voltage inputs follow the virtual clock, 10mV more every 10us */
+class TimedSimulator : public INA_Simulator {
+ public:
+  uint8_t write(const uint8_t deviceAddress, const uint8_t* data, const uint8_t length) {
+    setBusInputs();
+    return INA_Simulator::write(deviceAddress, data, length);
+  }  // of method write()
+  uint8_t read(const uint8_t deviceAddress, uint8_t* data, const uint8_t length) {
+    setBusInputs();
+    return INA_Simulator::read(deviceAddress, data, length);
+  }  // of method read()
+  void setBusInputs() {
+    /*!
+     * @brief    Sets the bus voltage inputs of all devices from the virtual clock
+     * @details  The inputs go from 1V to 21V in 20ms and are then repeated, conversions which are
+     *           latched at least 10us and less than 20ms apart therefore read different values.
+     *           The INA3221 channels are 1V apart
+     */
+    int32_t busMicroVolts = 1000000 + (getNanos() / 10000 % 2000) * 10000;
+    setInputs(0x40, busMicroVolts, 2500000);
+    setInputs(0x41, busMicroVolts, 2500000);
+    for (uint8_t channel = 0; channel < 3; channel++) {
+      setInputs(0x42, busMicroVolts + channel * 1000000, 2500000, channel);
+    }  // for-next each channel
+  }    // of method setBusInputs()
+};     // of class TimedSimulator
+TimedSimulator simulator;     ///< Simulated bus
+bool           passed{true};  ///< Cleared when a check fails
+
+#define micros() ((uint32_t)(simulator.getNanos() / 1000))  ///< Library's clock, the simulator's
+#define delayMicroseconds(us) simulator.advance((us))       ///< Library's sleep, on the same clock
+#include <INA.cpp>  // Zanshin INA Library, compiled with the clock above
+
+void report(const char* check, const bool result) {
+  /*!
+   * @brief    Prints the result of a check
+   * @param[in] check Description of the check
+   * @param[in] result "true" if the check passed
+   */
+  printf("%-62s %s\n", check, result ? "ok" : "FAILED");
+  passed &= result;
+}  // of function report()
+
+int main() {
+  /*!
+   @brief    Runs the checks and prints the results
+   @return   Exit code, 1 if a check failed
+  */
+  INA_Class INA;
+  simulator.addDevice(0x40, INA226);
+  simulator.addDevice(0x41, INA219);
+  simulator.addDevice(0x42, INA3221_0);
+  INA.addBus(simulator);
+  INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  INA.setI2CSpeed(INA_I2C_FAST_MODE);  // Keeps the reads short compared to a conversion
+  for (uint8_t i = 0; i < DEVICES; i++) {
+    INA.configure(TRIGGERED[i] ? INA_MODE_TRIGGERED_BOTH : INA_MODE_CONTINUOUS_BOTH, SAMPLES[i],
+                  1100, 1100, i);
+  }  // for-next each device
+  INA_Sampler sampler(INA);
+  report("begin() picks up all devices", sampler.begin() == DEVICES);
+  uint32_t       readings[DEVICES]{0};
+  inaMeasurement last[DEVICES];
+  bool           repeated{false};  // Set when a device is collected twice for one conversion
+  bool           together{true};   // Cleared when the INA3221 channels are collected apart
+  uint64_t       start = simulator.getNanos();
+  for (uint32_t step = 0; step < WINDOW_MICROS / STEP_MICROS; step++) {
+    sampler.poll();
+    for (uint8_t i = 0; i < DEVICES; i++) {
+      inaMeasurement measurement;
+      if (!sampler.read(measurement, i)) continue;
+      if (readings[i] > 0 && measurement.busMilliVolts == last[i].busMilliVolts) repeated = true;
+      last[i] = measurement;
+      readings[i]++;
+    }  // for-next each device
+    together &= readings[2] == readings[3] && readings[3] == readings[4];
+    simulator.advance(STEP_MICROS);
+  }  // for-next each step
+  uint32_t elapsed = (simulator.getNanos() - start) / 1000;
+  bool     counted{true};
+  printf("%u us passed\n", elapsed);
+  for (uint8_t i = 0; i < DEVICES; i++) {
+    uint32_t conversions = elapsed / simulator.getConversionMicros(ADDRESSES[i]);
+    printf("device %u at 0x%02X, %-10s %4u readings, %4u conversions fit\n", i, ADDRESSES[i],
+           TRIGGERED[i] ? "triggered" : "continuous", readings[i], conversions);
+    if (TRIGGERED[i]) {
+      counted &= readings[i] <= conversions && readings[i] >= conversions / 2;
+    } else {
+      counted &= readings[i] + 2 >= conversions && readings[i] <= conversions + 1;
+    }  // of if-then-else triggered
+  }    // for-next each device
+  report("no device is collected twice for the same conversion", !repeated);
+  report("each device is collected once for each of its conversions", counted);
+  report("the INA3221 channels are collected in the same call", together);
+  return passed ? 0 : 1;
+}  // of function main()
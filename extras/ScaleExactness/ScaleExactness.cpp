@@ -0,0 +1,170 @@
+/*!
+ @file ScaleExactness.cpp
+
+ @brief Host program checking the precomputed scale factors against the 64-bit division formulas
+
+ @section ScaleExactness_section Description
+
+ Program for Linux which checks that the multiplier and shift pairs of "computeScales()" convert
+ every raw register value exactly like the integer formulas they replace, e.g.
+ "raw * current_LSB / 1000" with 64-bit arithmetic, for every device type. The library source is
+ compiled into this program so that its file-scope "scaleValue()" is the function being checked.
+ \n\n
+
+ For each device type the bus and shunt voltages are checked over the full range of their
+ registers, the current and power for each combination of MAXIMUM_AMPS and SHUNT_MICRO_OHM. The
+ INA219 is also checked with automatic ranging, where its current and power readings are scaled up
+ to the LSB of the smallest range, and the INA3221 current and power over its whole shunt voltage
+ range. The INA228 formulas use the exact fractions of the datasheet's maxBusAmps / 2^19 current
+ LSB. The program prints the number of values checked for each type and the first mismatch, if
+ any, and returns 1 when a value differs.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -I../../src ScaleExactness.cpp -o ScaleExactness && ./ScaleExactness
+
+ @section ScaleExactness_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA.cpp>  // Zanshin INA Library, compiled in for its file-scope scaleValue()
+#include <stdio.h>
+
+/**************************************************************************************************
+** Declare program constants and global variables                                                **
+**************************************************************************************************/
+const uint16_t MAXIMUM_AMPS[]{1, 2, 3, 5, 10, 20, 50, 100, 250, 500, 1022};  ///< maxBusAmps values
+const uint32_t SHUNT_MICRO_OHM[]{100,    1000,   2000,  10000,
+                                 100000, 500000, 1000000};  ///< microOhmR values
+const uint8_t  DEVICE_TYPES[]{INA219, INA226, INA228, INA230,
+                             INA231, INA260, INA3221_0};  ///< Device types to check
+const char*    TYPE_NAMES[]{"INA219", "INA226", "INA228", "INA230",
+                         "INA231", "INA260", "INA3221"};  ///< Names of DEVICE_TYPES
+uint64_t       checked{0};                                 ///< Values compared
+uint64_t       mismatches{0};                              ///< Values which differed
+
+bool check(const char* quantity, const inaDet& device, const int32_t raw, const int64_t scaled,
+           const int64_t expected) {
+  /*!
+   * @brief    Compares one scaled value with the result of the division formula
+   * @param[in] quantity Name of the value printed for a mismatch
+   * @param[in] device Device structure the value was scaled with
+   * @param[in] raw Raw register value
+   * @param[in] scaled Value from the multiplier and shift pair
+   * @param[in] expected Value from the division formula
+   * @return   "true" when the values are equal
+   */
+  checked++;
+  if (scaled == expected) return true;
+  if (mismatches++ == 0) {
+    printf("%s mismatch: type %u, %uA, %u micro-ohm, raw %d gives %lld instead of %lld\n",
+           quantity, device.type, device.maxBusAmps, device.microOhmR, raw, (long long)scaled,
+           (long long)expected);
+  }  // of if-then first mismatch
+  return false;
+}  // of function check()
+
+void checkVoltages(const inaDet& device) {
+  /*!
+   * @brief    Checks the bus and shunt voltage pairs of a device over their registers' range
+   * @param[in] device Device structure to check
+   */
+  int32_t maxBus = device.type == INA228 ? 0xFFFFF : UINT16_MAX;  // Unsigned bus registers
+  for (int32_t raw = 0; raw <= maxBus; raw++) {
+    int64_t expected = device.type == INA228 ? (int64_t)raw * 1953125 / 10000000
+                                             : (int64_t)raw * device.busVoltage_LSB / 100;
+    if (!check("bus", device, raw, scaleValue(raw, device.busVoltageMult, device.busVoltageShift),
+               expected))
+      return;
+  }  // for-next each bus register value
+  if (device.type == INA260) return;  // No shunt voltage register
+  int32_t maxShunt = device.type == INA228 ? 0x3FFFFF : 0xFFFFF;  // INA228 in 78.125nV units
+  for (int32_t raw = -maxShunt; raw <= maxShunt; raw++) {
+    int64_t expected = device.type == INA228 ? (int64_t)raw * 78125 / 1000000
+                                             : (int64_t)raw * device.shuntVoltage_LSB / 10;
+    if (!check("shunt", device, raw,
+               scaleValue(raw, device.shuntVoltageMult, device.shuntVoltageShift), expected))
+      return;
+  }  // for-next each shunt register value
+}  // of function checkVoltages()
+
+void checkCurrentPower(const inaDet& device) {
+  /*!
+   * @brief    Checks the current and power pairs of a device over their registers' range
+   * @param[in] device Device structure to check
+   */
+  if (device.type == INA3221_0) {  // Computed from the shunt voltage in microvolts
+    for (int32_t microVolts = -163840; microVolts <= 163840; microVolts++) {
+      int64_t current = (int64_t)microVolts * ((int64_t)1000000 / (int64_t)device.microOhmR);
+      int64_t power   = (int64_t)microVolts * 1000000 / (int64_t)device.microOhmR;
+      if (!check("current", device, microVolts,
+                 scaleValue(microVolts, device.currentMult, device.currentShift), current) ||
+          !check("power", device, microVolts,
+                 scaleValue(microVolts, device.powerMult, device.powerShift), power))
+        return;
+    }  // for-next each shunt voltage
+  } else if (device.type == INA228) {  // 20-bit current and 24-bit power register
+    for (int32_t raw = -0x80000; raw <= 0x80000; raw++) {
+      int64_t expected = (int64_t)raw * device.maxBusAmps * 1000000 / 524288;
+      if (!check("current", device, raw,
+                 scaleValue(raw, device.currentMult, device.currentShift), expected))
+        return;
+    }  // for-next each current register value
+    for (int32_t raw = 0; raw <= 0xFFFFFF; raw++) {
+      int64_t expected = (int64_t)raw * device.maxBusAmps * 3200000 / 524288;
+      if (!check("power", device, raw, scaleValue(raw, device.powerMult, device.powerShift),
+                 expected))
+        return;
+    }  // for-next each power register value
+  } else {
+    int32_t maxRaw = (int32_t)32768 << (device.autoRange ? 3 : 0);  // Scaled up by the range
+    for (int32_t raw = -maxRaw; raw <= maxRaw; raw++) {
+      int64_t current = (int64_t)raw * (int64_t)device.current_LSB / (int64_t)1000;
+      int64_t power   = (int64_t)raw * (int64_t)device.power_LSB / (int64_t)1000;
+      if (!check("current", device, raw,
+                 scaleValue(raw, device.currentMult, device.currentShift), current) ||
+          !check("power", device, raw, scaleValue(raw, device.powerMult, device.powerShift),
+                 power))
+        return;
+    }  // for-next each current and power register value
+  }    // of if-then-else an INA3221 or INA228
+}  // of function checkCurrentPower()
+
+int main() {
+  /*!
+   @brief    Checks every device type and prints the results
+   @return   Exit code, 1 if a value differs
+  */
+  for (uint8_t i = 0; i < sizeof(DEVICE_TYPES); i++) {
+    uint8_t   type  = DEVICE_TYPES[i];
+    uint64_t  start = checked;
+    inaEEPROM stored;
+    stored.type       = type;
+    stored.maxBusAmps = MAXIMUM_AMPS[0];
+    stored.microOhmR  = SHUNT_MICRO_OHM[0];
+    checkVoltages(inaDet(stored));  // The voltage LSBs only depend on the type
+    for (uint16_t amps : MAXIMUM_AMPS) {
+      for (uint32_t microOhm : SHUNT_MICRO_OHM) {
+        stored.maxBusAmps = amps;
+        stored.microOhmR  = microOhm;
+        inaDet device(stored);
+        checkCurrentPower(device);
+        if (type == INA219) {  // Also with the readings scaled to the smallest range
+          device.autoRange = 1;
+          computeScales(device);
+          checkCurrentPower(device);
+        }  // of if-then an INA219
+      }    // for-next each shunt
+    }      // for-next each maximum current
+    printf("%-7s %12llu values checked\n", TYPE_NAMES[i], (unsigned long long)(checked - start));
+  }  // for-next each device type
+  printf("%llu values checked, %llu mismatches\n", (unsigned long long)checked,
+         (unsigned long long)mismatches);
+  return mismatches == 0 ? 0 : 1;
+}  // of function main()
@@ -0,0 +1,164 @@
+/*!
+ @file ScheduleCheck.cpp
+
+ @brief Host program checking the scheduling core of the INA_BackgroundSampler
+
+ @section ScheduleCheck_section Description
+
+ Program for Linux which calls "INA_BackgroundSampler::run()" with chosen times against three
+ simulated INA226 devices, see "INA_Simulator.h", instead of starting its thread, so that every
+ result is known in advance. The library source is compiled into this program with "micros()"
+ replaced by the same clock as the one passed to "run()". The checks are, in this order:\n
+ - "setPeriod()" refuses a period which would need more than INA_SCHEDULE_UTILIZATION percent of
+   the bus time, alone and together with another device, and accepts one below it\n
+ - when all devices are due at once they are read earliest deadline first, i.e. shortest period
+   first, which the order of the callbacks shows\n
+ - a reading finished within its deadline doesn't count as missed, one finished after it counts
+   once and one which falls more than a period behind also counts the readings skipped. A device
+   still due after its reading isn't read again in the same call\n
+ - a device marked offline by "rescan()" is neither counted as read nor as missed, and is read
+   again once it is back\n\n
+
+ A reading takes the bus time "getReadMicros()" on the schedule, which is COST_MICROS for an
+ INA226 in continuous mode at 100KHz. The program prints the results and returns 1 if a check
+ fails.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -I../../src ../../src/INA_Simulator.cpp ScheduleCheck.cpp -o ScheduleCheck
+ && ./ScheduleCheck
+
+ @section ScheduleCheck_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+
+/**************************************************************************************************
+** Declare program constants, the unpluggable bus, global variables and the library's clock      **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint32_t COST_MICROS{1880};        ///< 4 registers of 47 bit times at 100KHz
+const uint32_t PERIOD{10000};            ///< Period of the device checked for missed deadlines
+/*! INA_Simulator whose devices can be unplugged, they then don't acknowledge their address */
+class UnpluggableSimulator : public INA_Simulator {
+ public:
+  uint16_t unplugged{0};  ///< Bit set for each address 0x40-0x4F which is unplugged
+  uint8_t  write(const uint8_t deviceAddress, const uint8_t* data, const uint8_t length) {
+    if (bitRead(unplugged, deviceAddress & 0x0F)) return 2;  // Address not acknowledged
+    return INA_Simulator::write(deviceAddress, data, length);
+  }  // of method write()
+  uint8_t read(const uint8_t deviceAddress, uint8_t* data, const uint8_t length) {
+    if (bitRead(unplugged, deviceAddress & 0x0F)) return 0;
+    return INA_Simulator::read(deviceAddress, data, length);
+  }  // of method read()
+};                              // of class UnpluggableSimulator
+UnpluggableSimulator simulator;  ///< Simulated bus
+uint32_t             clockMicros{5000};  ///< Library's micros(), starting at an arbitrary time
+uint8_t              order[8];           ///< Device numbers in the order of the callbacks
+uint8_t              callbacks{0};       ///< Number of callbacks
+bool                 passed{true};       ///< Cleared when a check fails
+
+#define micros() (clockMicros)  ///< Library's clock, the times passed to "run()"
+#include <INA.cpp>              // Zanshin INA Library, compiled with the clock above
+
+void report(const char* check, const bool result) {
+  /*!
+   * @brief    Prints the result of a check
+   * @param[in] check Description of the check
+   * @param[in] result "true" if the check passed
+   */
+  printf("%-64s %s\n", check, result ? "ok" : "FAILED");
+  passed &= result;
+}  // of function report()
+
+void recordOrder(const uint8_t deviceNumber, const inaMeasurement&, const uint32_t) {
+  /*!
+   * @brief    Sampler callback, records the order in which the devices are read
+   * @param[in] deviceNumber Device read
+   */
+  if (callbacks < sizeof(order)) order[callbacks] = deviceNumber;
+  callbacks++;
+}  // of function recordOrder()
+
+void runAt(INA_BackgroundSampler& sampler, const uint32_t microSeconds) {
+  /*!
+   * @brief    Moves the clock and the simulator to a time and runs the scheduling core once
+   * @param[in] sampler Sampler to run
+   * @param[in] microSeconds Time, relative to the start of the clock
+   */
+  simulator.advance(microSeconds - (clockMicros - 5000));
+  clockMicros = 5000 + microSeconds;
+  sampler.run(clockMicros);
+}  // of function runAt()
+
+int main() {
+  /*!
+   @brief    Runs the checks and prints the results
+   @return   Exit code, 1 if a check failed
+  */
+  INA_Class INA;
+  for (uint8_t i = 0; i < 3; i++) simulator.addDevice(0x40 + i, INA226);
+  INA.addBus(simulator);
+  INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  INA_BackgroundSampler sampler(INA);
+  sampler.begin(0);  // Nothing sampled yet, all devices due at once
+  sampler.setCallback(recordOrder);
+  report("getReadMicros() is the expected cost", INA.getReadMicros(0) == COST_MICROS);
+  report("a period needing 95% of the bus time is refused",
+         !sampler.setPeriod(0, COST_MICROS * 100 / 95));
+  report("a period needing 85% of the bus time is accepted",
+         sampler.setPeriod(0, COST_MICROS * 100 / 85));
+  sampler.setPeriod(0, COST_MICROS * 2);  // 50%
+  report("45% more with another device at 50% is refused",
+         !sampler.setPeriod(1, COST_MICROS * 100 / 45));
+  report("35% more with another device at 50% is accepted",
+         sampler.setPeriod(1, COST_MICROS * 100 / 35));
+  sampler.setPeriod(0, 3 * PERIOD);  // All due now, deadlines in the reverse order
+  sampler.setPeriod(1, PERIOD);
+  sampler.setPeriod(2, 2 * PERIOD);
+  runAt(sampler, 0);
+  report("readings are taken earliest deadline first",
+         callbacks == 3 && order[0] == 1 && order[1] == 2 && order[2] == 0);
+  sampler.setPeriod(0, 0);  // Only device 1 from here on
+  sampler.setPeriod(2, 0);
+  inaScheduleStats stats;
+  sampler.readScheduleStats(stats, 1, true);  // Reset by the next run()
+  runAt(sampler, PERIOD + PERIOD / 2);  // Due at PERIOD, deadline 2 * PERIOD, finishes before
+  sampler.readScheduleStats(stats, 1);
+  report("a reading within its deadline isn't missed", stats.readings == 1 && stats.missed == 0);
+  runAt(sampler, 3 * PERIOD - COST_MICROS / 2);  // Deadline 3 * PERIOD, finishes half a read late
+  sampler.readScheduleStats(stats, 1);
+  report("a reading finished after its deadline is missed once",
+         stats.readings == 2 && stats.missed == 1);
+  runAt(sampler, 6 * PERIOD + PERIOD / 2);  // Due at 3 * PERIOD, 2 more readings have passed
+  sampler.readScheduleStats(stats, 1);
+  report("a reading 2.5 periods late also misses the 2 readings skipped",
+         stats.readings == 3 && stats.missed == 4);
+  runAt(sampler, 7 * PERIOD - COST_MICROS);  // Next due at 6 * PERIOD, finishes on its deadline
+  sampler.readScheduleStats(stats, 1);
+  report("the schedule continues one period after the skipped readings",
+         stats.readings == 4 && stats.missed == 4);
+  bitSet(simulator.unplugged, 1);
+  INA.rescan(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  for (uint8_t i = 8; i <= 12; i++) runAt(sampler, i * PERIOD);
+  sampler.readScheduleStats(stats, 1);
+  report("rescan() marks the unplugged device offline", !INA.isOnline(1));
+  report("an offline device is neither counted as read nor as missed",
+         stats.readings == 4 && stats.missed == 4);
+  bitClear(simulator.unplugged, 1);
+  INA.rescan(MAXIMUM_AMPS, SHUNT_MICRO_OHM);
+  runAt(sampler, 13 * PERIOD - COST_MICROS);  // Due at 12 * PERIOD, finishes on its deadline
+  sampler.readScheduleStats(stats, 1);
+  report("the device is read on schedule once it is back",
+         INA.isOnline(1) && stats.readings == 5 && stats.missed == 4);
+  return passed ? 0 : 1;
+}  // of function main()
@@ -0,0 +1,198 @@
+/*!
+ @file SimulatorCheck.cpp
+
+ @brief Host program checking the simulated devices against the datasheets and the library
+
+ @section SimulatorCheck_section Description
+
+ Program for Linux which checks the models of "INA_Simulator.h" which the other host programs
+ rely on. Each supported type is added to a new simulator on its own and checked in this order:\n
+ - the power-on reset values of the configuration registers, which "begin()" uses to tell the
+   types apart, and the manufacturer and die IDs, see RESET_VALUES\n
+ - that "begin()" detects the type\n
+ - for each of SETTINGS, that the simulated conversion time is the one the library computes from
+   the configuration register, and that a triggered conversion takes that long. The time is
+   measured on the virtual clock from the write which triggers the conversion to the conversion
+   ready alert, on the types whose alert pin can signal it. It has to match to the microsecond\n
+ - for each of SETTINGS, that the conversion ready flag is clear half way through a triggered
+   conversion and set after it\n\n
+
+ The timing and flag checks write and read the registers through the simulator directly, so the
+ library's copy of the register pointer is out of date after them and each check uses a new
+ simulator. The program prints the results for each type and returns 1 if a check fails.\n\n
+
+ Build and run from this directory with:\n
+ g++ -O2 -std=gnu++11 -I../../src ../../src/INA.cpp ../../src/INA_Simulator.cpp
+ SimulatorCheck.cpp -o SimulatorCheck && ./SimulatorCheck
+
+ @section SimulatorCheck_license GNU General Public License v3.0
+
+ This program is free software : you can redistribute it and/or modify it under the terms of the
+ GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ License, or (at your option) any later version.This program is distributed in the hope that it
+ will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.You should
+ have received a copy of the GNU General Public License along with this program(see
+ https://github.com/Zanduino/INA/blob/master/LICENSE).  If not, see
+ <http://www.gnu.org/licenses/>.
+*/
+#include <INA_Simulator.h>  // Zanshin INA Library with simulated devices
+#include <stdio.h>
+#include <string.h>
+
+/**************************************************************************************************
+** Declare program constants, the expected values and global variables                           **
+**************************************************************************************************/
+const uint32_t SHUNT_MICRO_OHM{100000};  ///< Shunt resistance in Micro-Ohm, e.g. 100000 is 0.1 Ohm
+const uint16_t MAXIMUM_AMPS{1};          ///< Max expected amps, clamped from 1A to a max of 1022A
+const uint8_t  NONE{0};                  ///< Register number for an ID which the type doesn't have
+/*! One device type with its datasheet reset and ID values and its flag registers */
+struct deviceCase {
+  uint8_t     type;              ///< Type, see "ina_Type"
+  const char* name;              ///< Name "getDeviceName()" has to return
+  uint8_t     configRegister;    ///< Register with the conversion settings
+  uint16_t    configReset;       ///< Its power-on reset value
+  uint8_t     manufacturerReg;   ///< Manufacturer ID register, NONE if there is none
+  uint8_t     dieIdReg;          ///< Die ID register, NONE if there is none
+  uint16_t    dieId;             ///< Die ID with the revision in the low 4 bits masked off
+  uint8_t     flagRegister;      ///< Register with the conversion ready flag
+  uint16_t    readyFlag;         ///< Conversion ready flag
+  uint16_t    alertOnReady;      ///< Flag register bit to alert on conversion ready, 0 if none
+};
+const deviceCase RESET_VALUES[]{
+    {INA219, "INA219", 0x00, 0x399F, NONE, NONE, 0, 0x02, 0x0002, 0},
+    {INA226, "INA226", 0x00, 0x4127, 0xFE, 0xFF, 0x2260, 0x06, 0x0008, 0x0400},
+    {INA228, "INA228", 0x01, 0xFB68, 0x3E, 0x3F, 0x2280, 0x0B, 0x0002, 0x4000},
+    {INA230, "INA230", 0x00, 0x4127, NONE, NONE, 0, 0x06, 0x0008, 0x0400},
+    {INA231, "INA231", 0x00, 0x4127, NONE, NONE, 0, 0x06, 0x0008, 0x0400},
+    {INA260, "INA260", 0x00, 0x6127, 0xFE, 0xFF, 0x2270, 0x06, 0x0008, 0x0400},
+    {INA3221_0, "INA3221", 0x00, 0x7127, 0xFE, 0xFF, 0x3220, 0x0F, 0x0001, 0}};  ///< Types
+/*! Averaging and conversion times passed to "configure()" */
+struct setting {
+  uint16_t averages;     ///< Readings averaged
+  uint32_t busMicros;    ///< Bus conversion time
+  uint32_t shuntMicros;  ///< Shunt conversion time
+};
+const setting SETTINGS[]{{1, 140, 140}, {4, 1100, 332}, {16, 588, 8244}, {1, 8244, 204}};
+bool          passed{true};  ///< Cleared when a check fails
+
+bool report(const deviceCase& device, const char* check, const bool result) {
+  /*!
+   * @brief    Prints a failed check
+   * @param[in] device Type checked
+   * @param[in] check Description of the check
+   * @param[in] result "true" if the check passed
+   * @return   The result
+   */
+  if (!result) printf("%-9s %s FAILED\n", device.name, check);
+  passed &= result;
+  return result;
+}  // of function report()
+
+uint16_t readWord(INA_Simulator& simulator, const uint8_t reg) {
+  /*!
+   * @brief    Reads a 16 bit register of the device at 0x40 through the simulator
+   * @param[in] simulator Simulator with the device
+   * @param[in] reg Register to read
+   * @return   Register value
+   */
+  uint8_t data[2]{0, 0};
+  simulator.readRegister(0x40, reg, data, 2);
+  return (uint16_t)data[0] << 8 | data[1];
+}  // of function readWord()
+
+void writeWord(INA_Simulator& simulator, const uint8_t reg, const uint16_t value) {
+  /*!
+   * @brief    Writes a 16 bit register of the device at 0x40 through the simulator
+   * @param[in] simulator Simulator with the device
+   * @param[in] reg Register to write
+   * @param[in] value Value to write
+   */
+  uint8_t data[3]{reg, (uint8_t)(value >> 8), (uint8_t)value};
+  simulator.write(0x40, data, 3);
+}  // of function writeWord()
+
+uint32_t configureDevice(INA_Simulator& simulator, INA_Class& INA, const setting& settings) {
+  /*!
+   * @brief    Has the library detect the device at 0x40 and set it to a triggered mode
+   * @param[in] simulator Simulator with the device
+   * @param[in] INA Library instance to use
+   * @param[in] settings Averaging and conversion times to set
+   * @return   Conversion time computed by the library, 0 if no device was found
+   */
+  INA.addBus(simulator);
+  if (INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM) == 0) return 0;
+  INA.configure(INA_MODE_TRIGGERED_BOTH, settings.averages, settings.busMicros,
+                settings.shuntMicros, 0);
+  simulator.advance(1000000);  // Finish the conversion which the write triggered
+  return INA.getConversionMicros(0);
+}  // of function configureDevice()
+
+int main() {
+  /*!
+   @brief    Checks every device type and prints the results
+   @return   Exit code, 1 if a check failed
+  */
+  printf("type      reset  IDs  begin()  conversion times in us, simulated and measured\n");
+  for (const deviceCase& device : RESET_VALUES) {
+    INA_Simulator simulator;
+    simulator.addDevice(0x40, device.type);
+    bool reset = report(device, "configuration reset value",
+                        readWord(simulator, device.configRegister) == device.configReset);
+    if (device.type == INA228) {  // The CONFIG register only has the reset and accumulator bits
+      reset &= report(device, "CONFIG reset value", readWord(simulator, 0x00) == 0);
+    }  // of if-then an INA228
+    bool ids{true};
+    if (device.manufacturerReg != NONE) {
+      ids &= report(device, "manufacturer ID",
+                    readWord(simulator, device.manufacturerReg) == 0x5449);  // "TI"
+      ids &= report(device, "die ID",
+                    (readWord(simulator, device.dieIdReg) & 0xFFF0) == device.dieId);
+    }  // of if-then IDs
+    INA_Class INA;
+    INA.addBus(simulator);
+    bool found = INA.begin(MAXIMUM_AMPS, SHUNT_MICRO_OHM) > 0;
+    found      = report(device, "begin() detection",
+                        found && strcmp(INA.getDeviceName(0), device.name) == 0);
+    printf("%-9s %-6s %-4s %-7s", device.name, reset ? "ok" : "FAILED", ids ? "ok" : "FAILED",
+           found ? "ok" : "FAILED");
+    for (const setting& settings : SETTINGS) {
+      INA_Simulator timed;
+      INA_Class     library;
+      timed.addDevice(0x40, device.type);
+      uint32_t expected = configureDevice(timed, library, settings);
+      report(device, "simulated conversion time",
+             expected != 0 && timed.getConversionMicros(0x40) == expected);
+      printf(" %5u", timed.getConversionMicros(0x40));
+      if (device.alertOnReady != 0) {  // Measure the time to the conversion ready alert
+        writeWord(timed, device.flagRegister, device.alertOnReady);
+        readWord(timed, device.flagRegister);  // Clears the ready flag of the last conversion
+        writeWord(timed, device.configRegister, readWord(timed, device.configRegister));
+        uint64_t start = timed.getNanos();
+        while (!timed.alertAsserted(0x40) && timed.getNanos() - start < 1000000000) {
+          timed.advance(1);
+        }  // of while-loop alert not asserted
+        uint32_t measured = (timed.getNanos() - start + 999) / 1000;
+        report(device, "measured conversion time", measured == expected);
+        printf("/%-5u", measured);
+      } else {
+        printf("/-    ");
+      }  // of if-then-else conversion ready alert
+      INA_Simulator flagged;
+      INA_Class     checker;
+      flagged.addDevice(0x40, device.type);
+      configureDevice(flagged, checker, settings);
+      flagged.setClock(INA_I2C_FAST_MODE_PLUS);  // Keep the reads short compared to a conversion
+      readWord(flagged, device.flagRegister);  // Clears the ready flag of the last conversion
+      writeWord(flagged, device.configRegister, readWord(flagged, device.configRegister));
+      flagged.advance(expected / 2);
+      report(device, "ready flag clear while converting",
+             (readWord(flagged, device.flagRegister) & device.readyFlag) == 0);
+      flagged.advance(expected);
+      report(device, "ready flag set after the conversion",
+             (readWord(flagged, device.flagRegister) & device.readyFlag) != 0);
+    }  // for-next each setting
+    printf("\n");
+  }  // for-next each device type
+  return passed ? 0 : 1;
+}  // of function main()
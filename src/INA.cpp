@@ -7,12 +7,274 @@
  * See main library header file "INA.h" for details and license information
  *
  */
-#include <INA.h>   ///< Include the header definition
-#include <Wire.h>  ///< I2C Library definition
+#include <INA.h>  ///< Include the header definition
+#if defined(INA_LINUX)
+  #include <errno.h>          ///< Error codes of the i2c-dev ioctl() calls
+  #include <fcntl.h>          ///< open() for the i2c-dev device files
+  #include <stdio.h>          ///< snprintf() for the device file names
+  #include <sys/ioctl.h>      ///< ioctl() for the I2C_RDWR transfers
+  #include <unistd.h>         ///< close() for the device files
+#else
+  #include <Wire.h>  ///< I2C Library definition
+#endif
 #if defined(__AVR__) || defined(CORE_TEENSY) || defined(ESP32) || defined(ESP8266) || \
     defined(STM32F1)
   #include <EEPROM.h>  ///< Include the EEPROM library for AVR-Boards
 #endif
+/*! Number of averages of the 3-bit settings of the INA226 family, the INA3221 and the INA228 */
+static const uint16_t AVERAGES[8]{1, 4, 16, 64, 128, 256, 512, 1024};
+/*! Conversion times in microseconds of the 3-bit settings of the INA228 */
+static const uint16_t INA228_TIMES[8]{50, 84, 150, 280, 540, 1052, 2074, 4120};
+static uint8_t computeScale(uint32_t numerator, uint32_t denominator, const uint32_t maxRaw,
+                            uint64_t &multiplier) {
+  /*! @brief     Compute a multiplier and shift pair replacing "raw * numerator / denominator"
+      @details   The pair is chosen so that "(|raw| * multiplier) >> shift" gives exactly the same
+                 truncated result as the integer division for every |raw| up to maxRaw, which lets
+                 the measurement functions do a single widening multiply and shift instead of a
+                 64-bit division on every reading. The fraction is reduced first and if the
+                 denominator is then a power of 2 the multiplier is exact. Otherwise the shift is
+                 made large enough that the rounding error in the multiplier, less than 1 in
+                 2^shift, can never carry into the integer part of the result
+      @param[in] numerator Value the raw reading is multiplied by
+      @param[in] denominator Value the product is divided by
+      @param[in] maxRaw Largest absolute raw value which needs to convert exactly
+      @param[out] multiplier Computed multiplier
+      @return    Computed shift */
+  uint8_t shift{0};
+  if (denominator == 0) {
+    multiplier = 0;  // Avoid division by zero, an unset value converts to 0
+    return shift;
+  }  // of if-then no denominator
+  uint32_t gcd{numerator}, divisor{denominator}, remainder;
+  while (divisor != 0) {  // Euclid's algorithm for the greatest common divisor
+    remainder = gcd % divisor;
+    gcd       = divisor;
+    divisor   = remainder;
+  }                                              // of while-loop
+  numerator /= gcd;                              // Reduce the fraction
+  denominator /= gcd;                            // to its lowest terms
+  if ((denominator & (denominator - 1)) == 0) {  // A power of 2 divides exactly by shifting
+    while (((uint32_t)1 << shift) < denominator) shift++;
+    multiplier = numerator;
+  } else {
+    uint64_t errorBound = (uint64_t)maxRaw * (denominator - 1);  // Need 2^shift > this value
+    while (errorBound >> shift) shift++;
+    multiplier = (((uint64_t)numerator << shift) + denominator - 1) / denominator;  // Round up
+  }  // of if-then-else power of 2
+  return shift;
+}  // of function computeScale()
+static int64_t scaleValue(const int32_t raw, const uint64_t multiplier, const uint8_t shift) {
+  /*! @brief     Apply a multiplier and shift pair computed by "computeScale()" to a raw value
+      @details   The magnitude is scaled so that negative values are truncated towards zero, just as
+                 the integer division the pair replaces
+      @param[in] raw Signed raw value
+      @param[in] multiplier Multiplier to apply
+      @param[in] shift Number of bits to shift right after the multiplication
+      @return    Scaled value */
+  uint32_t magnitude = raw < 0 ? -(uint32_t)raw : (uint32_t)raw;
+  int64_t  result    = (int64_t)(((uint64_t)magnitude * multiplier) >> shift);
+  return raw < 0 ? -result : result;
+}  // of function scaleValue()
+static void computeScales(inaDet &device) {
+  /*! @brief     Precompute the multiplier and shift pairs used to convert raw readings without
+                 division
+      @details   Called by the "inaDet" constructor and again when setAutoRange() changes the LSB
+                 values. The INA228 shunt and, with automatic ranging, the INA219 current and power
+                 readings are scaled to the LSB of the smallest range when they are read, so the
+                 pairs don't change with the range
+      @param[in,out] device Device structure whose LSB values are set */
+  uint64_t multiplier;  // work variable for the computed multipliers
+  if (device.type == INA228) {
+    device.busVoltageShift = computeScale(1953125, 10000000, 0xFFFFF, multiplier);  // 195.3125uV
+    device.busVoltageMult  = multiplier;
+    device.shuntVoltageShift = computeScale(5, 64, 0x3FFFFF, multiplier);  // 78.125nV LSB to uV
+    device.shuntVoltageMult  = multiplier;
+  } else {
+    device.busVoltageShift   = computeScale(device.busVoltage_LSB, 100, UINT16_MAX, multiplier);
+    device.busVoltageMult    = multiplier;  // Always a small integer for the supported LSB values
+    device.shuntVoltageShift = computeScale(device.shuntVoltage_LSB, 10, 0xFFFFF, multiplier);
+    device.shuntVoltageMult  = multiplier;
+  }  // of if-then-else an INA228
+  if (device.type == INA228) {  // Exact fractions of maxBusAmps / 2^19, rounded LSBs lose precision
+    device.currentShift =
+        computeScale((uint32_t)device.maxBusAmps * 15625, 8192, 0x80000, device.currentMult);  // uA
+    device.powerShift =
+        computeScale((uint32_t)device.maxBusAmps * 3125, 512, 0xFFFFFF, device.powerMult);  // uW
+  } else if (device.type == INA3221_0 || device.type == INA3221_1 || device.type == INA3221_2) {
+    device.currentMult  = device.microOhmR ? 1000000 / device.microOhmR : 0;  // uA per uV
+    device.currentShift = 0;
+    device.powerShift = computeScale(1000000, device.microOhmR, 163840, device.powerMult);  // uA
+  } else {
+    uint32_t maxRaw = (uint32_t)32768 << (device.autoRange ? 3 : 0);  // Scaled up by the range
+    device.currentShift = computeScale(device.current_LSB, 1000, maxRaw, device.currentMult);  // uA
+    device.powerShift   = computeScale(device.power_LSB, 1000, maxRaw, device.powerMult);    // uW
+  }  // of if-then-else an INA3221
+}  // of function computeScales()
+#if defined(INA_STATS)
+class inaStatsTimer {
+  /*!
+   * @class   inaStatsTimer
+   * @brief   Times a public method of INA_Class for its device's latency histogram
+   * @details Only the outermost timer records, so methods calling other timed methods are counted
+   *          once in the group of the method the program called
+   */
+ public:
+  inaStatsTimer(INA_Class &owner, const uint8_t deviceNumber, const uint8_t api)
+      : _owner(owner), _start(micros()), _deviceNumber(deviceNumber), _api(api) {
+    _owner._statsDepth++;
+  }  // of class constructor
+  ~inaStatsTimer() {
+    if (--_owner._statsDepth == 0) _owner.recordLatency(_deviceNumber, _api, micros() - _start);
+  }  // of class destructor
+
+ private:
+  INA_Class &_owner;         ///< Library instance being timed
+  uint32_t   _start;         ///< micros() when the method was called
+  uint8_t    _deviceNumber;  ///< Device the time is recorded for
+  uint8_t    _api;           ///< see enumerated "ina_StatsApi"
+};                           // of inaStatsTimer definition
+  /*! Times the rest of the enclosing block for a device, see inaStatsTimer */
+  #define INA_STATS_TIMER(deviceNumber, api) inaStatsTimer statsTimer(*this, deviceNumber, api)
+#else
+  #define INA_STATS_TIMER(deviceNumber, api)
+#endif
+uint8_t INA_Transport::readRegister(const uint8_t deviceAddress, const uint8_t reg, uint8_t *data,
+                                    const uint8_t length) {
+  /*! @brief     Points a device at a register and reads from it
+      @details   The default writes the register pointer and, after a delay of I2C_DELAY
+                 microseconds to let the INAxxx devices get the return data ready, reads the bytes
+                 in a second transaction. Transports which can do a combined write and read with a
+                 repeated start should override this
+      @param[in] deviceAddress I2C address of the device
+      @param[in] reg Register to read
+      @param[out] data Buffer for the bytes read, bytes not received are left unchanged
+      @param[in] length Number of bytes to read
+      @return    Number of bytes read */
+  if (write(deviceAddress, &reg, 1) != 0) return 0;  // Send register address
+  delayMicroseconds(I2C_DELAY);                      // delay required for sync
+  return read(deviceAddress, data, length);
+}  // of method readRegister()
+#if !defined(INA_LINUX)
+INA_TwoWire::INA_TwoWire(TwoWire &wire) : _wire(wire) {
+  /*! @brief     Class constructor
+      @param[in] wire TwoWire object of the bus, e.g. "Wire" or "Wire1" */
+}  // of class constructor
+void INA_TwoWire::begin() {
+  /*! @brief     Initializes the bus */
+  _wire.begin();
+}  // of method begin()
+void INA_TwoWire::setClock(const uint32_t clockSpeed) {
+  /*! @brief     Sets the bus speed
+      @param[in] clockSpeed Speed in Herz */
+  _wire.setClock(clockSpeed);
+}  // of method setClock()
+uint8_t INA_TwoWire::write(const uint8_t deviceAddress, const uint8_t *data, const uint8_t length) {
+  /*! @brief     Writes bytes to a device in one transaction
+      @param[in] deviceAddress I2C address of the device
+      @param[in] data Bytes to write
+      @param[in] length Number of bytes, 0 just addresses the device
+      @return    0 on success, otherwise the TwoWire "endTransmission()" error code */
+  _wire.beginTransmission(deviceAddress);                    // Address the I2C device
+  for (uint8_t i = 0; i < length; i++) _wire.write(data[i]);  // Queue the bytes
+  return _wire.endTransmission();                            // Close transmission and send data
+}  // of method write()
+uint8_t INA_TwoWire::read(const uint8_t deviceAddress, uint8_t *data, const uint8_t length) {
+  /*! @brief     Reads bytes from a device in one transaction
+      @param[in] deviceAddress I2C address of the device
+      @param[out] data Buffer for the bytes read, bytes not received are left unchanged
+      @param[in] length Number of bytes to read
+      @return    Number of bytes read */
+  uint8_t count = _wire.requestFrom(deviceAddress, length);  // Request consecutive bytes
+  for (uint8_t i = 0; i < count && i < length; i++) data[i] = _wire.read();
+  return count;
+}  // of method read()
+#endif
+#if defined(INA_LINUX)
+INA_LinuxI2C::INA_LinuxI2C(const uint8_t adapter) {
+  /*! @brief     Class constructor
+      @param[in] adapter Number of the I2C adapter, e.g. 1 for "/dev/i2c-1" */
+  snprintf(_device, sizeof(_device), "/dev/i2c-%u", adapter);
+}  // of class constructor
+INA_LinuxI2C::INA_LinuxI2C(const char *device) {
+  /*! @brief     Class constructor
+      @param[in] device Path of the i2c-dev device file, e.g. "/dev/i2c-1" */
+  snprintf(_device, sizeof(_device), "%s", device);
+}  // of class constructor
+INA_LinuxI2C::~INA_LinuxI2C() {
+  /*! @brief     Class destructor, closes the device file */
+  if (_fd >= 0) close(_fd);
+}  // of class destructor
+void INA_LinuxI2C::begin() {
+  /*! @brief     Opens the device file, on failure all transfers fail and no devices are found */
+  if (_fd < 0) _fd = open(_device, O_RDWR);
+}  // of method begin()
+void INA_LinuxI2C::setClock(const uint32_t clockSpeed) {
+  /*! @brief     The bus speed is set by the kernel's device tree and can't be changed here
+      @param[in] clockSpeed Ignored */
+  (void)clockSpeed;
+}  // of method setClock()
+int INA_LinuxI2C::transfer(struct i2c_msg *messages, const uint8_t count) {
+  /*! @brief     Performs the messages as one combined transaction with repeated starts
+      @param[in,out] messages Messages to transfer
+      @param[in] count Number of messages
+      @return    Value returned by the I2C_RDWR ioctl(), negative on error */
+  struct i2c_rdwr_ioctl_data transaction;
+  transaction.msgs  = messages;
+  transaction.nmsgs = count;
+  return ioctl(_fd, I2C_RDWR, &transaction);
+}  // of method transfer()
+uint8_t INA_LinuxI2C::write(const uint8_t deviceAddress, const uint8_t *data,
+                            const uint8_t length) {
+  /*! @brief     Writes bytes to a device in one transaction
+      @param[in] deviceAddress I2C address of the device
+      @param[in] data Bytes to write
+      @param[in] length Number of bytes, 0 just addresses the device
+      @return    0 on success, 2 when the device didn't acknowledge and 4 on other errors, the
+                 same as the TwoWire "endTransmission()" codes */
+  struct i2c_msg message;
+  message.addr  = deviceAddress;
+  message.flags = 0;
+  message.len   = length;
+  message.buf   = const_cast<uint8_t *>(data);
+  if (transfer(&message, 1) >= 0) return 0;
+  return (errno == ENXIO || errno == EREMOTEIO) ? 2 : 4;
+}  // of method write()
+uint8_t INA_LinuxI2C::read(const uint8_t deviceAddress, uint8_t *data, const uint8_t length) {
+  /*! @brief     Reads bytes from a device in one transaction
+      @param[in] deviceAddress I2C address of the device
+      @param[out] data Buffer for the bytes read
+      @param[in] length Number of bytes to read
+      @return    Number of bytes read, 0 on error */
+  struct i2c_msg message;
+  message.addr  = deviceAddress;
+  message.flags = I2C_M_RD;
+  message.len   = length;
+  message.buf   = data;
+  return (transfer(&message, 1) >= 0) ? length : 0;
+}  // of method read()
+uint8_t INA_LinuxI2C::readRegister(const uint8_t deviceAddress, const uint8_t reg, uint8_t *data,
+                                   const uint8_t length) {
+  /*! @brief     Points a device at a register and reads from it in one combined transaction
+      @details   The register pointer write and the read are sent as one I2C_RDWR transaction with
+                 a repeated start, so there is no stop and no I2C_DELAY between them
+      @param[in] deviceAddress I2C address of the device
+      @param[in] reg Register to read
+      @param[out] data Buffer for the bytes read
+      @param[in] length Number of bytes to read
+      @return    Number of bytes read, 0 on error */
+  uint8_t        pointer = reg;  // Message buffers can't be const
+  struct i2c_msg messages[2];
+  messages[0].addr  = deviceAddress;
+  messages[0].flags = 0;
+  messages[0].len   = 1;
+  messages[0].buf   = &pointer;
+  messages[1].addr  = deviceAddress;
+  messages[1].flags = I2C_M_RD;
+  messages[1].len   = length;
+  messages[1].buf   = data;
+  return (transfer(messages, 2) >= 0) ? length : 0;
+}  // of method readRegister()
+#endif
 inaDet::inaDet() {}  ///< constructor for INA Detail class
 inaDet::inaDet(inaEEPROM &inaEE) {
   /*! @brief     INA Detail Class Constructor (Overloaded)
@@ -23,6 +285,9 @@ inaDet::inaDet(inaEEPROM &inaEE) {
   address       = inaEE.address;
   maxBusAmps    = inaEE.maxBusAmps;
   microOhmR     = inaEE.microOhmR;
+  bus           = inaEE.bus;
+  shuntRange    = 0;
+  autoRange     = 0;
   current_LSB   = (uint64_t)maxBusAmps * 1000000000 / 32767;  // Get the best possible LSB in nA
   power_LSB     = (uint32_t)20 * current_LSB;                 // Default multiplier per device
   switch (type) {
@@ -32,6 +297,9 @@ inaDet::inaDet(inaEEPROM &inaEE) {
       currentRegister      = INA219_CURRENT_REGISTER;
       busVoltage_LSB       = INA219_BUS_VOLTAGE_LSB;
       shuntVoltage_LSB     = INA219_SHUNT_VOLTAGE_LSB;
+      /* Lowest programmable gain range of 40, 80, 160 or 320mV which fits the maximum current */
+      while (shuntRange < 3 && (uint32_t)maxBusAmps * microOhmR / 1000 > (uint32_t)40 << shuntRange)
+        shuntRange++;
       break;
     case INA226:
     case INA230:
@@ -45,13 +313,14 @@ inaDet::inaDet(inaEEPROM &inaEE) {
       break;
 
     case INA228:
-      power_LSB            = 0;  // TODO
+      shuntRange = (uint32_t)maxBusAmps * microOhmR > INA228_ADCRANGE_MICROVOLTS;  // 163.84mV
+      current_LSB          = (uint64_t)maxBusAmps * 1000000000 / 524288;  // 20-bit register
+      power_LSB            = (uint64_t)current_LSB * 16 / 5;             // 3.2 * current_LSB
       busVoltageRegister   = INA228_BUS_VOLTAGE_REGISTER;
       busVoltage_LSB       = INA228_BUS_VOLTAGE_LSB;
       shuntVoltageRegister = INA228_SHUNT_VOLTAGE_REGISTER;
-
-      currentRegister  = INA226_CURRENT_REGISTER;
-      shuntVoltage_LSB = INA226_SHUNT_VOLTAGE_LSB;
+      currentRegister      = INA228_CURRENT_REGISTER;
+      shuntVoltage_LSB     = 1;  // 78.125nV, readShuntRegister() scales the 163.84mV range to it
       break;
 
     case INA260:
@@ -59,6 +328,7 @@ inaDet::inaDet(inaEEPROM &inaEE) {
       shuntVoltageRegister = INA260_SHUNT_VOLTAGE_REGISTER;  // Register not present
       currentRegister      = INA260_CURRENT_REGISTER;
       busVoltage_LSB       = INA260_BUS_VOLTAGE_LSB;
+      shuntVoltage_LSB     = 0;         // Register not present
       current_LSB          = 1250000;   // Fixed LSB of 1.25mv
       power_LSB            = 10000000;  // Fixed multiplier per device
       break;
@@ -83,6 +353,7 @@ inaDet::inaDet(inaEEPROM &inaEE) {
       }                               // of if-then-else INA3221_1
       break;
   }  // of switch type
+  computeScales(*this);
 }  // of constructor
 INA_Class::INA_Class(uint8_t expectedDevices) : _expectedDevices(expectedDevices) {
   /*!
@@ -96,7 +367,10 @@ INA_Class::INA_Class(uint8_t expectedDevices) : _expectedDevices(expectedDevices
 */
   if (_expectedDevices) {
     _DeviceArray = new inaEEPROM[_expectedDevices];
-  }  // if-then use memory rather than EEPROM
+  }                                 // if-then use memory rather than EEPROM
+#if !defined(INA_LINUX)
+  _bus[0].transport = &_defaultBus;  // "Wire" is used unless buses are added
+#endif
 }  // of class constructor
 INA_Class::~INA_Class() {
   /*!
@@ -105,56 +379,449 @@ INA_Class::~INA_Class() {
            then that memory is freed here; otherwise the destructor does nothing
   */
   if (_expectedDevices) { delete[] _DeviceArray; }  // if-then use memory rather than EEPROM
+  delete[] _DeviceTable;                              // Free the resident device table
+  delete[] _energy;  // Free the accumulators
+  delete[] _range;   // Free the range states
+#if defined(INA_STATS)
+  delete[] _stats;  // Free the device statistics
+#endif
 }  // of class destructor
-int16_t INA_Class::readWord(const uint8_t addr, const uint8_t deviceAddress) const {
+uint8_t INA_Class::addBus(INA_Transport &transport) {
+  /*! @brief     Adds an I2C bus to be searched for devices
+      @details   Must be called before begin(). The buses are searched in the order they were added
+                 and their devices numbered in that order. When no bus is added the "Wire" object
+                 is used
+      @param[in] transport Transport used to access the bus, e.g. an "INA_TwoWire" for "Wire1"
+      @return    Index of the bus, or UINT8_MAX if INA_MAX_BUSES buses have already been added */
+  if (_busCount >= INA_MAX_BUSES || _DeviceCount != 0) return UINT8_MAX;  // Full or too late
+  _bus[_busCount].transport = &transport;
+  return _busCount++;
+}  // of method addBus()
+uint8_t INA_Class::getDeviceBus(const uint8_t deviceNumber) {
+  /*! @brief     returns the index of the I2C bus of the device specified in the input parameter
+      @param[in] deviceNumber to return the bus of
+      @return    Bus index, see addBus(). Returns 0 if value is out-of-range */
+  if (deviceNumber >= _DeviceCount) return 0;
+  return (entry(deviceNumber).bus);
+}  // of method getDeviceBus()
+uint8_t INA_Class::getAlertingDevice(const uint8_t bus, uint16_t *flags) {
+  /*! @brief     Returns the number of a device on a bus which is pulling its ALERT pin low
+      @details   A read from the SMBus Alert Response Address is answered by the alerting INA226,
+                 INA230, INA231 or INA260 with the lowest address, so such a device is found in one
+                 transaction however many devices share the ALERT line. Its mask/enable register is
+                 then read, which releases the pin unless the alert is latched and the condition
+                 persists, so that the next call finds the next device. Devices which can't answer
+                 the Alert Response, the INA228 and INA3221, are found by reading their alert flag
+                 registers in turn, as are all devices when the answering address isn't an INA
+                 device the library found. Reading the flags clears the conversion ready flag, the
+                 value read is therefore returned in "flags"
+      @param[in] bus [optional] Index of the bus to check, see addBus()
+      @param[out] flags [optional] Receives the device's mask/enable register, for the INA228 the
+                 DIAG_ALRT register
+      @return    Device number, the first channel's for an INA3221, or UINT8_MAX if no device
+                 is alerting */
+  if (bus >= _busCount) return UINT8_MAX;  // Skip invalid buses
+  uint8_t  response{0};                    // Address sent by the alerting device
+  bool     answered = (_bus[bus].transport->read(INA_ALERT_RESPONSE_ADDRESS, &response, 1) == 1);
+  uint16_t maskRegister;  // Alert flags of a device
+  for (uint8_t i = 0; answered && i < _DeviceCount; i++)  // Find the device which answered
+  {
+    const inaDet &device = entry(i);
+    if (device.bus != bus || device.address != (response >> 1)) continue;
+    if (device.type != INA226 && device.type != INA230 && device.type != INA231 &&
+        device.type != INA260)
+      break;  // Not an Alert Response device, look at all flags
+    maskRegister = readWord(INA_MASK_ENABLE_REGISTER, device.address, device.bus);
+    if (flags != nullptr) *flags = maskRegister;
+    return i;
+  }  // for-next each device
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Check the flags of every device with a pin
+  {
+    const inaDet &device = entry(i);
+    bool          alert{false};  // Set when the device pulls its ALERT pin low
+    if (device.bus != bus) continue;
+    switch (device.type) {
+      case INA226:
+      case INA230:
+      case INA231:
+      case INA260:
+        if (!answered) continue;  // None of these is alerting, or one would have answered
+        maskRegister = readWord(INA_MASK_ENABLE_REGISTER, device.address, device.bus);
+        alert        = (maskRegister & INA_ALERT_FUNCTION_FLAG) ||
+                       (bitRead(maskRegister, INA_ALERT_CONVERSION_RDY_BIT) &&
+                        (maskRegister & INA_CONVERSION_READY_FLAG));
+        break;
+      case INA228:
+        maskRegister = readWord(INA228_DIAG_ALERT_REGISTER, device.address, device.bus);
+        alert        = (maskRegister & INA228_ALERT_FLAGS) ||
+                       ((maskRegister & INA228_ALERT_CONVERSION) &&
+                        (maskRegister & INA228_CONVERSION_READY_FLAG));
+        break;
+      case INA3221_0:  // The channels share the register, only check it for the first one
+        maskRegister = readWord(INA3221_MASK_REGISTER, device.address, device.bus);
+        alert        = (maskRegister & INA3221_ALERT_FLAGS) != 0;
+        break;
+      default: continue;  // No ALERT pin
+    }  // of switch type
+    if (alert) {
+      if (flags != nullptr) *flags = maskRegister;
+      return i;
+    }  // of if-then device is alerting
+  }    // for-next each device
+  return UINT8_MAX;
+}  // of method getAlertingDevice()
+bool INA_Class::readEnergy(inaEnergy &energy, const uint8_t deviceNumber, const bool reset) {
+  /*! @brief     Returns the energy and charge accumulated for a device since resetEnergy()
+      @details   The accumulators are fed by every complete reading of the device, those of
+                 readMeasurement(), readRawSample(), sweep() and the samplers, with each reading's
+                 power and current multiplied by the time since the previous reading. They are
+                 therefore as accurate as the readings are frequent, no separate polling is needed.
+                 The values are 64-bit integers with the sub-unit remainders kept separately, so no
+                 precision is lost however long they run. The single values of the "getBus...()"
+                 and "getShunt...()" methods don't feed them, a program which only uses those
+                 methods sees totals which never change. Must be called on the task which reads
+                 the devices
+      @param[out] energy Structure which receives the totals
+      @param[in] deviceNumber [optional] Device to return the totals of
+      @param[in] reset [optional] When "true" the device's accumulator restarts after the copy
+      @return    "true" if the totals were returned, "false" for an invalid device number or one
+                 whose accumulator wasn't started with resetEnergy() */
+  if (deviceNumber >= _DeviceCount || _energy == nullptr || !_energy[deviceNumber].enabled) {
+    return false;
+  }  // of if-then no accumulator
+  energy = _energy[deviceNumber].totals;
+  if (reset) resetEnergy(deviceNumber);
+  return true;
+}  // of method readEnergy()
+void INA_Class::resetEnergy(const uint8_t deviceNumber) {
+  /*! @brief     Starts or restarts the software energy and charge accumulators
+      @details   The accumulators are only allocated by the first call, so they cost neither memory
+                 nor time until they are used. They restart from 0 at the current time, see
+                 readEnergy(). They are discarded when "begin()" finds the devices again
+      @param[in] deviceNumber [optional] Device to reset, all devices when not specified */
+  if (_energy == nullptr && _DeviceCount != 0) _energy = new inaAccumulator[_DeviceCount]();
+  uint32_t now = micros();
+  for (uint8_t i = 0; _energy != nullptr && i < _DeviceCount; i++) {
+    if (deviceNumber == UINT8_MAX || deviceNumber == i) {
+      _energy[i]            = inaAccumulator();
+      _energy[i].lastMicros = now;
+      _energy[i].enabled    = true;
+    }  // of if-then device to reset
+  }    // of for-next each device
+}  // of method resetEnergy()
+int64_t INA_Class::getEnergyMicroJoules(const uint8_t deviceNumber) {
+  /*! @brief     Returns the energy accumulated in an INA228's ENERGY register
+      @details   The device integrates the power of every conversion in hardware, so unlike
+                 readEnergy() nothing is missed between readings. The 40-bit register counts in
+                 units of 16 * power_LSB joules since power up or resetAccumulators()
+      @param[in] deviceNumber [optional] Device to read
+      @return    Microjoules, 0 for devices other than an INA228 */
+  if (deviceNumber >= _DeviceCount || entry(deviceNumber).type != INA228) return 0;
+  INA_STATS_TIMER(deviceNumber, INA_STATS_READ);
+  const inaDet &device = entry(deviceNumber);
+  uint64_t      raw    = read5Bytes(INA228_ENERGY_REGISTER, device.address, device.bus);
+  return (raw * device.maxBusAmps * 3125 / 32);  // 16 * 3.2 * maxBusAmps / 2^19 joules per LSB
+}  // of method getEnergyMicroJoules()
+int64_t INA_Class::getChargeMicroCoulombs(const uint8_t deviceNumber) {
+  /*! @brief     Returns the charge accumulated in an INA228's CHARGE register
+      @details   The 40-bit two's complement register counts in units of current_LSB coulombs since
+                 power up or resetAccumulators(), see getEnergyMicroJoules()
+      @param[in] deviceNumber [optional] Device to read
+      @return    Signed microcoulombs, 0 for devices other than an INA228 */
+  if (deviceNumber >= _DeviceCount || entry(deviceNumber).type != INA228) return 0;
+  INA_STATS_TIMER(deviceNumber, INA_STATS_READ);
+  const inaDet &device = entry(deviceNumber);
+  int64_t raw = (int64_t)(read5Bytes(INA228_CHARGE_REGISTER, device.address, device.bus) << 24) >>
+                24;  // Shift the sign bit to the top and back down to sign extend
+  return (raw * device.maxBusAmps * 15625 / 8192);  // maxBusAmps / 2^19 coulombs per LSB
+}  // of method getChargeMicroCoulombs()
+int32_t INA_Class::getDieMilliCelsius(const uint8_t deviceNumber) {
+  /*! @brief     Returns the die temperature measured by an INA228
+      @details   The temperature is only converted while the bus or shunt voltage is, see setMode()
+      @param[in] deviceNumber [optional] Device to read
+      @return    Thousandths of a degree Celsius, 0 for devices other than an INA228 */
+  if (deviceNumber >= _DeviceCount || entry(deviceNumber).type != INA228) return 0;
+  INA_STATS_TIMER(deviceNumber, INA_STATS_READ);
+  const inaDet &device = entry(deviceNumber);
+  return ((int32_t)readWord(INA228_DIE_TEMP_REGISTER, device.address, device.bus) * 125 / 16);
+}  // of method getDieMilliCelsius()
+void INA_Class::resetAccumulators(const uint8_t deviceNumber) {
+  /*! @brief     Clears the ENERGY and CHARGE registers of INA228 devices
+      @details   Sets the self-clearing RSTACC bit of the configuration register, the ADCRANGE bit
+                 is kept. Devices of other types are skipped, their software accumulators are
+                 reset with resetEnergy()
+      @param[in] deviceNumber [optional] Device to reset, all INA228 devices when not specified */
+  for (uint8_t i = 0; i < _DeviceCount; i++) {
+    const inaDet &device = entry(i);
+    if ((deviceNumber == UINT8_MAX || deviceNumber == i) && device.type == INA228) {
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      writeWord(INA_CONFIGURATION_REGISTER,
+                readConfigRegister(device.address, device.bus) | INA228_CONFIG_RSTACC,
+                device.address, device.bus);
+      invalidateConfigShadow(device.address, device.bus);  // Device has cleared RSTACC again
+    }  // of if-then device to reset
+  }    // of for-next each device
+}  // of method resetAccumulators()
+void INA_Class::accumulate(const uint8_t deviceNumber, const inaRawSample &sample) {
+  /*! @brief     Adds a reading's energy and charge to a device's accumulator
+      @details   The power and current are held for the time since the previous reading. Each
+                 product is split into whole units and a remainder, so that neither can overflow:
+                 the whole part of the microwatts times the elapsed microseconds stays below 2^63
+                 for any reading and the remainder product below 10^6 * 2^32
+      @param[in] deviceNumber Device the reading is from
+      @param[in] sample Register values of the reading */
+  inaAccumulator &acc = _energy[deviceNumber];
+  if (!acc.enabled) return;  // Not started
+  inaMeasurement measurement;  // Converted reading
+  convertRawDevice(deviceNumber, sample, measurement);
+  uint32_t elapsed = sample.micros - acc.lastMicros;
+  acc.lastMicros   = sample.micros;
+  acc.totals.integratedMicros += elapsed;
+  int64_t picoJoules = (int64_t)(measurement.busMicroWatts % 1000000) * elapsed +
+                       acc.energyRemainder;  // Fractional microwatts plus carry
+  acc.totals.microJoules += (measurement.busMicroWatts / 1000000) * elapsed + picoJoules / 1000000;
+  acc.energyRemainder = picoJoules % 1000000;
+  int64_t picoCoulombs =
+      (int64_t)(measurement.busMicroAmps % 1000000) * elapsed + acc.chargeRemainder;
+  acc.totals.microCoulombs +=
+      (int64_t)(measurement.busMicroAmps / 1000000) * elapsed + picoCoulombs / 1000000;
+  acc.chargeRemainder = picoCoulombs % 1000000;
+}  // of method accumulate()
+#if defined(INA_STATS)
+bool INA_Class::readStats(inaStats &stats, const uint8_t deviceNumber, const bool reset) {
+  /*! @brief     Copies the statistics of a device, see "inaStats"
+      @details   Only available when the library is compiled with INA_STATS defined. The copy is a
+                 plain structure copy, so it is cheap enough to be made on every telemetry report
+      @param[out] stats Structure which receives the statistics
+      @param[in] deviceNumber to return the statistics of
+      @param[in] reset [optional] When "true" the device's statistics are zeroed after the copy
+      @return    "true" if the statistics were copied, "false" for an invalid device number */
+  if (deviceNumber >= _DeviceCount || _stats == nullptr) return false;
+  stats = _stats[deviceNumber];
+  if (reset) _stats[deviceNumber] = inaStats();
+  return true;
+}  // of method readStats()
+void INA_Class::resetStats(const uint8_t deviceNumber) {
+  /*! @brief     Zeroes the statistics of one or all devices
+      @param[in] deviceNumber [optional] Device to reset, all devices when not specified */
+  for (uint8_t i = 0; _stats != nullptr && i < _DeviceCount; i++) {
+    if (deviceNumber == UINT8_MAX || deviceNumber == i) _stats[i] = inaStats();
+  }  // of for-next each device
+}  // of method resetStats()
+inaStats *INA_Class::deviceStats(const uint8_t deviceAddress, const uint8_t bus) const {
+  /*! @brief     Returns the statistics which count the register accesses to an I2C address
+      @param[in] deviceAddress Address of the I2C device
+      @param[in] bus Index of the bus the device is on, see addBus()
+      @return    Pointer to the statistics, nullptr while the address has no device */
+  if (_stats == nullptr || (deviceAddress & 0xF0) != 0x40) return nullptr;
+  uint8_t deviceNumber = _bus[bus].statsDevice[deviceAddress & 0x0F];
+  return (deviceNumber < _DeviceCount ? &_stats[deviceNumber] : nullptr);
+}  // of method deviceStats()
+void INA_Class::recordLatency(const uint8_t deviceNumber, const uint8_t api,
+                              const uint32_t elapsedMicros) {
+  /*! @brief     Adds the duration of a public method call to a device's latency histogram
+      @details   Bucket n counts durations of 2^(n-1) to 2^n-1 microseconds, bucket 0 those under a
+                 microsecond and the last bucket everything longer. The time of the
+                 INA_STATS_WAIT methods is also added to "waitMicros"
+      @param[in] deviceNumber Device the call was made for, invalid numbers are ignored
+      @param[in] api Group of the method, see enumerated "ina_StatsApi"
+      @param[in] elapsedMicros Duration of the call */
+  if (deviceNumber >= _DeviceCount || _stats == nullptr) return;
+  inaStats &stats = _stats[deviceNumber];
+  uint8_t   bucket{0};
+  while (bucket < INA_STATS_BUCKETS - 1 && (elapsedMicros >> bucket) != 0) bucket++;
+  if (stats.latency[api][bucket] != UINT16_MAX) stats.latency[api][bucket]++;  // Saturate
+  if (api == INA_STATS_WAIT) stats.waitMicros += elapsedMicros;
+}  // of method recordLatency()
+#endif
+bool INA_Class::readRegister(const uint8_t addr, const uint8_t deviceAddress, const uint8_t bus,
+                             uint8_t *data, const uint8_t length) const {
+  /*! @brief     Read a register of a device
+      @details   The INA devices keep the register pointer between transactions, so when the last
+                 transaction to the device already left it pointing to the requested register the
+                 bytes are just read. Otherwise the transport's readRegister() sets the pointer and
+                 reads, see INA_Transport. Devices outside of the 0x40-0x4F range the library
+                 searches are not tracked and always get the pointer set. After a failed transfer
+                 the device's register pointer and configuration shadow are treated as unknown
+      @param[in] addr I2C address to read from
+      @param[in] deviceAddress Address on the I2C device to read from
+      @param[in] bus Index of the bus the device is on, see addBus()
+      @param[out] data Buffer for the bytes read, missing bytes are left unchanged
+      @param[in] length Number of bytes to read
+      @return    "true" if all bytes were read */
+  inaBus &state = _bus[bus];             // State of the device's bus
+  uint8_t slot  = deviceAddress & 0x0F;  // Index into pointer table
+  bool    tracked{(deviceAddress & 0xF0) == 0x40};
+  uint8_t count;  // Number of bytes read
+  if (tracked && bitRead(state.registerPointerValid, slot) && state.registerPointer[slot] == addr) {
+    count = state.transport->read(deviceAddress, data, length);  // Pointer is already set
+  } else {
+    count = state.transport->readRegister(deviceAddress, addr, data, length);  // Set and read
+  }  // of if-then-else pointer already set
+#if defined(INA_STATS)
+  inaStats *stats = deviceStats(deviceAddress, bus);
+  if (stats != nullptr) {
+    stats->registerReads++;
+    if (count == 0) {
+      stats->naks++;
+    } else if (count < length) {
+      stats->shortReads++;
+    }  // of if-then-else nothing or only part read
+  }    // of if-then device has statistics
+#endif
+  if (count != length || !tracked) {
+    invalidateRegisterPointer(deviceAddress, bus);  // Device state unknown on error
+    invalidateConfigShadow(deviceAddress, bus);
+    return (count == length);
+  }  // of if-then short read or untracked device
+  state.registerPointer[slot] = addr;  // Remember pointer
+  bitSet(state.registerPointerValid, slot);
+  return true;
+}  // of method readRegister()
+void INA_Class::invalidateRegisterPointer(const uint8_t deviceAddress, const uint8_t bus) const {
+  /*! @brief     Forget the tracked register pointer of a device
+      @details   Called after resets and failed transactions so that the next read explicitly sets
+                 the pointer again
+      @param[in] deviceAddress Address of the I2C device
+      @param[in] bus Index of the bus the device is on, see addBus() */
+  if ((deviceAddress & 0xF0) == 0x40) bitClear(_bus[bus].registerPointerValid, deviceAddress & 0x0F);
+}  // of method invalidateRegisterPointer()
+void INA_Class::invalidateConfigShadow(const uint8_t deviceAddress, const uint8_t bus) const {
+  /*! @brief     Forget the shadow copy of a device's configuration register
+      @details   Called after resets and failed transactions so that the next use reads the
+                 configuration register from the device again
+      @param[in] deviceAddress Address of the I2C device
+      @param[in] bus Index of the bus the device is on, see addBus() */
+  if ((deviceAddress & 0xF0) == 0x40) bitClear(_bus[bus].configShadowValid, deviceAddress & 0x0F);
+}  // of method invalidateConfigShadow()
+uint16_t INA_Class::readConfigRegister(const uint8_t deviceAddress, const uint8_t bus) const {
+  /*! @brief     Returns the contents of a device's configuration register
+      @details   The library keeps a shadow copy of the configuration register of each device in
+                 the 0x40-0x4F range, which is updated on every read and write of the register. The
+                 register is only read over I2C when there is no valid shadow copy, e.g. after a
+                 reset or a failed transaction
+      @param[in] deviceAddress Address of the I2C device
+      @param[in] bus Index of the bus the device is on, see addBus()
+      @return    Configuration register value */
+  const inaBus &state = _bus[bus];  // State of the device's bus
+  if ((deviceAddress & 0xF0) == 0x40 && bitRead(state.configShadowValid, deviceAddress & 0x0F)) {
+    return (state.configShadow[deviceAddress & 0x0F]);
+  }  // of if-then shadow copy is valid
+  return (readWord(INA_CONFIGURATION_REGISTER, deviceAddress, bus));
+}  // of method readConfigRegister()
+uint16_t INA_Class::readSettings(const inaDet &device) const {
+  /*! @brief     Returns the register holding a device's mode, averaging and conversion times
+      @details   This is the configuration register, except on the INA228 which has them in its
+                 ADC_CONFIG register. Only the configuration register has a shadow copy, so the
+                 INA228's is read from the device each time
+      @param[in] device Device structure to read the settings of
+      @return    Register value */
+  if (device.type == INA228) {
+    return (readWord(INA228_ADC_CONFIG_REGISTER, device.address, device.bus));
+  }  // of if-then an INA228
+  return (readConfigRegister(device.address, device.bus));
+}  // of method readSettings()
+void INA_Class::writeSettings(const inaDet &device, const uint16_t settings) const {
+  /*! @brief     Writes the register returned by readSettings(), which starts a new conversion
+      @param[in] device Device structure to write the settings of
+      @param[in] settings New register value */
+  if (device.type == INA228) {
+    writeWord(INA228_ADC_CONFIG_REGISTER, settings, device.address, device.bus);
+    if ((device.address & 0xF0) == 0x40) {
+      _bus[device.bus].conversionStart[device.address & 0x0F] = micros();  // Conversion restarts
+    }  // of if-then device has a conversion start time
+  } else {
+    writeWord(INA_CONFIGURATION_REGISTER, settings, device.address, device.bus);
+  }  // of if-then-else an INA228
+}  // of method writeSettings()
+int16_t INA_Class::readWord(const uint8_t addr, const uint8_t deviceAddress,
+                            const uint8_t bus) const {
   /*! @brief     Read one word (2 bytes) from the specified I2C address
-      @details   Standard I2C protocol is used, but a delay of I2C_DELAY microseconds has been
-                 added to let the INAxxx devices have sufficient time to get the return data ready
+      @details   See readRegister(), the register pointer is only written when it has changed. A
+                 successful read of the configuration register updates its shadow copy
       @param[in] addr I2C address to read from
       @param[in] deviceAddress Address on the I2C device to read from
+      @param[in] bus Index of the bus the device is on, see addBus()
       @return    integer value read from the I2C device */
-  Wire.beginTransmission(deviceAddress);        // Address the I2C device
-  Wire.write(addr);                             // Send register address to read
-  Wire.endTransmission();                       // Close transmission
-  delayMicroseconds(I2C_DELAY);                 // delay required for sync
-  Wire.requestFrom(deviceAddress, (uint8_t)2);  // Request 2 consecutive bytes
-  return ((uint16_t)Wire.read() << 8) | Wire.read();
+  uint8_t  buffer[2]{0xFF, 0xFF};  // Missing bytes read as all bits set
+  bool     success = readRegister(addr, deviceAddress, bus, buffer, 2);  // Read 2 bytes
+  uint16_t data    = ((uint16_t)buffer[0] << 8) | buffer[1];            // MSB is sent first
+  if (success && addr == INA_CONFIGURATION_REGISTER && (deviceAddress & 0xF0) == 0x40) {
+    _bus[bus].configShadow[deviceAddress & 0x0F] = data;  // Remember the configuration read
+    bitSet(_bus[bus].configShadowValid, deviceAddress & 0x0F);
+  }  // of if-then a successful configuration register read
+  return (data);
 }  // of method readWord()
-int32_t INA_Class::read3Bytes(const uint8_t addr, const uint8_t deviceAddress) const {
+int32_t INA_Class::read3Bytes(const uint8_t addr, const uint8_t deviceAddress,
+                              const uint8_t bus) const {
   /*! @brief     Read 3 bytes from the specified I2C address
-      @details   Standard I2C protocol is used, but a delay of I2C_DELAY microseconds has been
-                 added to let the INAxxx devices have sufficient time to get the return data ready
+      @details   See readRegister(), the register pointer is only written when it has changed
       @param[in] addr I2C address to read from
       @param[in] deviceAddress Address on the I2C device to read from
+      @param[in] bus Index of the bus the device is on, see addBus()
       @return    integer value read from the I2C device */
-  Wire.beginTransmission(deviceAddress);        // Address the I2C device
-  Wire.write(addr);                             // Send register address to read
-  Wire.endTransmission();                       // Close transmission
-  delayMicroseconds(I2C_DELAY);                 // delay required for sync
-  Wire.requestFrom(deviceAddress, (uint8_t)3);  // Request 3 consecutive bytes
-  return ((uint32_t)Wire.read() << 16) | ((uint32_t)Wire.read() << 8) | ((uint32_t)Wire.read());
-}  // of method readWord()
-void INA_Class::writeWord(const uint8_t addr, const uint16_t data,
-                          const uint8_t deviceAddress) const {
+  uint8_t buffer[3]{0xFF, 0xFF, 0xFF};                  // Missing bytes read as all bits set
+  readRegister(addr, deviceAddress, bus, buffer, 3);  // Read 3 bytes
+  return ((uint32_t)buffer[0] << 16) | ((uint32_t)buffer[1] << 8) | ((uint32_t)buffer[2]);
+}  // of method read3Bytes()
+uint64_t INA_Class::read5Bytes(const uint8_t addr, const uint8_t deviceAddress,
+                               const uint8_t bus) const {
+  /*! @brief     Read the 5 bytes of a 40-bit register from the specified I2C address
+      @details   See readRegister(), all 5 bytes are read in one transaction, so the value can't
+                 change between the parts of it
+      @param[in] addr I2C address to read from
+      @param[in] deviceAddress Address on the I2C device to read from
+      @param[in] bus Index of the bus the device is on, see addBus()
+      @return    Unsigned value read from the I2C device */
+  uint8_t  buffer[5]{0xFF, 0xFF, 0xFF, 0xFF, 0xFF};  // Missing bytes read as all bits set
+  uint64_t value{0};
+  readRegister(addr, deviceAddress, bus, buffer, 5);  // Read 5 bytes
+  for (uint8_t i = 0; i < 5; i++) value = (value << 8) | buffer[i];  // MSB is sent first
+  return (value);
+}  // of method read5Bytes()
+void INA_Class::writeWord(const uint8_t addr, const uint16_t data, const uint8_t deviceAddress,
+                          const uint8_t bus) const {
   /*! @brief     Write 2 bytes to the specified I2C address
       @details   Standard I2C protocol is used, but a delay of I2C_DELAY microseconds has been
-                 added to let the INAxxx devices have sufficient time to process the data
+                 added to let the INAxxx devices have sufficient time to process the data. A write
+                 leaves the device's register pointer at the register written to, except for a
+                 reset, after which the pointer is treated as unknown
       @param[in] addr I2C address to write to
       @param[in] data 2 Bytes to write to the device
-      @param[in] deviceAddress Address on the I2C device to write to */
-  Wire.beginTransmission(deviceAddress);  // Address the I2C device
-  Wire.write(addr);                       // Send register address to write
-  Wire.write((uint8_t)(data >> 8));       // Write the first (MSB) byte
-  Wire.write((uint8_t)data);              // and then the second byte
-  Wire.endTransmission();                 // Close transmission and actually send data
-  delayMicroseconds(I2C_DELAY);           // delay required for sync
+      @param[in] deviceAddress Address on the I2C device to write to
+      @param[in] bus Index of the bus the device is on, see addBus() */
+  inaBus &state = _bus[bus];                                    // State of the device's bus
+  uint8_t buffer[3]{addr, (uint8_t)(data >> 8), (uint8_t)data};  // Register address, MSB, LSB
+  uint8_t status = state.transport->write(deviceAddress, buffer, 3);  // Send data
+#if defined(INA_STATS)
+  inaStats *stats = deviceStats(deviceAddress, bus);
+  if (stats != nullptr) {
+    stats->registerWrites++;
+    if (status != 0) stats->naks++;
+  }  // of if-then device has statistics
+#endif
+  invalidateRegisterPointer(deviceAddress, bus);                       // Forget the old pointer
+  if (addr == INA_CONFIGURATION_REGISTER) invalidateConfigShadow(deviceAddress, bus);
+  if (status == 0 && (deviceAddress & 0xF0) == 0x40 &&
+      !(addr == INA_CONFIGURATION_REGISTER && (data & INA_RESET_DEVICE))) {
+    state.registerPointer[deviceAddress & 0x0F] = addr;  // Pointer is left at the written register
+    bitSet(state.registerPointerValid, deviceAddress & 0x0F);
+    if (addr == INA_CONFIGURATION_REGISTER) {
+      state.conversionStart[deviceAddress & 0x0F] = micros();  // Writing restarts the conversion
+      state.configShadow[deviceAddress & 0x0F]    = data;  // Device now holds the value written
+      bitSet(state.configShadowValid, deviceAddress & 0x0F);
+    }  // of if-then configuration register written
+  }    // of if-then a successful write which wasn't a reset
+  delayMicroseconds(I2C_DELAY);  // delay required for sync
 }  // of method writeWord()
-void INA_Class::readInafromEEPROM(const uint8_t deviceNumber) {
+void INA_Class::readInafromEEPROM(const uint8_t deviceNumber) const {
   /*! @brief     Read INA device information from EEPROM
-      @details   Retrieve the stored information for a device from EEPROM. Since this method is
-                 private and access is controlled, no range error checking is performed
+      @details   Retrieve the stored information for a device from EEPROM into the "inaEE" structure.
+                 This is only done when the resident device table is built or a device is being
+                 reconfigured, the measurement functions use "selectDevice()" instead, unless there
+                 was insufficient memory for the table, see entry(). Since this method is private
+                 and access is controlled, no range error checking is performed
       @param[in] deviceNumber Index to device array */
-  if (deviceNumber == _currentINA || deviceNumber > _DeviceCount) return;  // Skip if correct device
   if (_expectedDevices == 0) {
 #if defined(__AVR__) || defined(CORE_TEENSY) || defined(ESP32) || defined(ESP8266) || (__STM32F1__)
   #ifdef __STM32F1__                                          // STM32F1 has no built-in EEPROM
@@ -173,8 +840,9 @@ void INA_Class::readInafromEEPROM(const uint8_t deviceNumber) {
   } else {
     inaEE = _DeviceArray[deviceNumber];
   }  // if-then-else use EEPROM
-  _currentINA = deviceNumber;
-  ina         = inaEE;  // see inaDet constructor
+#if defined(INA_STATS)
+  if (_stats != nullptr && deviceNumber < _DeviceCount) _stats[deviceNumber].eepromReads++;
+#endif
 }  // of method readInafromEEPROM()
 void INA_Class::writeInatoEEPROM(const uint8_t deviceNumber) {
   /*! @brief     Write INA device information to EEPROM
@@ -203,15 +871,379 @@ void INA_Class::writeInatoEEPROM(const uint8_t deviceNumber) {
   } else {
     _DeviceArray[deviceNumber] = inaEE;
   }  // if-then-else use EEPROM to store data
+  if (_DeviceTable != nullptr && deviceNumber < _DeviceCount) {
+    _DeviceTable[deviceNumber] = ina;  // Keep the resident table in step with the stored values
+  }                                    // of if-then device is already in the table
+  if (deviceNumber == _storedNumber) _storedNumber = UINT8_MAX;  // Expand it again, see entry()
 }  // of method writeInatoEEPROM()
+void INA_Class::writeEndMarker(const uint8_t deviceNumber) {
+  /*! @brief     Stores the INA_UNKNOWN structure ending the stored devices, see beginFromStored()
+      @details   The EEPROM is only written when the marker isn't already there, so repeated calls
+                 to begin() with the same devices don't wear it
+      @param[in] deviceNumber Index to device array after the last device */
+  readInafromEEPROM(deviceNumber);
+  if (inaEE.type == INA_UNKNOWN) return;  // Already marked
+  ina.type = INA_UNKNOWN;
+  writeInatoEEPROM(deviceNumber);
+}  // of method writeEndMarker()
+void INA_Class::buildDeviceTable() {
+  /*! @brief     Build the resident table of fully computed device structures
+      @details   Each device's stored information is read from EEPROM once and expanded by the
+                 "inaDet" constructor into registers, LSB values and flags. All subsequent calls
+                 use this table so that EEPROM is only touched again when a device's configuration
+                 is changed. The table takes sizeof(inaDet) bytes per device, 48 on a 64-bit host.
+                 If there is insufficient memory for it the pointer is null and every device is
+                 read from EEPROM and expanded again when it is used, see entry() */
+  delete[] _DeviceTable;                   // Discard any previous table
+  _DeviceTable  = new inaDet[_DeviceCount];  // Allocate one entry per device found
+  _storedNumber = UINT8_MAX;                 // Discard the entry expanded without a table
+  for (uint8_t i = 0; _DeviceTable != nullptr && i < _DeviceCount; i++)  // Each device found
+  {
+    readInafromEEPROM(i);     // Load EEPROM to inaEE structure
+    _DeviceTable[i] = inaEE;  // see inaDet constructor
+  }                           // for-next each device loop
+  delete[] _energy;           // Accumulators must be restarted for the new table
+  _energy = nullptr;
+  delete[] _range;  // Automatic ranging must be enabled again for the new table
+  _range = nullptr;
+#if defined(INA_STATS)
+  delete[] _stats;                          // Statistics restart with the new table
+  _stats = new inaStats[_DeviceCount]();  // Allocate zeroed statistics for each device
+  for (uint8_t bus = 0; bus < INA_MAX_BUSES; bus++) {
+    for (uint8_t slot = 0; slot < 16; slot++) _bus[bus].statsDevice[slot] = UINT8_MAX;
+  }  // of for-next each bus
+  for (uint8_t i = _DeviceCount; _stats != nullptr && i-- > 0;) {  // Backwards, so that the
+    const inaDet &device = entry(i);                                // INA3221_0 wins
+    _bus[device.bus].statsDevice[device.address & 0x0F] = i;
+  }  // of for-next each device
+#endif
+  _currentINA = UINT8_MAX;    // Force reload on next call
+}  // of method buildDeviceTable()
+bool INA_Class::growDeviceTable(const uint8_t deviceCount) {
+  /*! @brief     Appends the devices stored after the current ones to the resident table
+      @details   Unlike buildDeviceTable() the entries, accumulators, range states and statistics
+                 of the devices already in the table are kept. The new devices start with their
+                 accumulators and automatic ranging off. Without a table, see entry(), the larger
+                 table is allocated if there is now enough memory, otherwise the devices are
+                 added without it
+      @param[in] deviceCount New number of devices, the added ones must already be stored
+      @return    "true" on success, "false" if there is insufficient memory */
+  inaDet *table = new inaDet[deviceCount];
+  if (table == nullptr && _DeviceTable != nullptr) return false;  // Keep the current table
+  for (uint8_t i = 0; table != nullptr && i < deviceCount; i++) {
+    if (i < _DeviceCount && _DeviceTable != nullptr) {
+      table[i] = _DeviceTable[i];
+    } else {
+      readInafromEEPROM(i);  // Load EEPROM to inaEE structure
+      table[i] = inaEE;      // see inaDet constructor
+    }  // of if-then-else device already known
+  }    // for-next each device
+  if (_energy != nullptr) {
+    inaAccumulator *energy = new inaAccumulator[deviceCount]();
+    for (uint8_t i = 0; energy != nullptr && i < _DeviceCount; i++) energy[i] = _energy[i];
+    delete[] _energy;
+    _energy = energy;
+  }  // of if-then accumulators allocated
+  if (_range != nullptr) {
+    inaRangeState *range = new inaRangeState[deviceCount]();
+    for (uint8_t i = 0; range != nullptr && i < _DeviceCount; i++) range[i] = _range[i];
+    delete[] _range;
+    _range = range;
+  }  // of if-then range states allocated
+#if defined(INA_STATS)
+  if (_stats != nullptr) {
+    inaStats *stats = new inaStats[deviceCount]();
+    for (uint8_t i = 0; stats != nullptr && i < _DeviceCount; i++) stats[i] = _stats[i];
+    delete[] _stats;
+    _stats = stats;
+  }  // of if-then statistics allocated
+#endif
+  delete[] _DeviceTable;
+  _DeviceTable  = table;
+  _storedNumber = UINT8_MAX;  // Discard the entry expanded without a table
+#if defined(INA_STATS)
+  for (uint8_t i = deviceCount; _stats != nullptr && i-- > _DeviceCount;) {  // INA3221_0 wins
+    const inaDet &device = entry(i);
+    _bus[device.bus].statsDevice[device.address & 0x0F] = i;
+  }  // of for-next each new device
+#endif
+  _DeviceCount = deviceCount;
+  _currentINA  = UINT8_MAX;  // Force reload on next call
+  return true;
+}  // of method growDeviceTable()
+void INA_Class::selectDevice(const uint8_t deviceNumber) {
+  /*! @brief     Make the given device the current one in the "ina" structure
+      @details   The values are copied from the resident device table, so neither EEPROM nor the
+                 "inaDet" constructor's divisions are needed when alternating between devices, see
+                 entry(). Out-of-range device numbers leave the current structure unchanged
+      @param[in] deviceNumber Index to device array */
+  if (deviceNumber == _currentINA || deviceNumber >= _DeviceCount) return;  // Skip if correct device
+  ina         = entry(deviceNumber);
+  _currentINA = deviceNumber;
+}  // of method selectDevice()
+const inaDet &INA_Class::entry(const uint8_t deviceNumber) const {
+  /*! @brief     Returns the fully computed structure of a device
+      @details   This is the device's entry in the resident table. If there was insufficient memory
+                 for the table the stored information is read from EEPROM and expanded into a
+                 single entry instead, as for every device change before the table existed. That
+                 entry is only kept until a different device is asked for, so the reference must
+                 not be held across such a call, and without the table the library must only be
+                 used from one task. Since this method is private and access is controlled, no
+                 range error checking is performed
+      @param[in] deviceNumber Index to device array
+      @return    Structure of the device */
+  if (_DeviceTable != nullptr) return _DeviceTable[deviceNumber];
+  if (deviceNumber != _storedNumber) {
+    readInafromEEPROM(deviceNumber);  // Load EEPROM to inaEE structure
+    _storedEntry  = inaEE;            // see inaDet constructor
+    _storedNumber = deviceNumber;
+  }  // of if-then another device
+  return _storedEntry;
+}  // of method entry()
 void INA_Class::setI2CSpeed(const uint32_t i2cSpeed) const {
   /*! @brief     Set a new I2C speed
       @details   I2C allows various bus speeds, see the enumerated type I2C_MODES for the standard
                  speeds. The valid speeds are  100KHz, 400KHz, 1MHz and 3.4MHz. Default to 100KHz
                  when not specified. No range checking is done.
       @param[in] i2cSpeed [optional] changes the I2C speed to the rate specified in Herz */
-  Wire.setClock(i2cSpeed);
+  for (uint8_t i = 0; i < INA_MAX_BUSES && _bus[i].transport != nullptr; i++) {
+    _bus[i].transport->setClock(i2cSpeed);  // Set every bus, including the default "Wire"
+    _bus[i].clockSpeed = i2cSpeed;          // Kept for getReadMicros()
+  }                                         // for-next each bus
 }  // of method setI2CSpeed
+uint32_t INA_Class::getI2CSpeed(const uint8_t bus) const {
+  /*! @brief     Returns the I2C speed of a bus
+      @param[in] bus [optional] Index of the bus, see addBus()
+      @return    Speed in Herz set by setI2CSpeed(), INA_I2C_STANDARD_MODE if it wasn't called */
+  if (bus >= INA_MAX_BUSES || _bus[bus].clockSpeed == 0) return INA_I2C_STANDARD_MODE;
+  return _bus[bus].clockSpeed;
+}  // of method getI2CSpeed()
+uint32_t INA_Class::getReadMicros(const uint8_t deviceNumber) const {
+  /*! @brief     Returns the bus time of one readRawSample() or readMeasurement() of a device
+      @details   Each register is counted as a combined transaction setting the register pointer
+                 and reading the value, 29 bit times plus 9 per byte read, even though the pointer
+                 is often already set. In triggered mode the write starting the next conversion, 38
+                 bit times, is added. Clock stretching and the time between transactions aren't
+                 known, so the result is a lower bound
+      @param[in] deviceNumber [optional] Device to return the time for
+      @return    Microseconds at the bus's I2C speed, rounded up, 0 for an invalid device number */
+  if (deviceNumber >= _DeviceCount) return 0;  // Skip invalid devices
+  const inaDet &device = entry(deviceNumber);
+  uint32_t      bits{29 + 9 * 2};  // Bus voltage register
+  switch (device.type) {
+    case INA3221_0:  // Shunt register only
+    case INA3221_1:
+    case INA3221_2: bits += 29 + 9 * 2; break;
+    case INA260: bits += 2 * (29 + 9 * 2); break;  // Current and power registers
+    case INA228: bits = 4 * (29 + 9 * 3); break;  // 24-bit bus, shunt, current and power
+    default: bits += 3 * (29 + 9 * 2);  // Shunt, current and power registers
+  }  // of switch type
+  if (!bitRead(device.operatingMode, 2) && (device.operatingMode & 3)) bits += 38;  // Trigger
+  uint32_t speed = getI2CSpeed(device.bus);
+  return (bits * 1000000 + speed - 1) / speed;
+}  // of method getReadMicros()
+uint8_t INA_Class::identifyDevice(const uint8_t deviceAddress, const uint8_t bus) {
+  /*! @brief     Checks whether there is an INA device at an address and returns its type
+      @details   The device is reset and the type determined from the configuration register's
+                 reset value and, for some types, the die ID register. If a device answers but isn't
+                 an INA device its original configuration register value is restored
+      @param[in] deviceAddress I2C address to check
+      @param[in] bus Index of the bus to check, see addBus()
+      @return    Device type, see "ina_Type", or INA_UNKNOWN if there is no INA device */
+  uint16_t originalRegister, tempRegister;
+  uint8_t  type{INA_UNKNOWN};
+  if (_bus[bus].transport->write(deviceAddress, nullptr, 0) != 0) return type;  // No device
+  originalRegister = readWord(INA_CONFIGURATION_REGISTER, deviceAddress, bus);  // Save settings
+  writeWord(INA_CONFIGURATION_REGISTER, INA_RESET_DEVICE, deviceAddress, bus);  // Force reset
+  tempRegister = readWord(INA_CONFIGURATION_REGISTER, deviceAddress, bus);      // Read reset reg.
+  if (tempRegister == INA_RESET_DEVICE)  // If the register wasn't reset then not an INA
+  {
+    writeWord(INA_CONFIGURATION_REGISTER, originalRegister, deviceAddress, bus);  // restore value
+  } else {
+    if (tempRegister == 0x399F) {
+      type = INA219;
+    } else {
+      if (tempRegister == 0x4127)  // INA226, INA230, INA231
+      {
+        tempRegister = readWord(INA_DIE_ID_REGISTER, deviceAddress, bus);  // Read the INA high-reg
+        if (tempRegister == INA226_DIE_ID_VALUE) {
+          type = INA226;
+        } else {
+          if (tempRegister != 0) {
+            type = INA230;
+          } else {
+            type = INA231;
+          }  // of if-then-else a INA230 or INA231
+        }    // of if-then-else an INA226
+      } else {
+        if (tempRegister == 0x6127) {
+          type = INA260;
+        } else {
+          if (tempRegister == 0x7127) {
+            type = INA3221_0;
+          } else {
+            if (tempRegister == 0x0) {
+              type = INA228;
+            }  // of if-then it is an INA228
+          }    // of if-then-else it is an INA3221
+        }      // of if-then-else it is an INA260
+      }        // of if-then-else it is an INA226, INA230, INA231
+    }          // of if-then-else it is an INA209, INA219, INA220
+  }            // of if-then-else we have an INA-Type device
+  return type;
+}  // of method identifyDevice()
+bool INA_Class::probeDevice(const uint8_t deviceAddress, const uint8_t bus, bool &answered) const {
+  /*! @brief     Checks with register reads only whether an address may hold an INA device
+      @details   identifyDevice() resets the device to tell the types apart, which would disturb
+                 another kind of device. This reads the die ID registers instead, which identify
+                 the INA226, INA228, INA260 and INA3221. The INA219, INA230 and INA231 have no
+                 unique ID, so their configuration register is checked: bits 14 and 15 clear for
+                 the INA219, and bits 14 to 12 as "100" for the other two. A device of another kind
+                 whose registers happen to read like that still passes
+      @param[in] deviceAddress I2C address to check
+      @param[in] bus Index of the bus to check, see addBus()
+      @param[out] answered Set to "true" if a device answered at the address
+      @return    "true" if identifyDevice() may reset the device */
+  uint8_t buffer[2]{0xFF, 0xFF};  // Missing bytes read as all bits set
+  answered = readRegister(INA_DIE_ID_REGISTER, deviceAddress, bus, buffer, 2);
+  if (!answered) return false;                           // Nothing at the address
+  uint16_t id = ((uint16_t)buffer[0] << 8) | buffer[1];  // MSB first
+  if (id == INA226_DIE_ID_VALUE || id == INA260_DIE_ID_VALUE || id == INA3221_DIE_ID_VALUE) {
+    return true;
+  }  // of if-then a known die ID
+  if (!readRegister(INA228_DIE_ID_REGISTER, deviceAddress, bus, buffer, 2)) return false;
+  if ((((uint16_t)buffer[0] << 8 | buffer[1]) & 0xFFF0) == INA228_DIE_ID_VALUE) return true;
+  if (!readRegister(INA_CONFIGURATION_REGISTER, deviceAddress, bus, buffer, 2)) return false;
+  uint16_t configRegister = ((uint16_t)buffer[0] << 8) | buffer[1];
+  return (configRegister & 0xC000) == 0 ||     // INA219
+         (configRegister & 0xF000) == 0x4000;  // INA230 or INA231
+}  // of method probeDevice()
+bool INA_Class::verifyDevice(const inaEEPROM &device) const {
+  /*! @brief     Checks with one register read that a stored device is still at its address
+      @details   The die ID register is compared for the INA226, INA228, INA260 and INA3221, the
+                 INA230 and INA231 are told apart by it as in identifyDevice(). The INA219 has no ID
+                 register, so its configuration register must hold the value last written to it or
+                 its power-on reset value. When no value written is known only bits 14 and 15 are
+                 checked, which are set in the configuration registers of the other types after a
+                 reset, so another device with those bits clear would pass. The device isn't reset
+                 and its registers aren't changed
+      @param[in] device Stored device to check
+      @return    "true" if the device answered as the stored type */
+  uint8_t  buffer[2]{0xFF, 0xFF};  // Missing bytes read as all bits set
+  uint8_t  idRegister = device.type == INA228   ? INA228_DIE_ID_REGISTER
+                        : device.type == INA219 ? INA_CONFIGURATION_REGISTER
+                                                : INA_DIE_ID_REGISTER;
+  if (!readRegister(idRegister, device.address, device.bus, buffer, 2)) return false;  // Missing
+  uint16_t id = ((uint16_t)buffer[0] << 8) | buffer[1];                              // MSB first
+  switch (device.type) {
+    case INA219: {
+      const inaBus &state = _bus[device.bus];
+      uint8_t       slot  = device.address & 0x0F;
+      if (id == 0x399F) return true;  // Power-on reset value
+      if (bitRead(state.configShadowValid, slot)) return id == state.configShadow[slot];
+      return (id & 0xC000) == 0;  // Reset bit and unused bit clear
+    }  // of case INA219
+    case INA226: return id == INA226_DIE_ID_VALUE;
+    case INA228: return (id & 0xFFF0) == INA228_DIE_ID_VALUE;  // Ignore the die revision
+    case INA230: return id != 0 && id != INA226_DIE_ID_VALUE;
+    case INA231: return id == 0;
+    case INA260: return id == INA260_DIE_ID_VALUE;
+    case INA3221_0: return id == INA3221_DIE_ID_VALUE;
+  }  // of switch type
+  return false;
+}  // of method verifyDevice()
+uint8_t INA_Class::storageCapacity() {
+  /*! @brief     Returns the number of device structures which can be stored
+      @details   The EEPROM of the ESP32 and ESP8266 is also allocated here. With the structures in
+                 memory, see the class constructor, the array's size is the limit
+      @return    Number of inaEEPROM structures, at most 255 */
+  uint16_t maxDevices = 32;
+/***************************************************************************************************
+** The AVR devices need to use EEPROM to save memory, some other devices have emulation for EEPROM**
+** functionality while some devices have no such function calls. This library caters for these    **
+** differences, with specialized calls for those platforms which have EEPROM calls and it makes   **
+** the assumption that if the platform has no EEPROM call then it has sufficient RAM available at **
+** runtime to allocate sufficient space for 32 devices.                                           **
+***************************************************************************************************/
+#if defined(ESP32) || defined(ESP8266)
+  EEPROM.begin(_EEPROM_size + _EEPROM_offset);  // If ESP32 then allocate 512 Bytes
+  maxDevices = (_EEPROM_size) / sizeof(inaEE);  // and compute number of devices
+#elif defined(__STM32F1__)                      // Emulated EEPROM for STM32F1
+  maxDevices = (EEPROM.maxcount() - _EEPROM_offset) / sizeof(inaEE);  // Compute max possible
+#elif defined(CORE_TEENSY)                      // TEENSY doesn't have EEPROM.length
+  maxDevices = (2048 - _EEPROM_offset) / sizeof(inaEE);  // defined, so use 2Kb as value
+#elif defined(__AVR__)
+  maxDevices = (EEPROM.length() - _EEPROM_offset) / sizeof(inaEE);  // Compute max possible
+#else
+  maxDevices = 32;
+#endif
+  if (_expectedDevices) maxDevices = _expectedDevices;  // Structures are in memory
+  if (maxDevices > 255)  // Limit number of devices to an 8-bit number
+  {
+    maxDevices = 255;
+  }  // of if-then more than 255 devices possible
+  return maxDevices;
+}  // of method storageCapacity()
+void INA_Class::startBuses() {
+  /*! @brief     Starts every I2C bus and forgets what was known about its devices */
+  if (_busCount == 0 && _bus[0].transport != nullptr) _busCount = 1;  // Use default "Wire"
+  for (uint8_t bus = 0; bus < _busCount; bus++)                       // Loop for each I2C bus
+  {
+    _bus[bus].transport->begin();
+    _bus[bus].registerPointerValid = 0;  // Nothing is known about the devices yet
+    _bus[bus].configShadowValid    = 0;
+    _bus[bus].sweepPending         = 0;
+    _bus[bus].offline              = 0;
+    _bus[bus].foreign              = 0;
+  }  // for-next each I2C bus
+}  // of method startBuses()
+uint8_t INA_Class::beginFromStored(const uint16_t maxBusAmps, const uint32_t microOhmR) {
+  /*! @brief     Initializes the contents of the class from the devices stored by an earlier begin()
+      @details   begin() probes all 16 addresses of each bus and resets every device it finds to
+                 identify it. This uses the device structures it stored in EEPROM, or in memory,
+                 see the class constructor, instead. They end at the first one of type INA_UNKNOWN,
+                 which begin() stores after the last device. Each device is checked with a single
+                 register read, see verifyDevice(), and then initialized with its stored maximum
+                 amperage and shunt resistance as begin() would do. If there are no stored devices,
+                 a structure is invalid or a device doesn't answer as the stored type, the devices
+                 are searched for with begin() and the two parameters instead. Like the search in
+                 begin() this only works on the first call. With the structures in memory, see the
+                 class constructor, nothing is stored before the first begin(), so begin() is
+                 called directly
+      @param[in] maxBusAmps Maximum expected bus amperage, only used if begin() has to search
+      @param[in] microOhmR Shunt resistance in micro-ohms, only used if begin() has to search
+      @return    The integer number of INAxxxx devices found */
+  if (_DeviceCount != 0) return _DeviceCount;                    // Devices are already known
+  if (_expectedDevices != 0) return begin(maxBusAmps, microOhmR);  // Memory isn't initialized
+  uint8_t maxDevices = storageCapacity();
+  uint8_t count{0};  // Stored devices which checked out
+  startBuses();
+  for (; count < maxDevices; count++) {
+    readInafromEEPROM(count);
+    if (inaEE.type == INA_UNKNOWN) break;  // End of the stored devices
+    bool valid = inaEE.type < INA_UNKNOWN && inaEE.bus < _busCount &&
+                 (inaEE.address & 0xF0) == 0x40 && inaEE.microOhmR != 0;
+    if (valid && (inaEE.type == INA3221_1 || inaEE.type == INA3221_2)) {  // Follows the channel
+      inaEEPROM channel = inaEE;                                         // before on the same chip
+      if (count != 0) readInafromEEPROM(count - 1);
+      valid = count != 0 && inaEE.type == channel.type - 1 && inaEE.address == channel.address &&
+              inaEE.bus == channel.bus;
+    } else if (valid) {
+      valid = verifyDevice(inaEE);
+    }  // of if-then-else second or third INA3221 channel
+    if (!valid) return begin(maxBusAmps, microOhmR);  // Search for the devices instead
+  }  // for-next each stored device
+  if (count == 0 || count == maxDevices) return begin(maxBusAmps, microOhmR);  // No terminator
+  for (uint8_t i = 0; i < count; i++) {
+    readInafromEEPROM(i);
+    ina = inaEE;  // see inaDet constructor
+    initDevice(i);
+  }                    // for-next each stored device
+  _DeviceCount = count;
+  buildDeviceTable();  // Expand all devices into the resident table
+  _currentINA = UINT8_MAX;  // Force read on next call
+  return _DeviceCount;
+}  // of method beginFromStored()
 uint8_t INA_Class::begin(const uint16_t maxBusAmps, const uint32_t microOhmR,
                          const uint8_t deviceNumber) {
   /*! @brief     Initializes the contents of the class
@@ -221,7 +1253,13 @@ uint8_t INA_Class::begin(const uint16_t maxBusAmps, const uint32_t microOhmR,
                  just that specific device is targeted. If the optional third parameter, devNo, is
                  specified that specific device gets the two specified values set for it. Can be
                  called multiple times, but the 3 parameter version will only function after the 2
-                 parameter version finds all devices.\n
+                 parameter version finds all devices. After the search the end of the devices is
+                 marked in storage, so that "beginFromStored()" can be used on the next start. The
+                 devices found are kept in a table in RAM, sizeof(inaDet) bytes per device, 48 on
+                 a 64-bit host, so that their values aren't read from EEPROM and computed again on
+                 each call. If it can't be allocated the devices are still used, but read from
+                 EEPROM whenever another device is accessed, only from one task, and without
+                 setAutoRange().\n
       @param[in] maxBusAmps Integer value holding the maximum expected bus amperage, this value is
                  used to compute a device's internal power register
       @param[in] microOhmR Shunt resistance in micro-ohms, this value is used to compute a
@@ -230,141 +1268,158 @@ uint8_t INA_Class::begin(const uint16_t maxBusAmps, const uint32_t microOhmR,
                  by default all devices found get set to the same initial values for these 2 params
       @return    The integer number of INAxxxx devices found on the I2C bus
   */
-  uint16_t originalRegister, tempRegister;
   if (_DeviceCount == 0)  // Enumerate all devices on first call
   {
-    uint16_t maxDevices = 32;
-/***************************************************************************************************
-** The AVR devices need to use EEPROM to save memory, some other devices have emulation for EEPROM**
-** functionality while some devices have no such function calls. This library caters for these    **
-** differences, with specialized calls for those platforms which have EEPROM calls and it makes   **
-** the assumption that if the platform has no EEPROM call then it has sufficient RAM available at **
-** runtime to allocate sufficient space for 32 devices.                                           **
-***************************************************************************************************/
-#if defined(ESP32) || defined(ESP8266)
-    EEPROM.begin(_EEPROM_size + _EEPROM_offset);  // If ESP32 then allocate 512 Bytes
-    maxDevices = (_EEPROM_size) / sizeof(inaEE);  // and compute number of devices
-#elif defined(__STM32F1__)                        // Emulated EEPROM for STM32F1
-    maxDevices                     = (EEPROM.maxcount() - _EEPROM_offset) / sizeof(inaEE);  // Compute max possible
-#elif defined(CORE_TEENSY)                        // TEENSY doesn't have EEPROM.length
-    maxDevices = (2048 - _EEPROM_offset) / sizeof(inaEE);  // defined, so use 2Kb as value
-#elif defined(__AVR__)
-    maxDevices = (EEPROM.length() - _EEPROM_offset) / sizeof(inaEE);  // Compute max possible
-#else
-    maxDevices = 32;
-#endif
-    Wire.begin();
-
-    if (maxDevices > 255)  // Limit number of devices to an 8-bit number
+    uint8_t maxDevices = storageCapacity();
+    startBuses();
+    for (uint8_t bus = 0; bus < _busCount; bus++)  // Loop for each I2C bus
     {
-      maxDevices = 255;
-    }  // of if-then more than 255 devices possible
-    for (uint8_t deviceAddress = 0x40; deviceAddress <= 0x4F;
-         deviceAddress++)  // Loop for each I2C addr
-    {
-      Wire.beginTransmission(deviceAddress);
-      uint8_t good = Wire.endTransmission();
-      if (good == 0 && _DeviceCount < maxDevices)  // If no error and EEPROM has space
+      for (uint8_t deviceAddress = 0x40; deviceAddress <= 0x4F;
+           deviceAddress++)  // Loop for each I2C addr
       {
-        originalRegister = readWord(INA_CONFIGURATION_REGISTER, deviceAddress);  // Save settings
-        writeWord(INA_CONFIGURATION_REGISTER, INA_RESET_DEVICE, deviceAddress);  // Force reset
-        tempRegister = readWord(INA_CONFIGURATION_REGISTER, deviceAddress);      // Read reset reg.
-        if (tempRegister == INA_RESET_DEVICE)  // If the register wasn't reset then not an INA
+        if (_DeviceCount >= maxDevices) break;          // Stop when EEPROM has no more space
+        inaEE.type = identifyDevice(deviceAddress, bus);  // Check for device and get type
+        if (inaEE.type != INA_UNKNOWN)                    // Increment device if valid INA2xx
         {
-          writeWord(INA_CONFIGURATION_REGISTER, originalRegister, deviceAddress);  // restore value
-        } else {
-          if (tempRegister == 0x399F) {
-            inaEE.type = INA219;
+          inaEE.address    = deviceAddress;
+          inaEE.bus        = bus;
+          inaEE.maxBusAmps = maxBusAmps > 1022 ? 1022 : maxBusAmps;  // Clamp to maximum of 1022A
+          inaEE.microOhmR  = microOhmR;
+          ina              = inaEE;  // see inaDet constructor
+          if (inaEE.type == INA3221_0) {
+            if (_DeviceCount + 3 > maxDevices) break;  // No space for all 3 channels
+            ina.type = INA3221_0;                      // Set to INA3221 1st channel
+            initDevice(_DeviceCount);
+            _DeviceCount++;
+            ina.type = INA3221_1;  // Set to INA3221 2nd channel
+            initDevice(_DeviceCount);
+            _DeviceCount++;
+            ina.type = INA3221_2;  // Set to INA3221 3rd channel
+            initDevice(_DeviceCount);
+            _DeviceCount++;
           } else {
-            if (tempRegister == 0x4127)  // INA226, INA230, INA231
-            {
-              tempRegister = readWord(INA_DIE_ID_REGISTER, deviceAddress);  // Read the INA high-reg
-              if (tempRegister == INA226_DIE_ID_VALUE) {
-                inaEE.type = INA226;
-              } else {
-                if (tempRegister != 0) {
-                  inaEE.type = INA230;
-                } else {
-                  inaEE.type = INA231;
-                }  // of if-then-else a INA230 or INA231
-              }    // of if-then-else an INA226
-            } else {
-              if (tempRegister == 0x6127) {
-                inaEE.type = INA260;
-              } else {
-                if (tempRegister == 0x7127) {
-                  inaEE.type = INA3221_0;
-                } else {
-                  if (tempRegister == 0x0) {
-                    inaEE.type = INA228;
-                  } else {
-                    inaEE.type = INA_UNKNOWN;
-                  }                       // of if-then-else it is an INA228
-                }                         // of if-then-else it is an INA3221
-              }                           // of if-then-else it is an INA260
-            }                             // of if-then-else it is an INA226, INA230, INA231
-          }                               // of if-then-else it is an INA209, INA219, INA220
-          if (inaEE.type != INA_UNKNOWN)  // Increment device if valid INA2xx
-          {
-            inaEE.address    = deviceAddress;
-            inaEE.maxBusAmps = maxBusAmps > 1022 ? 1022 : maxBusAmps;  // Clamp to maximum of 1022A
-            inaEE.microOhmR  = microOhmR;
-            ina              = inaEE;  // see inaDet constructor
-            if (inaEE.type == INA3221_0) {
-              ina.type = INA3221_0;  // Set to INA3221 1st channel
-              initDevice(_DeviceCount);
-              _DeviceCount = ((_DeviceCount + 1) % maxDevices);
-              ina.type     = INA3221_1;  // Set to INA3221 2nd channel
-              initDevice(_DeviceCount);
-              _DeviceCount = ((_DeviceCount + 1) % maxDevices);
-              ina.type     = INA3221_2;  // Set to INA3221 3rd channel
-              initDevice(_DeviceCount);
-              _DeviceCount = ((_DeviceCount + 1) % maxDevices);
-            } else {
-              initDevice(_DeviceCount);                          // perform initialization on device
-              _DeviceCount = ((_DeviceCount + 1) % maxDevices);  // start again at 0 if overflow
-            }                                                    // of if-then inaEE.type
-          }                                                      // of if-then we can add device
-        }  // of if-then-else we have an INA-Type device
-      }    // of if-then we have a device
-    }      // for-next each possible I2C address
+            initDevice(_DeviceCount);  // perform initialization on device
+            _DeviceCount++;
+          }  // of if-then inaEE.type
+        }                                                      // of if-then we can add device
+      }  // for-next each possible I2C address
+    }    // for-next each I2C bus
+    if (_DeviceCount < maxDevices) writeEndMarker(_DeviceCount);  // For beginFromStored()
+    buildDeviceTable();  // Expand all devices into the resident table
   } else {
-    readInafromEEPROM(deviceNumber);                         // Load EEPROM to ina structure
-    ina.maxBusAmps = maxBusAmps > 1022 ? 1022 : maxBusAmps;  // Clamp to maximum of 1022A
-    ina.microOhmR  = microOhmR;
+    if (deviceNumber >= _DeviceCount) return _DeviceCount;      // Ignore invalid device numbers
+    readInafromEEPROM(deviceNumber);                            // Load EEPROM to inaEE structure
+    inaEE.maxBusAmps = maxBusAmps > 1022 ? 1022 : maxBusAmps;  // Clamp to maximum of 1022A
+    inaEE.microOhmR  = microOhmR;
+    ina              = inaEE;  // see inaDet constructor, recomputes the LSB values
     initDevice(deviceNumber);
   }                         // of if-then-else first call
   _currentINA = UINT8_MAX;  // Force read on next call
   return _DeviceCount;
 }  // of method begin()
+uint8_t INA_Class::rescan(const uint16_t maxBusAmps, const uint32_t microOhmR) {
+  /*! @brief     Looks for devices which were added or removed since begin()
+      @details   Each known device is checked with a single register read, see verifyDevice(), and
+                 marked offline when it doesn't answer as its type, without changing its device
+                 number. readMeasurement() and readRawSample() return "false" for offline devices,
+                 see isOnline(). A device which answers again is initialized as begin() does, since
+                 it has usually lost its settings. Only addresses without a known device are
+                 searched, so known devices are never reset. A device found there is only reset to
+                 identify it when its registers read like an INA device's, see probeDevice(), and
+                 addresses of devices which turn out not to be INA devices are skipped from then
+                 on. New devices are initialized with the two parameters, stored and appended to
+                 the device table. The end marker for beginFromStored() is only moved behind them
+                 once the table has grown. If there is insufficient memory for the larger table the
+                 new devices are ignored and the marker is put back where it was. A rescan which
+                 finds nothing new costs one transaction per address, so it can be run
+                 periodically from the loop or task which reads the devices. The device table is
+                 replaced when devices are added, so convertSample() must not be called from other
+                 tasks during a rescan, and the samplers and INA_LatestTable only include the new
+                 devices after their begin() is called again. Until begin() has found devices this
+                 calls begin()
+      @param[in] maxBusAmps Maximum expected bus amperage of new devices, see begin()
+      @param[in] microOhmR Shunt resistance in micro-ohms of new devices, see begin()
+      @return    Number of devices added */
+  if (_DeviceCount == 0) return begin(maxBusAmps, microOhmR);  // First search
+  uint8_t  maxDevices = storageCapacity();
+  uint16_t known[INA_MAX_BUSES]{};  // Addresses of devices in the table
+  for (uint8_t i = 0; i < _DeviceCount; i++) {
+    const inaDet &device = entry(i);
+    uint8_t       bus    = device.bus;  // Kept, initDevice() may replace the entry, see entry()
+    uint8_t       slot   = device.address & 0x0F;
+    bitSet(known[bus], slot);
+    if (device.type == INA3221_1 || device.type == INA3221_2) continue;  // Checked with INA3221_0
+    bool online = verifyDevice(device);
+    if (online && bitRead(_bus[bus].offline, slot)) {
+      uint8_t channels = device.type == INA3221_0 ? 3 : 1;
+      for (uint8_t n = i; n < i + channels && n < _DeviceCount; n++) {
+        ina = entry(n);  // Came back, probably after a power cycle
+        initDevice(n);
+      }  // for-next each channel
+    }  // of if-then device came back
+    if (online) {
+      bitClear(_bus[bus].offline, slot);
+    } else {
+      bitSet(_bus[bus].offline, slot);
+    }  // of if-then-else device answered
+  }    // for-next each known device
+  uint8_t previous = _DeviceCount;  // Devices in the table before the search
+  uint8_t count    = _DeviceCount;  // Devices stored, including the new ones
+  for (uint8_t bus = 0; bus < _busCount; bus++) {
+    for (uint8_t slot = 0; slot < 16; slot++) {
+      if (bitRead(known[bus], slot) || bitRead(_bus[bus].foreign, slot)) continue;
+      if (count >= maxDevices) break;  // Stop when EEPROM has no more space
+      bool    answered{false};
+      uint8_t type{INA_UNKNOWN};
+      if (probeDevice(0x40 + slot, bus, answered)) type = identifyDevice(0x40 + slot, bus);
+      if (!answered) continue;  // No device
+      if (type == INA_UNKNOWN) {
+        bitSet(_bus[bus].foreign, slot);  // Don't reset it again on the next rescan
+        continue;
+      }  // of if-then not an INA device
+      inaEE.type       = type;
+      inaEE.address    = 0x40 + slot;
+      inaEE.bus        = bus;
+      inaEE.maxBusAmps = maxBusAmps > 1022 ? 1022 : maxBusAmps;  // Clamp to maximum of 1022A
+      inaEE.microOhmR  = microOhmR;
+      ina              = inaEE;  // see inaDet constructor
+      uint8_t channels = type == INA3221_0 ? 3 : 1;
+      if (count + channels > maxDevices) break;  // No space for all channels
+      for (uint8_t channel = 0; channel < channels; channel++) {
+        ina.type = type + channel;  // INA3221 channels are consecutive types
+        initDevice(count++);
+      }  // for-next each channel
+    }    // for-next each address
+  }      // for-next each I2C bus
+  if (count != previous && !growDeviceTable(count)) count = previous;  // Ignore them, no memory
+  if (count < maxDevices) writeEndMarker(count);  // Only moved once the table holds the devices
+  _currentINA = UINT8_MAX;  // "ina" was used for the devices checked, added and the end marker
+  return count - previous;
+}  // of method rescan()
+bool INA_Class::isOnline(const uint8_t deviceNumber) const {
+  /*! @brief     Returns whether a device answered the last time it was checked by rescan()
+      @param[in] deviceNumber [optional] Device to check
+      @return    "false" for an offline or invalid device, "true" otherwise */
+  if (deviceNumber >= _DeviceCount) return false;  // Skip invalid devices
+  const inaDet &device = entry(deviceNumber);
+  return !bitRead(_bus[device.bus].offline, device.address & 0x0F);
+}  // of method isOnline()
 void INA_Class::initDevice(const uint8_t deviceNumber) {
   /*! @brief     Initializes the the given devices using the settings from the internal structure
       @details   This includes (re)computing the device's calibration values.
       @param[in] deviceNumber Device number to explicitly initialize. */
   ina.operatingMode = INA_DEFAULT_OPERATING_MODE;  // Default to continuous mode
   writeInatoEEPROM(deviceNumber);                  // Store the structure to EEPROM
-  uint8_t  programmableGain;                       // work variable for the programmable gain
-  uint16_t calibration, maxShuntmV, tempRegister;  // Calibration temporary variables
+  uint16_t calibration, tempRegister;              // Calibration temporary variables
   switch (ina.type) {
     case INA219:  // Set up INA219 or INA220
-      // Compute calibration register
-      calibration = (uint64_t)409600000 /
-                    ((uint64_t)ina.current_LSB * (uint64_t)ina.microOhmR / (uint64_t)100000);
-      writeWord(INA_CALIBRATION_REGISTER, calibration, ina.address);  // Write calibration
-      /* Determine optimal programmable gain with maximum accuracy so no chance of an overflow */
-      maxShuntmV = ina.maxBusAmps * ina.microOhmR / 1000;  // Compute maximum shunt mV
-      if (maxShuntmV <= 40)
-        programmableGain = 0;  // gain x1 for +- 40mV
-      else if (maxShuntmV <= 80)
-        programmableGain = 1;  // gain x2 for +- 80mV
-      else if (maxShuntmV <= 160)
-        programmableGain = 2;  // gain x4 for +- 160mV
-      else
-        programmableGain = 3;                                   // dflt gain x8 for +- 320mV
-      tempRegister = 0x399F & INA219_CONFIG_PG_MASK;            // Zero programmable gain
-      tempRegister |= programmableGain << INA219_PG_FIRST_BIT;  // Overwrite the new values
+      calibration = rangeCalibration(ina);  // Compute calibration register
+      writeWord(INA_CALIBRATION_REGISTER, calibration, ina.address, ina.bus);  // Write calibration
+      /* The programmable gain is the range chosen by the "inaDet" constructor or setAutoRange() */
+      tempRegister = 0x399F & INA219_CONFIG_PG_MASK;              // Zero programmable gain
+      tempRegister |= ina.shuntRange << INA219_PG_FIRST_BIT;      // Overwrite the new values
       bitSet(tempRegister, INA219_BRNG_BIT);                    // set to 1 for 0-32 volts
-      writeWord(INA_CONFIGURATION_REGISTER, tempRegister, ina.address);  // Write to config register
+      writeWord(INA_CONFIGURATION_REGISTER, tempRegister, ina.address, ina.bus);  // Write to config register
       break;
     case INA226:
     case INA230:
@@ -372,7 +1427,14 @@ void INA_Class::initDevice(const uint8_t deviceNumber) {
       // Compute calibration register
       calibration = (uint64_t)51200000 /
                     ((uint64_t)ina.current_LSB * (uint64_t)ina.microOhmR / (uint64_t)100000);
-      writeWord(INA_CALIBRATION_REGISTER, calibration, ina.address);  // Write calibration
+      writeWord(INA_CALIBRATION_REGISTER, calibration, ina.address, ina.bus);  // Write calibration
+      break;
+    case INA228:
+      tempRegister = 0;
+      if (ina.shuntRange == 0) bitSet(tempRegister, INA228_CONFIG_ADCRANGE_BIT);  // +-40.96mV
+      writeWord(INA_CONFIGURATION_REGISTER, tempRegister, ina.address, ina.bus);
+      calibration = rangeCalibration(ina);
+      writeWord(INA228_SHUNT_CAL_REGISTER, calibration, ina.address, ina.bus);  // Write calibration
       break;
     case INA260:
     case INA3221_0:
@@ -380,6 +1442,153 @@ void INA_Class::initDevice(const uint8_t deviceNumber) {
     case INA3221_2: break;
   }  // of switch type
 }  // of method initDevice()
+uint16_t INA_Class::rangeCalibration(const inaDet &device) const {
+  /*! @brief     Computes the calibration register value of an INA219 or INA228 in its shunt range
+      @details   With automatic ranging the INA219 current LSB doubles with each range, so that the
+                 current register always uses its full resolution. The INA228 SHUNT_CAL is
+                 13107.2e6 * current_LSB * R, which is maxBusAmps * microOhmR / 40 for a current_LSB
+                 of maxBusAmps / 2^19, and 4 times that in the +-40.96mV range. It is rounded to the
+                 nearest integer, as small shunts and currents give values of only a few LSBs
+      @param[in] device Device structure to compute the value for
+      @return    Calibration register value, 0 for other device types */
+  uint64_t currentLSB;  // Hardware current LSB in nA
+  uint32_t maxShuntuV;  // Full scale shunt voltage of the INA228
+  uint8_t  divisor;     // maxShuntuV per SHUNT_CAL LSB of the INA228
+  switch (device.type) {
+    case INA219:
+      currentLSB = (uint64_t)device.current_LSB << (device.autoRange ? device.shuntRange : 0);
+      return ((uint64_t)409600000 / (currentLSB * (uint64_t)device.microOhmR / (uint64_t)100000));
+    case INA228:
+      maxShuntuV = (uint32_t)device.maxBusAmps * device.microOhmR;  // Full scale shunt microvolts
+      divisor    = device.shuntRange ? 40 : 10;
+      maxShuntuV = (maxShuntuV + divisor / 2) / divisor;  // Rounded to the nearest LSB
+      return (maxShuntuV > INA228_SHUNT_CAL_MAX ? INA228_SHUNT_CAL_MAX : maxShuntuV);
+    default: return 0;
+  }  // of switch type
+}  // of method rangeCalibration()
+void INA_Class::writeRange(const inaDet &device) const {
+  /*! @brief     Programs the shunt range of an INA219 or INA228 and its calibration
+      @details   The calibration is written first, so that the conversion which the INA219 starts
+                 when its configuration register is written uses both new values
+      @param[in] device Device structure with the range to program */
+  uint16_t configRegister = readConfigRegister(device.address, device.bus);
+  if (device.type == INA219) {
+    writeWord(INA_CALIBRATION_REGISTER, rangeCalibration(device), device.address, device.bus);
+    configRegister &= INA219_CONFIG_PG_MASK;                       // Zero programmable gain
+    configRegister |= device.shuntRange << INA219_PG_FIRST_BIT;  // Overwrite the new values
+  } else {
+    writeWord(INA228_SHUNT_CAL_REGISTER, rangeCalibration(device), device.address, device.bus);
+    configRegister &= ~INA228_CONFIG_RSTACC;  // Leave the accumulators alone
+    bitClear(configRegister, INA228_CONFIG_ADCRANGE_BIT);
+    if (device.shuntRange == 0) bitSet(configRegister, INA228_CONFIG_ADCRANGE_BIT);  // +-40.96mV
+  }  // of if-then-else an INA219
+  writeWord(INA_CONFIGURATION_REGISTER, configRegister, device.address, device.bus);
+}  // of method writeRange()
+bool INA_Class::setAutoRange(const bool enabled, const uint8_t deviceNumber) {
+  /*! @brief     Turns automatic selection of the INA219 programmable gain or the INA228 ADCRANGE
+                 on or off
+      @details   Without it the range is chosen once from maxBusAmps and the shunt resistance, so
+                 light loads only use a fraction of the ADC's resolution. With it every reading
+                 checks the shunt voltage: at 7/8 of the range's full scale the next larger range
+                 is selected at once, and after INA_RANGE_SAMPLES consecutive readings below half
+                 of the next smaller range's full scale the smallest range in which the largest of
+                 them fits that way is selected. The INA219 current LSB then follows the range, so
+                 the current register keeps its full resolution. The reading causing a switch up,
+                 which may be clipped, and readings which may contain a conversion of the old range
+                 have their "rangeSwitch" flag set, the values of all other readings are converted
+                 correctly whichever range they were taken in, also when they pass through an
+                 INA_SampleRing. Turning it off restores the fixed range. Devices of other types are
+                 skipped
+      @param[in] enabled "true" to switch the range automatically
+      @param[in] deviceNumber [optional] Device to change, all devices when not specified
+      @return    "true" on success, "false" if a device is of another type or there was
+                 insufficient memory for the device table, see begin() */
+  bool returnCode = true;                 // assume success
+  if (_DeviceTable == nullptr) return false;  // The ranges are only kept in the table
+  if (enabled && _range == nullptr && _DeviceCount != 0) _range = new inaRangeState[_DeviceCount]();
+  for (uint8_t i = 0; i < _DeviceCount; i++) {
+    if (deviceNumber != UINT8_MAX && deviceNumber != i) continue;  // Other device
+    inaDet &device = _DeviceTable[i];
+    if ((device.type != INA219 && device.type != INA228) || device.microOhmR == 0) {
+      returnCode = false;
+      continue;
+    }  // of if-then no ranges
+    INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+    inaEEPROM stored = device;  // Recompute the fixed range and LSB values from the settings
+    device           = stored;
+    if (enabled && _range != nullptr) {
+      device.autoRange = 1;
+      if (device.type == INA219) {  // LSBs of the 40mV range, the others are multiples of them
+        device.current_LSB = (uint64_t)40000 * 1000000000 / 32767 / device.microOhmR;
+        device.power_LSB   = (uint32_t)20 * device.current_LSB;
+        computeScales(device);
+      }  // of if-then an INA219
+      _range[i] = inaRangeState();
+    }  // of if-then enabled
+    writeRange(device);
+  }                          // of for-next each device
+  _currentINA = UINT8_MAX;  // "ina" may hold the old values
+  return (returnCode);
+}  // of method setAutoRange()
+uint8_t INA_Class::getShuntRange(const uint8_t deviceNumber) const {
+  /*! @brief     Returns the shunt range a device is using, see setAutoRange()
+      @param[in] deviceNumber [optional] Device to return the range of
+      @return    0-3 for the INA219 40, 80, 160 and 320mV ranges, 0-1 for the INA228 40.96 and
+                 163.84mV ranges and 0 for other devices */
+  if (deviceNumber >= _DeviceCount) return 0;  // Skip invalid devices
+  return (entry(deviceNumber).shuntRange);
+}  // of method getShuntRange()
+void INA_Class::checkRange(const uint8_t deviceNumber, inaRawSample &sample) {
+  /*! @brief     Switches a device's shunt range when a reading calls for it, see setAutoRange()
+      @details   The INA219 restarts its conversion when the range is written, so readings are
+                 flagged until one conversion time has passed. The INA228 finishes the conversion
+                 in progress, so readings are flagged for 2 conversion times, computed from its
+                 ADC_CONFIG register. At least the first reading after a switch is flagged. A switch
+                 down goes to the smallest range which would have fit the largest of the
+                 INA_RANGE_SAMPLES readings, so one quiet reading after louder ones can't make
+                 the next reading clip
+      @param[in] deviceNumber Device the reading is from
+      @param[in,out] sample Reading, in units of the smallest range */
+  inaDet        &device = _DeviceTable[deviceNumber];
+  inaRangeState &state  = _range[deviceNumber];
+  if (!device.autoRange) return;  // Fixed range
+  if (state.settling) {
+    sample.rangeSwitch = true;  // Registers may hold a conversion in the old range
+    if (sample.micros - state.switchMicros < state.settleMicros) return;
+    state.settling = false;  // First reading after the settling time
+    return;
+  }  // of if-then settling
+  uint8_t  step      = device.type == INA228 ? 2 : 1;  // Ranges are 4 or 2 times apart
+  uint8_t  maxRange  = device.type == INA228 ? 1 : 3;
+  uint32_t fullScale = (device.type == INA228 ? (uint32_t)524288 : (uint32_t)4000)
+                       << step * device.shuntRange;  // 2^19 * 78.125nV or 4000 * 10uV
+  uint32_t level     = sample.shuntRaw < 0 ? -sample.shuntRaw : sample.shuntRaw;
+  uint8_t  range     = device.shuntRange;
+  if (range < maxRange && level >= fullScale - fullScale / 8) {
+    range++;                    // Close to clipping, switch up at once
+    sample.rangeSwitch = true;  // The reading may be clipped
+  } else if (range > 0 && level < (fullScale >> step) / 2) {
+    if (level > state.peakLevel) state.peakLevel = level;  // Largest reading of the window
+    if (++state.quietSamples >= INA_RANGE_SAMPLES) {        // Fits a smaller range for long enough
+      while (range > 0 &&
+             state.peakLevel < (fullScale >> step * (device.shuntRange - range + 1)) / 2)
+        range--;
+    }  // of if-then switch down
+  } else {
+    state.quietSamples = 0;
+    state.peakLevel    = 0;
+  }  // of if-then-else switch up or down
+  if (range == device.shuntRange) return;  // No switch
+  device.shuntRange  = range;
+  writeRange(device);
+  state.quietSamples = 0;
+  state.peakLevel    = 0;
+  state.switchMicros = micros();
+  state.settling     = true;
+  state.settleMicros = conversionMicros(device);
+  if (device.type == INA228) state.settleMicros *= 2;      // Also the conversion in progress
+  if (_currentINA == deviceNumber) _currentINA = UINT8_MAX;  // "ina" holds the old range
+}  // of method checkRange()
 void INA_Class::setBusConversion(const uint32_t convTime, const uint8_t deviceNumber) {
   /*! @brief     specifies the conversion rate in microseconds, rounded to the nearest valid value
       @details   INA devices can have a conversion rate of up to 68100 microseconds
@@ -389,77 +1598,17 @@ void INA_Class::setBusConversion(const uint32_t convTime, const uint8_t deviceNu
                  changed, otherwise all devices are set to the same averaging rate
   */
   uint16_t configRegister;
-  int16_t  convRate;
   for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
   {
     if (deviceNumber == UINT8_MAX || deviceNumber % _DeviceCount == i)  // If device needs setting
     {
-      readInafromEEPROM(i);  // Load EEPROM values to ina structure
-      configRegister = readWord(INA_CONFIGURATION_REGISTER, ina.address);  // Get current register
-      switch (ina.type) {
-        case INA219:
-          if (convTime >= 68100)
-            convRate = 15;
-          else if (convTime >= 34050)
-            convRate = 14;
-          else if (convTime >= 17020)
-            convRate = 13;
-          else if (convTime >= 8510)
-            convRate = 12;
-          else if (convTime >= 4260)
-            convRate = 11;
-          else if (convTime >= 2130)
-            convRate = 10;
-          else if (convTime >= 1060)
-            convRate = 9;
-          else if (convTime >= 532)
-            convRate = 8;
-          else if (convTime >= 276)
-            convRate = 2;
-          else if (convTime >= 148)
-            convRate = 1;
-          else
-            convRate = 0;
-          configRegister &= ~INA219_CONFIG_BADC_MASK;  // zero out the averages part
-          configRegister |= convRate << 7;             // shift in the BADC averages
-          break;
-        case INA226:
-        case INA230:
-        case INA231:
-        case INA3221_0:
-        case INA3221_1:
-        case INA3221_2:
-        case INA260:
-          if (convTime >= 8244)
-            convRate = 7;
-          else if (convTime >= 4156)
-            convRate = 6;
-          else if (convTime >= 2116)
-            convRate = 5;
-          else if (convTime >= 1100)
-            convRate = 4;
-          else if (convTime >= 588)
-            convRate = 3;
-          else if (convTime >= 332)
-            convRate = 2;
-          else if (convTime >= 204)
-            convRate = 1;
-          else
-            convRate = 0;
-          if (ina.type == INA226 || ina.type == INA3221_0 || ina.type == INA3221_1 ||
-              ina.type == INA3221_2) {
-            configRegister &= ~INA226_CONFIG_BADC_MASK;  // zero out the averages part
-            configRegister |= convRate << 6;             // shift in averages
-          } else {
-            configRegister &= ~INA260_CONFIG_BADC_MASK;  // zero out the averages part
-            configRegister |= convRate << 7;             // shift in the averages
-          }                                              // of if-then an INA226 or INA260
-          break;
-      }  // of switch type
-      writeWord(INA_CONFIGURATION_REGISTER, configRegister,
-                ina.address);  // Save new value to device
-    }                          // of if this device needs to be set
-  }                            // for-next each device loop
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);  // Load device values to ina structure
+      configRegister = readSettings(ina);  // Get current register
+      configRegister = applyBusConversion(ina.type, configRegister, convTime);  // New value
+      writeSettings(ina, configRegister);  // Save new value
+    }  // of if this device needs to be set
+  }    // for-next each device loop
 }  // of method setBusConversion()
 void INA_Class::setShuntConversion(const uint32_t convTime, const uint8_t deviceNumber) {
   /*! @brief     specifies the conversion rate in microseconds, rounded to the nearest valid value
@@ -470,84 +1619,294 @@ void INA_Class::setShuntConversion(const uint32_t convTime, const uint8_t device
                  specified device number gets changed, otherwise all devices are set to the same
                  averaging rate
                  */
-  int16_t configRegister, convRate;
+  uint16_t configRegister;
   for (uint8_t i = 0; i < _DeviceCount; i++) {  // Loop for each device found
     if (deviceNumber == UINT8_MAX ||
         deviceNumber % _DeviceCount == i)  // If this device needs setting
     {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      configRegister = readWord(INA_CONFIGURATION_REGISTER, ina.address);  // Get register contents
-      switch (ina.type) {
-        case INA219:
-          if (convTime >= 68100)
-            convRate = 15;
-          else if (convTime >= 34050)
-            convRate = 14;
-          else if (convTime >= 17020)
-            convRate = 13;
-          else if (convTime >= 8510)
-            convRate = 12;
-          else if (convTime >= 4260)
-            convRate = 11;
-          else if (convTime >= 2130)
-            convRate = 10;
-          else if (convTime >= 1060)
-            convRate = 9;
-          else if (convTime >= 532)
-            convRate = 8;
-          else if (convTime >= 276)
-            convRate = 2;
-          else if (convTime >= 148)
-            convRate = 1;
-          else
-            convRate = 0;
-          configRegister &= ~INA219_CONFIG_SADC_MASK;  // zero out the averages part
-          configRegister |= convRate << 3;             // shift in the SADC averages
-          break;
-        case INA226:
-        case INA230:
-        case INA231:
-        case INA3221_0:
-        case INA3221_1:
-        case INA3221_2:
-        case INA260:
-          if (convTime >= 8244)
-            convRate = 7;
-          else if (convTime >= 4156)
-            convRate = 6;
-          else if (convTime >= 2116)
-            convRate = 5;
-          else if (convTime >= 1100)
-            convRate = 4;
-          else if (convTime >= 588)
-            convRate = 3;
-          else if (convTime >= 332)
-            convRate = 2;
-          else if (convTime >= 204)
-            convRate = 1;
-          else
-            convRate = 0;
-          if (ina.type == INA226 || ina.type == INA3221_0 || ina.type == INA3221_1 ||
-              ina.type == INA3221_2) {
-            configRegister &= ~INA226_CONFIG_SADC_MASK;  // zero out the averages part
-          } else {
-            configRegister &= ~INA260_CONFIG_SADC_MASK;  // zero out the averages part
-          }                                 // of if-then-else either INA226/INA3221 or a INA260
-          configRegister |= convRate << 3;  // shift in the averages to register
-          break;
-      }  // of switch type
-      writeWord(INA_CONFIGURATION_REGISTER, configRegister,
-                ina.address);  // Save new value to device
-    }                          // of if this device needs to be set
-  }                            // for-next each device loop
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);  // Load device to ina structure
+      configRegister = readSettings(ina);  // Get current register
+      configRegister = applyShuntConversion(ina.type, configRegister, convTime);  // New value
+      writeSettings(ina, configRegister);  // Save new value
+    }  // of if this device needs to be set
+  }    // for-next each device loop
 }  // of method setShuntConversion()
+uint16_t INA_Class::applyMode(const uint8_t type, uint16_t configRegister,
+                              const uint8_t mode) const {
+  /*! @brief     Sets the operating mode bits of a settings register value, see readSettings()
+      @details   Only computes the new value, the register itself is not read or written. The
+                 INA228 has separate bus, shunt, temperature and continuous bits in ADC_CONFIG, the
+                 die temperature is converted along with the bus or shunt voltage
+      @param[in] type Device type, see "ina_Type"
+      @param[in] configRegister Current register value
+      @param[in] mode Mode, see "ina_Mode"
+      @return    New register value */
+  if (type == INA228) {
+    configRegister &= ~INA228_CONFIG_MODE_MASK;  // zero out mode bits
+    if (mode & 1) configRegister |= 0x2000;      // Shunt voltage
+    if (mode & 2) configRegister |= 0x1000;      // Bus voltage
+    if (mode & 3) configRegister |= 0x4000;      // Die temperature
+    if (mode & 4) configRegister |= 0x8000;      // Continuous
+  } else {
+    configRegister &= ~INA_CONFIG_MODE_MASK;  // zero out mode bits
+    configRegister |= mode;
+  }  // of if-then-else an INA228
+  return (configRegister);
+}  // of method applyMode()
+uint16_t INA_Class::applyBusConversion(const uint8_t type, uint16_t configRegister,
+                                       const uint32_t convTime) const {
+  /*! @brief     Sets the bus conversion time bits of a configuration register value
+      @details   Only computes the new value, the register itself is not read or written. Device
+                 types without this setting return the value unchanged
+      @param[in] type Device type, see "ina_Type"
+      @param[in] configRegister Current configuration register value
+      @param[in] convTime The conversion time in microseconds, invalid values are rounded to the
+                 nearest valid value
+      @return    New configuration register value */
+  int16_t convRate;
+  switch (type) {
+    case INA219:
+      if (convTime >= 68100)
+        convRate = 15;
+      else if (convTime >= 34050)
+        convRate = 14;
+      else if (convTime >= 17020)
+        convRate = 13;
+      else if (convTime >= 8510)
+        convRate = 12;
+      else if (convTime >= 4260)
+        convRate = 11;
+      else if (convTime >= 2130)
+        convRate = 10;
+      else if (convTime >= 1060)
+        convRate = 9;
+      else if (convTime >= 532)
+        convRate = 8;
+      else if (convTime >= 276)
+        convRate = 2;
+      else if (convTime >= 148)
+        convRate = 1;
+      else
+        convRate = 0;
+      configRegister &= ~INA219_CONFIG_BADC_MASK;  // zero out the averages part
+      configRegister |= convRate << 7;             // shift in the BADC averages
+      break;
+    case INA228:
+      if (convTime >= 4120)
+        convRate = 7;
+      else if (convTime >= 2074)
+        convRate = 6;
+      else if (convTime >= 1052)
+        convRate = 5;
+      else if (convTime >= 540)
+        convRate = 4;
+      else if (convTime >= 280)
+        convRate = 3;
+      else if (convTime >= 150)
+        convRate = 2;
+      else if (convTime >= 84)
+        convRate = 1;
+      else
+        convRate = 0;
+      configRegister &= ~INA228_CONFIG_BADC_MASK;  // ADC_CONFIG bits 9-11
+      configRegister |= convRate << 9;             // shift in conversion time
+      break;
+    case INA226:
+    case INA230:
+    case INA231:
+    case INA3221_0:
+    case INA3221_1:
+    case INA3221_2:
+    case INA260:
+      if (convTime >= 8244)
+        convRate = 7;
+      else if (convTime >= 4156)
+        convRate = 6;
+      else if (convTime >= 2116)
+        convRate = 5;
+      else if (convTime >= 1100)
+        convRate = 4;
+      else if (convTime >= 588)
+        convRate = 3;
+      else if (convTime >= 332)
+        convRate = 2;
+      else if (convTime >= 204)
+        convRate = 1;
+      else
+        convRate = 0;
+      configRegister &= ~INA226_CONFIG_BADC_MASK;  // zero out the bits 6-8, same on all types
+      configRegister |= convRate << 6;             // shift in conversion time
+      break;
+  }  // of switch type
+  return (configRegister);
+}  // of method applyBusConversion()
+uint16_t INA_Class::applyShuntConversion(const uint8_t type, uint16_t configRegister,
+                                         const uint32_t convTime) const {
+  /*! @brief     Sets the shunt conversion time bits of a configuration register value
+      @details   Only computes the new value, the register itself is not read or written. Device
+                 types without this setting return the value unchanged
+      @param[in] type Device type, see "ina_Type"
+      @param[in] configRegister Current configuration register value
+      @param[in] convTime Conversion time in microseconds. Out-of-Range values are set to the
+                 closest valid value
+      @return    New configuration register value */
+  int16_t convRate;
+  switch (type) {
+    case INA219:
+      if (convTime >= 68100)
+        convRate = 15;
+      else if (convTime >= 34050)
+        convRate = 14;
+      else if (convTime >= 17020)
+        convRate = 13;
+      else if (convTime >= 8510)
+        convRate = 12;
+      else if (convTime >= 4260)
+        convRate = 11;
+      else if (convTime >= 2130)
+        convRate = 10;
+      else if (convTime >= 1060)
+        convRate = 9;
+      else if (convTime >= 532)
+        convRate = 8;
+      else if (convTime >= 276)
+        convRate = 2;
+      else if (convTime >= 148)
+        convRate = 1;
+      else
+        convRate = 0;
+      configRegister &= ~INA219_CONFIG_SADC_MASK;  // zero out the averages part
+      configRegister |= convRate << 3;             // shift in the SADC averages
+      break;
+    case INA228:
+      if (convTime >= 4120)
+        convRate = 7;
+      else if (convTime >= 2074)
+        convRate = 6;
+      else if (convTime >= 1052)
+        convRate = 5;
+      else if (convTime >= 540)
+        convRate = 4;
+      else if (convTime >= 280)
+        convRate = 3;
+      else if (convTime >= 150)
+        convRate = 2;
+      else if (convTime >= 84)
+        convRate = 1;
+      else
+        convRate = 0;
+      configRegister &= ~INA228_CONFIG_SADC_MASK;  // ADC_CONFIG bits 6-8
+      configRegister |= convRate << 6;             // shift in conversion time
+      break;
+    case INA226:
+    case INA230:
+    case INA231:
+    case INA3221_0:
+    case INA3221_1:
+    case INA3221_2:
+    case INA260:
+      if (convTime >= 8244)
+        convRate = 7;
+      else if (convTime >= 4156)
+        convRate = 6;
+      else if (convTime >= 2116)
+        convRate = 5;
+      else if (convTime >= 1100)
+        convRate = 4;
+      else if (convTime >= 588)
+        convRate = 3;
+      else if (convTime >= 332)
+        convRate = 2;
+      else if (convTime >= 204)
+        convRate = 1;
+      else
+        convRate = 0;
+      if (type == INA226 || type == INA3221_0 || type == INA3221_1 || type == INA3221_2) {
+        configRegister &= ~INA226_CONFIG_SADC_MASK;  // zero out the averages part
+      } else {
+        configRegister &= ~INA260_CONFIG_SADC_MASK;  // zero out the averages part
+      }                                 // of if-then-else either INA226/INA3221 or a INA260
+      configRegister |= convRate << 3;  // shift in the averages to register
+      break;
+  }  // of switch type
+  return (configRegister);
+}  // of method applyShuntConversion()
+uint16_t INA_Class::applyAveraging(const uint8_t type, uint16_t configRegister,
+                                   const uint16_t averages) const {
+  /*! @brief     Sets the averaging bits of a configuration register value
+      @details   Only computes the new value, the register itself is not read or written. Device
+                 types without this setting return the value unchanged
+      @param[in] type Device type, see "ina_Type"
+      @param[in] configRegister Current configuration register value
+      @param[in] averages Number of averages, out-of-range values are brought down to the highest
+                 allowed value
+      @return    New configuration register value */
+  uint16_t averageIndex;
+  switch (type) {
+    case INA219:
+      if (averages >= 128)
+        averageIndex = 15;
+      else if (averages >= 64)
+        averageIndex = 14;
+      else if (averages >= 32)
+        averageIndex = 13;
+      else if (averages >= 16)
+        averageIndex = 12;
+      else if (averages >= 8)
+        averageIndex = 11;
+      else if (averages >= 4)
+        averageIndex = 10;
+      else if (averages >= 2)
+        averageIndex = 9;
+      else
+        averageIndex = 8;
+      configRegister &= ~INA219_CONFIG_AVG_MASK;  // zero out the averages part
+      configRegister |= averageIndex << 3;        // shift in the SADC averages
+      configRegister |= averageIndex << 7;        // shift in the BADC averages
+      break;
+    case INA226:
+    case INA228:
+    case INA230:
+    case INA231:
+    case INA3221_0:
+    case INA3221_1:
+    case INA3221_2:
+    case INA260:
+      if (averages >= 1024)
+        averageIndex = 7;
+      else if (averages >= 512)
+        averageIndex = 6;
+      else if (averages >= 256)
+        averageIndex = 5;
+      else if (averages >= 128)
+        averageIndex = 4;
+      else if (averages >= 64)
+        averageIndex = 3;
+      else if (averages >= 16)
+        averageIndex = 2;
+      else if (averages >= 4)
+        averageIndex = 1;
+      else
+        averageIndex = 0;
+      if (type == INA228) {
+        configRegister &= ~INA228_CONFIG_AVG_MASK;  // ADC_CONFIG bits 0-2, same index values
+        configRegister |= averageIndex;
+      } else {
+        configRegister &= ~INA226_CONFIG_AVG_MASK;  // zero out the averages part
+        configRegister |= averageIndex << 9;        // shift in the averages to reg
+      }  // of if-then-else an INA228
+      break;
+  }  // of switch type
+  return (configRegister);
+}  // of method applyAveraging()
 const char *INA_Class::getDeviceName(const uint8_t deviceNumber) {
   /*! @brief     returns character buffer with the name of the device specified in the input param
       @details   See function definition for list of possible return values
       @param[in] deviceNumber to return the device name of
       @return    device name */
   if (deviceNumber > _DeviceCount) return ("");
-  readInafromEEPROM(deviceNumber);  // Load EEPROM to ina structure
+  selectDevice(deviceNumber);  // Load device to ina structure
   switch (ina.type) {
     case INA219: return ("INA219");
     case INA226: return ("INA226");
@@ -568,7 +1927,7 @@ uint8_t INA_Class::getDeviceAddress(const uint8_t deviceNumber) {
       @return    I2C address of the device. Returns 0 if value is out-of-range
       */
   if (deviceNumber > _DeviceCount) return 0;
-  readInafromEEPROM(deviceNumber);  // Load EEPROM to ina structure
+  selectDevice(deviceNumber);  // Load device to ina structure
   return (ina.address);
 }  // of method getDeviceAddress()
 uint16_t INA_Class::getBusMilliVolts(const uint8_t deviceNumber) {
@@ -577,13 +1936,9 @@ uint16_t INA_Class::getBusMilliVolts(const uint8_t deviceNumber) {
                  the next conversion is started
       @param[in] deviceNumber to return the device bus millivolts for
       @return uint16_t unsigned integer for the bus millivoltage */
+  INA_STATS_TIMER(deviceNumber, INA_STATS_READ);
   uint32_t busVoltage = getBusRaw(deviceNumber);  // Get raw voltage from device
-  if (ina.type == INA228) {
-    // The accuracy is 20bits and 195.3125uv is the LSB
-    busVoltage = (uint64_t)busVoltage * 1953125 / 10000000;  // conversion to get mV
-  } else {
-    busVoltage = busVoltage * ina.busVoltage_LSB / 100;  // conversion to get mV
-  }                                                      // if-then-else an INA228
+  busVoltage = (busVoltage * ina.busVoltageMult) >> ina.busVoltageShift;  // conversion to get mV
   return (busVoltage);
 }  // of method getBusMilliVolts()
 uint32_t INA_Class::getBusRaw(const uint8_t deviceNumber) {
@@ -592,26 +1947,34 @@ uint32_t INA_Class::getBusRaw(const uint8_t deviceNumber) {
                  conversion is started
       @param[in] deviceNumber to return the raw device bus voltage reading
       @return    Raw bus measurement */
-  readInafromEEPROM(deviceNumber);  // Load EEPROM from EEPROM
-  uint32_t raw{0};                  // define the return variable
-  if (ina.type == INA228) {
-    raw = read3Bytes(ina.busVoltageRegister, ina.address);  // Get the raw value from register
+  INA_STATS_TIMER(deviceNumber, INA_STATS_READ);
+  selectDevice(deviceNumber);             // Load device to ina structure
+  uint32_t raw = readBusRegister(ina);    // Get the raw value from register
+  if (!bitRead(ina.operatingMode, 2) && bitRead(ina.operatingMode, 1))  // Triggered & bus active
+  {
+    triggerConversion(ina);  // Write to trigger next
+  }                          // of if-then triggered mode enabled
+  return (raw);
+}  // of method getBusRaw()
+uint32_t INA_Class::readBusRegister(const inaDet &device) const {
+  /*! @brief     Reads the bus voltage register of a device and aligns the raw value
+      @details   INA219 and INA3221 don't use the 3 LSB and the INA228 returns a 20-bit value in a
+                 24-bit register, these are shifted so that the result is the raw reading
+      @param[in] device Device structure to read
+      @return    Raw bus measurement */
+  uint32_t raw{0};  // define the return variable
+  if (device.type == INA228) {
+    raw = read3Bytes(device.busVoltageRegister, device.address, device.bus);  // Get the raw value from register
     raw = raw >> 4;
   } else {
-    raw = readWord(ina.busVoltageRegister, ina.address);  // Get the raw value from register
-    if (ina.type == INA3221_0 || ina.type == INA3221_1 || ina.type == INA3221_2 ||
-        ina.type == INA219) {
+    raw = (uint16_t)readWord(device.busVoltageRegister, device.address, device.bus);  // Get unsigned raw value
+    if (device.type == INA3221_0 || device.type == INA3221_1 || device.type == INA3221_2 ||
+        device.type == INA219) {
       raw = raw >> 3;  // INA219 & INA3221 - the 3 LSB unused, so shift right
     }                  // of if-then an INA219 or INA3221
   }                    // if-then a 3byte bus voltage buffer
-  if (!bitRead(ina.operatingMode, 2) && bitRead(ina.operatingMode, 1))  // Triggered & bus active
-  {
-    int16_t configRegister =
-        readWord(INA_CONFIGURATION_REGISTER, ina.address);               // Get current value
-    writeWord(INA_CONFIGURATION_REGISTER, configRegister, ina.address);  // Write to trigger next
-  }  // of if-then triggered mode enabled
   return (raw);
-}  // of method getBusRaw()
+}  // of method readBusRegister()
 int32_t INA_Class::getShuntMicroVolts(const uint8_t deviceNumber) {
   /*! @brief     returns the shunt reading converted to microvolts
       @details   The computed microvolts value is returned and if the device is in triggered mode
@@ -619,75 +1982,123 @@ int32_t INA_Class::getShuntMicroVolts(const uint8_t deviceNumber) {
       @param[in] deviceNumber to return the value for
       @return    int32_t signed integer for the shunt microvolts
       */
+  INA_STATS_TIMER(deviceNumber, INA_STATS_READ);
   int32_t shuntVoltage = getShuntRaw(deviceNumber);
   if (ina.type == INA260)  // INA260 has a built-in shunt
   {
     int32_t busMicroAmps = getBusMicroAmps(deviceNumber);  // Get the amps on the bus from device
     shuntVoltage         = busMicroAmps / 200;             // 2mOhm resistor, convert with Ohm's law
   } else {
-    if (ina.type == INA228) {
-      shuntVoltage = shuntVoltage * ina.shuntVoltage_LSB / 10;  // Convert to microvolts
-    } else {
-      shuntVoltage = shuntVoltage * ina.shuntVoltage_LSB / 10;  // Convert to microvolts
-    }  // if-then a INA228 with 20 bit accuracy
-  }    // of if-then-else an INA260
+    shuntVoltage = scaleValue(shuntVoltage, ina.shuntVoltageMult, ina.shuntVoltageShift);  // uV
+  }  // of if-then-else an INA260
   return (shuntVoltage);
 }  // of method getShuntMicroVolts()
 int32_t INA_Class::getShuntRaw(const uint8_t deviceNumber) {
   /*! @brief     Returns the raw shunt reading
       @details   The raw reading is returned and if the device is in triggered mode the next
-                 conversion is started
+                 conversion is started. The INA228 value is always in units of 78.125nV, the LSB of
+                 its +-40.96mV range, so in the +-163.84mV range it is 4 times the register value,
+                 also while setAutoRange() switches between the ranges
       @param[in] deviceNumber to return the value for
       @return    Raw shunt reading */
+  INA_STATS_TIMER(deviceNumber, INA_STATS_READ);
   int32_t raw;
-  readInafromEEPROM(deviceNumber);  // Load EEPROM to ina structure
-  if (ina.type == INA260)           // INA260 has a built-in shunt
+  selectDevice(deviceNumber);  // Load device to ina structure
+  if (ina.type == INA260)      // INA260 has a built-in shunt
   {
     int32_t busMicroAmps = getBusMicroAmps(deviceNumber);  // Get the amps on the bus
     raw                  = busMicroAmps / 200 / 1000;      // 2mOhm resistor, apply Ohm's law
   } else {
-    if (ina.type == INA228)  // INA228 has 24 bit accuracy
-    {
-      raw = read3Bytes(ina.shuntVoltageRegister, ina.address);  // Get the raw value from register
-      // The number is two's complement, so if negative we need to pad when shifting //
-      if (raw & 0x800000) {
-        raw = (raw >> 4) | 0xFFF00000;  // first 12 bits are "1"
-      } else {
-        raw = raw >> 4;
-      }  // if-then negative
-    } else {
-      raw = readWord(ina.shuntVoltageRegister, ina.address);  // Get the raw value from register
-    }                                                         // if-then a 24 bit register
-    if (ina.type == INA3221_0 || ina.type == INA3221_1 ||
-        ina.type == INA3221_2)  // Doesn't use 3 LSB
-    {
-      raw = raw >> 3;  // shift over 3 bits, datatype is "int" so shifts in sign bits
-    }                  // of if-then we need to shift INA3221 reading over
-  }                    // of if-then-else an INA260 with inbuilt shunt
+    raw = readShuntRegister(ina);  // Get the raw value from register
+  }                                // of if-then-else an INA260 with inbuilt shunt
   if (!bitRead(ina.operatingMode, 2) && bitRead(ina.operatingMode, 0))  // Triggered & shunt active
   {
-    int16_t configRegister = readWord(INA_CONFIGURATION_REGISTER, ina.address);  // Get current reg
-    writeWord(INA_CONFIGURATION_REGISTER, configRegister, ina.address);  // Write to trigger next
-  }  // of if-then triggered mode enabled
+    triggerConversion(ina);  // Write to trigger next
+  }                          // of if-then triggered mode enabled
   return (raw);
 }  // of method getShuntMicroVolts()
+int32_t INA_Class::readShuntRegister(const inaDet &device) const {
+  /*! @brief     Reads the shunt voltage register of a device and aligns the raw value
+      @details   The INA260 has no shunt voltage register and must not be passed to this method.
+                 The sign is preserved when shifting out the unused bits of INA228 and INA3221. The
+                 INA228 value is in units of the +-40.96mV range's LSB in both ranges
+      @param[in] device Device structure to read
+      @return    Raw shunt reading */
+  int32_t raw;
+  if (device.type == INA228)  // INA228 has 24 bit accuracy
+  {
+    raw = read3Bytes(device.shuntVoltageRegister, device.address, device.bus);  // Get the raw value
+    // The number is two's complement, so if negative we need to pad when shifting //
+    if (raw & 0x800000) {
+      raw = (raw >> 4) | 0xFFF00000;  // first 12 bits are "1"
+    } else {
+      raw = raw >> 4;
+    }                                         // if-then negative
+    raw *= (int32_t)1 << 2 * device.shuntRange;  // 312.5nV LSB to the 78.125nV of ADCRANGE
+  } else {
+    raw = readWord(device.shuntVoltageRegister, device.address, device.bus);  // Get the raw value
+  }                                                               // if-then a 24 bit register
+  if (device.type == INA3221_0 || device.type == INA3221_1 ||
+      device.type == INA3221_2)  // Doesn't use 3 LSB
+  {
+    raw = raw >> 3;  // shift over 3 bits, datatype is "int" so shifts in sign bits
+  }                  // of if-then we need to shift INA3221 reading over
+  return (raw);
+}  // of method readShuntRegister()
+int32_t INA_Class::readCurrentRegister(const inaDet &device) const {
+  /*! @brief     Reads the current register of a device and aligns the raw value
+      @details   The INA228 has a 20-bit two's complement value in the upper bits of a 24-bit
+                 register, the other devices a 16-bit one. The INA3221 has no current register and
+                 must not be passed to this method. With automatic ranging the INA219 value is in
+                 units of the smallest range's LSB, see setAutoRange()
+      @param[in] device Device structure to read
+      @return    Raw current reading, sign extended */
+  if (device.type == INA228) {
+    return ((int32_t)((uint32_t)read3Bytes(device.currentRegister, device.address, device.bus) << 8) >>
+            12);  // Shift the sign bit to the top and back down to sign extend
+  }               // of if-then a 24 bit register
+  int32_t raw = readWord(device.currentRegister, device.address, device.bus);
+  if (device.autoRange) raw *= (int32_t)1 << device.shuntRange;  // LSB doubles with each range
+  return (raw);
+}  // of method readCurrentRegister()
+uint32_t INA_Class::readPowerRegister(const inaDet &device) const {
+  /*! @brief     Reads the unsigned power register of a device
+      @details   24 bits on the INA228 and 16 bits on the other devices. The INA3221 has no power
+                 register and must not be passed to this method. With automatic ranging the INA219
+                 value is scaled like readCurrentRegister()
+      @param[in] device Device structure to read
+      @return    Raw power reading */
+  if (device.type == INA228) {
+    return (read3Bytes(INA228_POWER_REGISTER, device.address, device.bus));
+  }  // of if-then a 24 bit register
+  uint32_t raw = (uint16_t)readWord(INA_POWER_REGISTER, device.address, device.bus);
+  if (device.autoRange) raw <<= device.shuntRange;  // LSB doubles with each range
+  return (raw);
+}  // of method readPowerRegister()
+void INA_Class::triggerConversion(const inaDet &device) const {
+  /*! @brief     Starts the next conversion on a device in triggered mode
+      @details   Writing the configuration register, or ADC_CONFIG on the INA228, even with an
+                 unchanged value, triggers the next single-shot conversion
+      @param[in] device Device structure to trigger */
+  writeSettings(device, readSettings(device));  // Write to trigger next
+}  // of method triggerConversion()
 int32_t INA_Class::getBusMicroAmps(const uint8_t deviceNumber) {
   /*! @brief     Returns the computed microamps measured on the bus for the specified device
       @details   The computed reading is returned and if the device is in triggered mode the next
                  conversion is started
       @param[in] deviceNumber to return the value for
       @return    int32_t signed integer for computed microamps on the bus */
-  readInafromEEPROM(deviceNumber);  // Load EEPROM to ina structure
+  INA_STATS_TIMER(deviceNumber, INA_STATS_READ);
+  selectDevice(deviceNumber);  // Load device to ina structure
   int32_t microAmps = 0;
   if (ina.type == INA3221_0 || ina.type == INA3221_1 ||
       ina.type == INA3221_2)  // Doesn't compute Amps
   {
-    microAmps =
-        (int64_t)getShuntMicroVolts(deviceNumber) * ((int64_t)1000000 / (int64_t)ina.microOhmR);
+    microAmps = scaleValue(getShuntMicroVolts(deviceNumber), ina.currentMult, ina.currentShift);
   } else {
-    microAmps = (int64_t)readWord(ina.currentRegister, ina.address) * (int64_t)ina.current_LSB /
-                (int64_t)1000;
-  }  // of if-then-else an INA3221
+    microAmps = scaleValue(readCurrentRegister(ina), ina.currentMult,
+                           ina.currentShift);  // Convert using precomputed multiplier
+  }                                            // of if-then-else an INA3221
   return (microAmps);
 }  // of method getBusMicroAmps()
 int64_t INA_Class::getBusMicroWatts(const uint8_t deviceNumber) {
@@ -698,21 +2109,298 @@ int64_t INA_Class::getBusMicroWatts(const uint8_t deviceNumber) {
   @param[in] deviceNumber to return the value for
   @return    int64_t signed integer for computed microwatts on the bus
   */
+  INA_STATS_TIMER(deviceNumber, INA_STATS_READ);
   int64_t microWatts = 0;
-  readInafromEEPROM(deviceNumber);  // Load EEPROM to ina structure
+  selectDevice(deviceNumber);  // Load device to ina structure
   if (ina.type == INA3221_0 || ina.type == INA3221_1 ||
       ina.type == INA3221_2)  // Doesn't compute Amps
   {
-    microWatts =
-        ((int64_t)getShuntMicroVolts(deviceNumber) * (int64_t)1000000 / (int64_t)ina.microOhmR) *
-        (int64_t)getBusMilliVolts(deviceNumber) / (int64_t)1000;
+    microWatts = scaleValue(getShuntMicroVolts(deviceNumber), ina.powerMult, ina.powerShift) *
+                 (int64_t)getBusMilliVolts(deviceNumber) / (int64_t)1000;
   } else {
-    microWatts =
-        (int64_t)readWord(INA_POWER_REGISTER, ina.address) * (int64_t)ina.power_LSB / (int64_t)1000;
-    if (getShuntRaw(deviceNumber) < 0) microWatts *= -1;  // Invert if negative voltage
-  }                                                       // of if-then-else an INA3221
+    uint32_t powerRaw = readPowerRegister(ina);
+    int32_t  raw      = ina.type == INA228 || ina.autoRange ? (int32_t)powerRaw : (int16_t)powerRaw;
+    microWatts = scaleValue(raw, ina.powerMult, ina.powerShift);  // Convert using the multiplier
+    if (ina.type == INA260) {  // Its computed shunt reading truncates currents below 200mA to 0
+      if (readCurrentRegister(ina) < 0) microWatts *= -1;  // Invert if negative current
+      if (!bitRead(ina.operatingMode, 2) && bitRead(ina.operatingMode, 0)) triggerConversion(ina);
+    } else if (getShuntRaw(deviceNumber) < 0) {
+      microWatts *= -1;  // Invert if negative voltage
+    }                    // of if-then-else an INA260
+  }                      // of if-then-else an INA3221
   return (microWatts);
 }  // of method getBusMicroWatts()
+bool INA_Class::readMeasurement(inaMeasurement &measurement, const uint8_t deviceNumber) {
+  /*!
+  @brief     Reads bus voltage, shunt voltage, current and power of a device in one call
+  @details   Only the registers which the device type actually needs are read, and each of them just
+             once, so the 4 values come from the same conversion, see readDevice(). If the device
+             is in triggered mode the next conversion is started once, after all registers have been
+             read. The values are identical to those returned by the individual "getBus...()" and
+             "getShunt...()" methods
+  @param[out] measurement Structure which receives the values
+  @param[in] deviceNumber to return the values for
+  @return    "true" if the values were read, "false" for an invalid or offline device number
+  */
+  if (!isOnline(deviceNumber)) return false;  // Skip invalid and offline devices
+  INA_STATS_TIMER(deviceNumber, INA_STATS_MEASUREMENT);
+  const inaDet &device = entry(deviceNumber);  // Use the table entry directly
+  readDevice(deviceNumber, measurement);              // Read and convert all values
+  if (!bitRead(device.operatingMode, 2) && (device.operatingMode & 3))  // Triggered & active
+  {
+    triggerConversion(device);  // Write once to trigger next
+  }                             // of if-then triggered mode enabled
+  return true;
+}  // of method readMeasurement()
+bool INA_Class::readRawSample(inaRawSample &sample, const uint8_t deviceNumber) {
+  /*!
+  @brief     Reads the bus voltage, shunt voltage, current and power registers of a device
+  @details   The same registers as readMeasurement() are read, but the values are only stored, so
+             that the conversion can be left to convertSample() where time is less critical, e.g.
+             in another task after passing the sample through an INA_SampleRing. The INA260 has
+             no shunt register and the INA3221 no current or power registers, those values are 0.
+             If the device is in triggered mode the next conversion is started
+  @param[out] sample Structure which receives the register values, time and device number
+  @param[in] deviceNumber to return the values for
+  @return    "true" if the values were read, "false" for an invalid or offline device number
+  */
+  if (!isOnline(deviceNumber)) return false;  // Skip invalid and offline devices
+  INA_STATS_TIMER(deviceNumber, INA_STATS_MEASUREMENT);
+  const inaDet &device = entry(deviceNumber);  // Use the table entry directly
+  readRawDevice(deviceNumber, sample);
+  sample.deviceNumber = deviceNumber;
+  if (!bitRead(device.operatingMode, 2) && (device.operatingMode & 3))  // Triggered & active
+  {
+    triggerConversion(device);  // Write once to trigger next
+  }                             // of if-then triggered mode enabled
+  return true;
+}  // of method readRawSample()
+bool INA_Class::convertSample(const inaRawSample &sample, inaMeasurement &measurement) const {
+  /*!
+  @brief     Converts a sample read by readRawSample()
+  @details   No registers are read and the "ina" structure is left unchanged, so this can be called
+             from a different task than the one reading the devices. The values are identical to
+             those readMeasurement() returns for the same register values
+  @param[in] sample Register values and device number
+  @param[out] measurement Structure which receives the values
+  @return    "true" if the values were converted, "false" for an invalid device number
+  */
+  if (sample.deviceNumber >= _DeviceCount) return false;  // Skip invalid devices
+  convertRawDevice(sample.deviceNumber, sample, measurement);
+  return true;
+}  // of method convertSample()
+void INA_Class::readDevice(const uint8_t deviceNumber, inaMeasurement &measurement) {
+  /*!
+  @brief     Reads and converts bus voltage, shunt voltage, current and power of a device
+  @details   See readRawDevice() and convertRawDevice(). No conversion is triggered, that is left
+             to the caller
+  @param[in] deviceNumber Device to read, no range checking is done
+  @param[out] measurement Structure which receives the values
+  */
+  inaRawSample sample;  // Register values read
+  readRawDevice(deviceNumber, sample);
+  convertRawDevice(deviceNumber, sample, measurement);
+}  // of method readDevice()
+void INA_Class::readRawDevice(const uint8_t deviceNumber, inaRawSample &sample) {
+  /*!
+  @brief     Reads the bus voltage, shunt voltage, current and power registers of a device
+  @details   Only the registers which the device type has are read, each of them once. The INA260
+             has no shunt register and the INA3221 no current or power registers, those values are
+             set to 0. The device number is not set, that is left to the caller. No conversion is
+             triggered. The reading feeds the device's automatic ranging and accumulators
+  @param[in] deviceNumber Device to read, no range checking is done
+  @param[out] sample Structure which receives the register values
+  */
+  const inaDet &device = entry(deviceNumber);  // Use the table entry directly
+  sample.micros        = micros();
+  sample.busRaw        = readBusRegister(device);
+  sample.shuntRaw      = 0;
+  sample.currentRaw    = 0;
+  sample.powerRaw      = 0;
+  sample.dropped       = 0;
+  sample.rangeSwitch   = false;
+  switch (device.type) {
+    case INA3221_0:  // No current or power registers
+    case INA3221_1:
+    case INA3221_2: sample.shuntRaw = readShuntRegister(device); break;
+    case INA260:  // No shunt register
+      sample.currentRaw = readCurrentRegister(device);
+      sample.powerRaw   = readPowerRegister(device);
+      break;
+    default:
+      sample.shuntRaw   = readShuntRegister(device);
+      sample.currentRaw = readCurrentRegister(device);
+      sample.powerRaw   = readPowerRegister(device);
+  }  // of switch type
+  if (_range != nullptr) checkRange(deviceNumber, sample);  // Switch the range if called for
+  if (_energy != nullptr) accumulate(deviceNumber, sample);  // Feed the software accumulators
+}  // of method readRawDevice()
+void INA_Class::convertRawDevice(const uint8_t deviceNumber, const inaRawSample &sample,
+                                 inaMeasurement &measurement) const {
+  /*!
+  @brief     Converts the register values read by readRawDevice()
+  @details   The INA260 has no shunt register, so the shunt value is computed from the current, and
+             the INA3221 has no current or power registers, so those are computed from the shunt
+             and bus voltages. No registers are read
+  @param[in] deviceNumber Device the values were read from, no range checking is done
+  @param[in] sample Register values
+  @param[out] measurement Structure which receives the values
+  */
+  const inaDet &device = entry(deviceNumber);
+  int32_t       shuntRaw{0};  // Raw shunt value, used for the sign
+  measurement.busMilliVolts = (sample.busRaw * device.busVoltageMult) >> device.busVoltageShift;
+  switch (device.type) {
+    case INA260:  // No shunt register, compute from current
+      measurement.busMicroAmps =
+          scaleValue((int16_t)sample.currentRaw, device.currentMult, device.currentShift);
+      measurement.shuntMicroVolts = measurement.busMicroAmps / 200;  // 2mOhm resistor
+      shuntRaw                    = measurement.busMicroAmps;  // Power register has no sign
+      measurement.busMicroWatts =
+          scaleValue((int16_t)sample.powerRaw, device.powerMult, device.powerShift);
+      break;
+    case INA3221_0:  // No current or power registers, compute from the voltages
+    case INA3221_1:
+    case INA3221_2:
+      measurement.shuntMicroVolts =
+          scaleValue(sample.shuntRaw, device.shuntVoltageMult, device.shuntVoltageShift);
+      measurement.busMicroAmps =
+          scaleValue(measurement.shuntMicroVolts, device.currentMult, device.currentShift);
+      measurement.busMicroWatts =
+          scaleValue(measurement.shuntMicroVolts, device.powerMult, device.powerShift) *
+          (int64_t)measurement.busMilliVolts / (int64_t)1000;
+      break;
+    case INA228:  // 20-bit current and 24-bit power registers
+      shuntRaw = sample.shuntRaw;
+      measurement.shuntMicroVolts =
+          scaleValue(shuntRaw, device.shuntVoltageMult, device.shuntVoltageShift);
+      measurement.busMicroAmps =
+          scaleValue(sample.currentRaw, device.currentMult, device.currentShift);
+      measurement.busMicroWatts =
+          scaleValue(sample.powerRaw, device.powerMult, device.powerShift);
+      break;
+    default:
+      shuntRaw = sample.shuntRaw;
+      measurement.shuntMicroVolts =
+          scaleValue(shuntRaw, device.shuntVoltageMult, device.shuntVoltageShift);
+      measurement.busMicroAmps =
+          scaleValue(sample.currentRaw, device.currentMult, device.currentShift);
+      measurement.busMicroWatts =
+          scaleValue(device.autoRange ? (int32_t)sample.powerRaw : (int16_t)sample.powerRaw,
+                     device.powerMult, device.powerShift);  // Scaled by the range when automatic
+  }                                                   // of switch type
+  measurement.rangeSwitch = sample.rangeSwitch;
+  if (shuntRaw < 0) measurement.busMicroWatts *= -1;  // Invert if negative voltage
+}  // of method convertRawDevice()
+void INA_Class::startSweep(const uint8_t bus) {
+  /*!
+  @brief     Starts a conversion on all devices back to back
+  @details   Devices in triggered mode are triggered one directly after the other so that their
+             samples are aligned in time, the INA3221 channels share one configuration register and
+             only get a single trigger. Devices in continuous mode have their conversion ready flag
+             reset so that the sweep waits for the next conversion. Devices which are shut down or
+             offline, see isOnline(), are skipped. Use sweepFinished() to check for completion and
+             readSweep() to collect the results, or sweep() to do all three steps. Sweeps on
+             different buses only use the state of their own bus, so each bus can be swept
+             concurrently from its own task
+  @param[in] bus Index of the bus to sweep (Optional, when not set all buses are swept)
+  */
+  for (uint8_t i = 0; i < _busCount; i++)  // Loop for each bus
+  {
+    if (bus == UINT8_MAX || bus == i) _bus[i].sweepPending = 0;
+  }                                           // for-next each bus
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
+  {
+    const inaDet &device = entry(i);  // Use the table entry directly
+    uint16_t     &pending = _bus[device.bus].sweepPending;
+    uint8_t       slot    = device.address & 0x0F;  // Bit for this device's address
+    if (bus != UINT8_MAX && bus != device.bus) continue;                       // Other bus
+    if ((device.operatingMode & 3) == 0 || bitRead(pending, slot)) continue;  // Skip
+    if (bitRead(_bus[device.bus].offline, slot)) continue;                    // Not answering
+    if (bitRead(device.operatingMode, 2)) {
+      readConversionReady(device);  // Continuous, reset flag of the conversion in progress
+    } else {
+      triggerConversion(device);  // Triggered, start conversion
+    }                             // of if-then-else continuous mode
+    bitSet(pending, slot);
+  }  // for-next each device loop
+}  // of method startSweep()
+bool INA_Class::sweepFinished(const uint8_t bus) {
+  /*!
+  @brief     Returns whether all devices of the sweep started by startSweep() have finished
+  @details   The conversion ready flag of each address still pending is read once, addresses which
+             have finished are not read again
+  @param[in] bus Index of the bus to check (Optional, when not set all buses are checked)
+  @return    "true" when all conversions of the sweep have finished
+  */
+  uint16_t checked[INA_MAX_BUSES]{};  // Addresses read in this call
+  bool     finished{true};
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
+  {
+    const inaDet &device  = entry(i);  // Use the table entry directly
+    uint16_t     &pending = _bus[device.bus].sweepPending;
+    uint8_t       slot    = device.address & 0x0F;  // Bit for this device's address
+    if (bus != UINT8_MAX && bus != device.bus) continue;                        // Other bus
+    if (!bitRead(pending, slot) || bitRead(checked[device.bus], slot)) continue;  // Done
+    bitSet(checked[device.bus], slot);
+    if (readConversionReady(device)) {
+      bitClear(pending, slot);
+    } else {
+      finished = false;
+    }  // of if-then-else conversion finished
+  }    // for-next each device loop
+  return finished;
+}  // of method sweepFinished()
+uint8_t INA_Class::readSweep(inaMeasurement measurements[], const uint8_t bus) {
+  /*!
+  @brief     Collects the readings of all devices after a sweep
+  @details   The registers of every device are read once, without triggering a new conversion.
+             Devices which are shut down or offline aren't part of a sweep and aren't read
+  @param[out] measurements Array with an entry for every device found by begin(), indexed by
+              device number. Entries of devices on other buses or not read are left unchanged
+  @param[in] bus Index of the bus to read (Optional, when not set all buses are read)
+  @return    Number of devices read
+  */
+  uint8_t count{0};
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
+  {
+    if (bus != UINT8_MAX && bus != entry(i).bus) continue;  // Other bus
+    if ((entry(i).operatingMode & 3) == 0 || !isOnline(i)) continue;  // Not converting
+    readDevice(i, measurements[i]);
+    count++;
+  }  // for-next each device loop
+  return count;
+}  // of method readSweep()
+uint8_t INA_Class::sweep(inaMeasurement measurements[], const uint8_t bus) {
+  /*!
+  @brief     Triggers all devices, waits for the slowest and collects the readings of all devices
+  @details   Combines startSweep(), sweepFinished() and readSweep(). Compared to reading the devices
+             one after the other the samples are aligned in time, the wait for the longest
+             conversion is only made once and no register reads trigger a new conversion. The bus
+             isn't polled while the longest conversion time of the swept devices passes, see
+             getConversionMicros(). After that the ready flags are read until all are set, but
+             for at most the same time again, allowing for the devices' clock tolerance, so a
+             device which stopped answering can't stall the sweep
+  @param[out] measurements Array with an entry for every device found by begin(), indexed by
+              device number. Entries of devices on other buses or not read are left unchanged
+  @param[in] bus Index of the bus to sweep (Optional, when not set all buses are swept)
+  @return    Number of devices read
+  */
+  uint32_t longest{0};       // Longest conversion time of the swept devices
+  uint32_t start = micros();  // Time of the first trigger
+  startSweep(bus);
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
+  {
+    const inaDet &device = entry(i);  // Use the table entry directly
+    if (!bitRead(_bus[device.bus].sweepPending, device.address & 0x0F)) continue;  // Not swept
+    uint32_t duration = conversionMicros(device);
+    if (duration > longest) longest = duration;
+  }  // for-next each device loop
+  for (int32_t left; (left = start + longest - micros()) > 0;) {
+    delayMicroseconds(left < 10000 ? left : 10000);  // Sleep instead of polling the bus
+  }                                                  // of for-next until due
+  while (!sweepFinished(bus) && micros() - start < 2 * longest) {}  // Allow for slower clocks
+  return readSweep(measurements, bus);
+}  // of method sweep()
 void INA_Class::reset(const uint8_t deviceNumber) {
   /*! @brief     performs a software reset for the specified device
       @details   If no device is specified, then all devices are reset
@@ -722,8 +2410,9 @@ void INA_Class::reset(const uint8_t deviceNumber) {
     if (deviceNumber == UINT8_MAX ||
         deviceNumber % _DeviceCount == i)  // If this device needs setting
     {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      writeWord(INA_CONFIGURATION_REGISTER, INA_RESET_DEVICE, ina.address);  // Set MSB  to reset
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);  // Load device to ina structure
+      writeWord(INA_CONFIGURATION_REGISTER, INA_RESET_DEVICE, ina.address, ina.bus);  // Set MSB  to reset
       initDevice(i);                                                         // re-initialize device
     }  // of if this device needs to be set
   }    // for-next each device loop
@@ -731,26 +2420,76 @@ void INA_Class::reset(const uint8_t deviceNumber) {
 void INA_Class::setMode(const uint8_t mode, const uint8_t deviceNumber) {
   /*!
   @brief     sets the operating mode from the list given in enum type "ina_Mode" for a device
-  @details   If no device is specified, then all devices are set to the given mode
+  @details   If no device is specified, then all devices are set to the given mode. The mode is
+             only written to EEPROM when it changes
   @param[in] mode Mode (see "ina_Mode" enumerated type for list of valid values
   @param[in] deviceNumber to reset (Optional, when not set then all devices are mode changed)
   */
-  int16_t configRegister;
+  uint16_t configRegister;
   for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
   {
     if (deviceNumber == UINT8_MAX ||
         deviceNumber % _DeviceCount == i)  // If this device needs setting
     {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      configRegister = readWord(INA_CONFIGURATION_REGISTER, ina.address);  // Get current config
-      configRegister &= ~INA_CONFIG_MODE_MASK;                             // zero out  mode bits
-      ina.operatingMode = B00000111 & mode;                                // Mask off unused bits
-      writeInatoEEPROM(i);                                                 // Store back to EEPROM
-      configRegister |= ina.operatingMode;                                 // shift mode settings
-      writeWord(INA_CONFIGURATION_REGISTER, configRegister, ina.address);  // Save new value
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);                                   // Load device to struct
+      configRegister = readSettings(ina);                // Get current config
+      if (ina.operatingMode != (B00000111 & mode)) {     // Only store a changed mode
+        ina.operatingMode = B00000111 & mode;            // Mask off unused bits
+        writeInatoEEPROM(i);                             // Store back to EEPROM
+      }                                                  // of if-then mode changed
+      configRegister = applyMode(ina.type, configRegister, ina.operatingMode);  // mode settings
+      writeSettings(ina, configRegister);                // Save new value
     }  // if-then this device needs to be set
   }    // for-next each device loop
 }  // of method setMode()
+void INA_Class::configure(const uint8_t mode, const uint16_t averages, const uint32_t busConv,
+                          const uint32_t shuntConv, const uint8_t deviceNumber) {
+  /*!
+  @brief     sets mode, averaging and both conversion times of one or all devices in one write
+  @details   The final configuration register value is computed from the shadow copy of the
+             register and written to the device once, instead of the read-modify-write cycle and
+             intermediate device state of each of the setMode(), setAveraging(), setBusConversion()
+             and setShuntConversion() calls. The INA3221 channels share one configuration register
+             and it is only written once. On the INA219 the averaging and conversion times share
+             the same bits, so an averages value above 1 takes precedence over the conversion times.
+             Only the mode is kept in EEPROM, and it is only written there when it changes, so
+             switching between profiles with the same mode doesn't wear the EEPROM or flash
+  @param[in] mode Mode (see "ina_Mode" enumerated type for list of valid values
+  @param[in] averages Number of averages, see setAveraging()
+  @param[in] busConv Bus conversion time in microseconds, see setBusConversion()
+  @param[in] shuntConv Shunt conversion time in microseconds, see setShuntConversion()
+  @param[in] deviceNumber to configure (Optional, when not set all devices are configured)
+  */
+  uint16_t configRegister;
+  uint16_t lastAddress{0};     // Bus and I2C address of the last device written
+  uint16_t lastRegister{0};    // Configuration register value last written
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
+  {
+    if (deviceNumber == UINT8_MAX ||
+        deviceNumber % _DeviceCount == i)  // If this device needs setting
+    {
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);                                   // Load device to struct
+      configRegister = readSettings(ina);                // Get current config
+      configRegister = applyBusConversion(ina.type, configRegister, busConv);
+      configRegister = applyShuntConversion(ina.type, configRegister, shuntConv);
+      if (ina.type != INA219 || averages > 1) {
+        configRegister = applyAveraging(ina.type, configRegister, averages);
+      }                                      // of if-then averaging is to be set
+      if (ina.operatingMode != (B00000111 & mode)) {  // Only store a changed mode
+        ina.operatingMode = B00000111 & mode;         // Mask off unused bits
+        writeInatoEEPROM(i);                          // Store back to EEPROM
+      }                                               // of if-then mode changed
+      configRegister = applyMode(ina.type, configRegister, ina.operatingMode);  // mode settings
+      if (((ina.bus << 8) | ina.address) != lastAddress || configRegister != lastRegister) {
+        writeSettings(ina, configRegister);  // Save new value
+      }  // of if-then not already written to a shared configuration register
+      lastAddress  = (ina.bus << 8) | ina.address;
+      lastRegister = configRegister;
+    }  // if-then this device needs to be set
+  }    // for-next each device loop
+}  // of method configure()
 bool INA_Class::conversionFinished(const uint8_t deviceNumber) {
   /*!
   @brief     Returns whether or not the conversion has completed
@@ -758,68 +2497,163 @@ bool INA_Class::conversionFinished(const uint8_t deviceNumber) {
              conversion.
   @param[in] deviceNumber to check
   */
-  if (_DeviceCount == 0) return false;             // Return finished if invalid device. Issue #65
-  readInafromEEPROM(deviceNumber % _DeviceCount);  // Load EEPROM to ina structure
+  if (_DeviceCount == 0) return false;        // Return finished if invalid device. Issue #65
+  INA_STATS_TIMER(deviceNumber % _DeviceCount, INA_STATS_WAIT);
+  selectDevice(deviceNumber % _DeviceCount);  // Load device to ina structure
+  return (readConversionReady(ina));
+}  // of method "conversionFinished()"
+bool INA_Class::readConversionReady(const inaDet &device) const {
+  /*!
+  @brief     Reads the conversion ready flag of a device
+  @details   Reading the flag also resets it on all device types. The 3 INA3221 channels share one
+             flag, so it must only be read once for all 3 channels. Devices without a flag always
+             return "true". In continuous mode a set flag moves the start of the conversion used
+             by conversionDue() on by one conversion time, so that a flag read a little after each
+             predicted end doesn't push the predictions later and later until a conversion is
+             missed
+  @param[in] device Device structure to check
+  @return    "true" when a conversion has finished since the flag was last read
+  */
   uint16_t cvBits = 0;
-  switch (ina.type) {
+  switch (device.type) {
     case INA219:
-      cvBits = readWord(INA_BUS_VOLTAGE_REGISTER, ina.address) & 2;  // Bit 2 set denotes ready
-      readWord(INA_POWER_REGISTER, ina.address);                     // Resets the "ready" bit
+      cvBits = readWord(INA_BUS_VOLTAGE_REGISTER, device.address, device.bus) & 2;  // Bit 2 set denotes ready
+      readWord(INA_POWER_REGISTER, device.address, device.bus);                     // Resets the "ready" bit
       break;
     case INA226:
     case INA230:
     case INA231:
-    case INA260: cvBits = readWord(INA_MASK_ENABLE_REGISTER, ina.address) & (uint16_t)8; break;
+    case INA260: cvBits = readWord(INA_MASK_ENABLE_REGISTER, device.address, device.bus) & (uint16_t)8; break;
     case INA3221_0:
     case INA3221_1:
-    case INA3221_2: cvBits = readWord(INA3221_MASK_REGISTER, ina.address) & (uint16_t)1; break;
+    case INA3221_2: cvBits = readWord(INA3221_MASK_REGISTER, device.address, device.bus) & (uint16_t)1; break;
+    case INA228:
+      cvBits = readWord(INA228_DIAG_ALERT_REGISTER, device.address, device.bus) & INA228_CONVERSION_READY_FLAG;
+      break;
     default: cvBits = 1;
   }  // of switch type
-  if (cvBits != 0)
-    return (true);
-  else
-    return (false);
-}  // of method "conversionFinished()"
+  if (cvBits != 0 && bitRead(device.operatingMode, 2) && (device.address & 0xF0) == 0x40) {
+    uint32_t &start    = _bus[device.bus].conversionStart[device.address & 0x0F];
+    uint32_t  duration = conversionMicros(device);
+    uint32_t  elapsed  = micros() - start;
+    if (elapsed >= duration && elapsed < 2 * duration) {
+      start += duration;  // Next one began when the predicted one ended, doesn't drift
+    } else {
+      start = micros();  // Seen early or too late to know when, has begun by now
+    }  // of if-then-else seen within a conversion of its predicted end
+  }    // of if-then continuous mode
+  return (cvBits != 0);
+}  // of method readConversionReady()
+uint32_t INA_Class::conversionMicros(const inaDet &device) const {
+  /*!
+  @brief     Computes how long a conversion takes with a device's current configuration
+  @details   The configuration is taken from the shadow copy of the configuration register, so the
+             register is only read when the copy isn't valid. The nominal times of the datasheets
+             are used, the devices' clocks may deviate from them by a few percent. The INA3221
+             converts each enabled channel in turn. The INA228 has its conversion settings in its
+             ADC_CONFIG register, which has no shadow copy and is read each time. It converts the
+             bus, shunt and temperature channels enabled there in turn
+  @param[in] device Device structure to compute the time for
+  @return    Conversion time in microseconds, 0 if the device doesn't convert
+  */
+  static const uint16_t INA219_TIMES[4]{84, 148, 276, 532};  // 9-12 bit single samples
+  static const uint16_t INA219_AVERAGED[7]{106, 213, 426, 851, 1702, 3405, 6810};  // In 10us
+  static const uint16_t INA226_TIMES[8]{140, 204, 332, 588, 1100, 2116, 4156, 8244};
+  if ((device.operatingMode & 3) == 0) return 0;  // Nothing converting
+  uint16_t configRegister = readSettings(device);
+  uint32_t duration{0};
+  if (device.type == INA228) {
+    if (bitRead(configRegister, 12)) duration += INA228_TIMES[(configRegister >> 9) & 7];  // Bus
+    if (bitRead(configRegister, 13)) duration += INA228_TIMES[(configRegister >> 6) & 7];  // Shunt
+    if (bitRead(configRegister, 14)) duration += INA228_TIMES[(configRegister >> 3) & 7];  // Temp
+    duration *= AVERAGES[configRegister & 7];
+  } else if (device.type == INA219) {
+    for (uint8_t shift = 3; shift <= 7; shift += 4) {  // SADC in bits 3-6, BADC in bits 7-10
+      if (!bitRead(device.operatingMode, shift == 3 ? 0 : 1)) continue;  // Not converted
+      uint8_t setting = (configRegister >> shift) & 0xF;
+      if (setting > 8) {
+        duration += (uint32_t)INA219_AVERAGED[setting - 9] * 10;  // Not quite 532us per sample
+      } else {
+        duration += INA219_TIMES[setting == 8 ? 3 : setting & 3];  // 8 is 12 bits, 1 sample
+      }  // of if-then-else averaging
+    }  // for-next shunt and bus
+  } else {
+    if (bitRead(device.operatingMode, 0)) duration += INA226_TIMES[(configRegister >> 3) & 7];
+    if (bitRead(device.operatingMode, 1)) duration += INA226_TIMES[(configRegister >> 6) & 7];
+    duration *= AVERAGES[(configRegister >> 9) & 7];
+    if (device.type == INA3221_0 || device.type == INA3221_1 || device.type == INA3221_2) {
+      duration *= bitRead(configRegister, 14) + bitRead(configRegister, 13) +
+                  bitRead(configRegister, 12);  // Each enabled channel
+    }  // of if-then an INA3221
+  }    // of if-then-else an INA228 or INA219
+  return duration;
+}  // of method conversionMicros()
+uint32_t INA_Class::conversionDue(const inaDet &device) const {
+  /*!
+  @brief     Predicts when the conversion a device is busy with will finish
+  @details   A conversion starts when the configuration register is written, which also triggers
+             one in triggered mode, and in continuous mode when the previous one was seen to be
+             finished by readConversionReady(). The prediction is that start plus the conversion
+             time. The elapsed time since the start is compared with the conversion time, so that
+             a start which nothing has moved for more than 2^31 microseconds, e.g. a continuous
+             device whose flag isn't read, can't wrap into a prediction far in the future
+  @param[in] device Device structure to predict the time for
+  @return    micros() value when the conversion should finish, the current micros() for devices
+             whose conversion should have finished, which don't convert or whose start isn't known
+  */
+  uint32_t duration = conversionMicros(device);
+  uint32_t now      = micros();
+  if (duration == 0 || (device.address & 0xF0) != 0x40) return now;  // Nothing to wait for
+  uint32_t elapsed = now - _bus[device.bus].conversionStart[device.address & 0x0F];
+  return elapsed >= duration ? now : now + (duration - elapsed);  // Due now or still converting
+}  // of method conversionDue()
+uint32_t INA_Class::getConversionMicros(const uint8_t deviceNumber) const {
+  /*!
+  @brief     Returns how long a conversion takes with a device's current configuration
+  @details   Computed from the averaging and conversion time settings and the mode, see
+             "conversionMicros()"
+  @param[in] deviceNumber [optional] Device to return the time for
+  @return    Conversion time in microseconds, 0 for an invalid device or one which doesn't convert
+  */
+  if (deviceNumber >= _DeviceCount) return 0;  // Skip invalid devices
+  return conversionMicros(entry(deviceNumber));
+}  // of method getConversionMicros()
+uint32_t INA_Class::getConversionDue(const uint8_t deviceNumber) const {
+  /*!
+  @brief     Returns when the conversion a device is busy with should finish
+  @details   A sampler can sleep until then and confirm with a single "conversionFinished()"
+             instead of polling the ready flag, see "conversionDue()"
+  @param[in] deviceNumber [optional] Device to return the time for
+  @return    micros() value when the conversion should finish, the current micros() for an
+             invalid device or one which doesn't convert
+  */
+  if (deviceNumber >= _DeviceCount) return micros();  // Skip invalid devices
+  return conversionDue(entry(deviceNumber));
+}  // of method getConversionDue()
 void INA_Class::waitForConversion(const uint8_t deviceNumber) {
   /*!
   @brief     will not return until the conversion for the specified device is finished
   @details   if no device number is specified it will wait until all devices have finished their
              current conversion. If the conversion has completed already then the flag (and
-             interrupt pin, if activated) is also reset.
+             interrupt pin, if activated) is also reset. The bus isn't polled until the predicted
+             end of the conversion, see getConversionDue(). See the "INA_Sampler" class for a
+             non-blocking alternative
   @param[in] deviceNumber to reset (Optional, when not set all devices have their mode changed)
   */
-  uint16_t cvBits = 0;
   for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
   {
     if (deviceNumber == UINT8_MAX ||
         deviceNumber % _DeviceCount == i)  // If this device needs setting
     {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
-      cvBits = 0;
-      while (cvBits == 0)  // Loop until the value is set
-      {
-        switch (ina.type) {
-          case INA219:
-            cvBits =
-                readWord(INA_BUS_VOLTAGE_REGISTER, ina.address) & 2;  // Bit 2 set denotes ready
-            readWord(INA_POWER_REGISTER, ina.address);                // Resets the "ready" bit
-            break;
-          case INA226:
-          case INA230:
-          case INA231:
-          case INA260:
-            cvBits = readWord(INA_MASK_ENABLE_REGISTER, ina.address) & (uint16_t)8;
-            break;
-          case INA3221_0:
-          case INA3221_1:
-          case INA3221_2:
-            cvBits = readWord(INA3221_MASK_REGISTER, ina.address) & (uint16_t)1;
-            break;
-          default: cvBits = 1;
-        }  // of switch type
-      }    // of while the conversion hasn't finished
-    }      // of if this device needs to be set
-  }        // for-next each device loop
+      INA_STATS_TIMER(i, INA_STATS_WAIT);
+      selectDevice(i);  // Load device to ina structure
+      uint32_t due = conversionDue(ina);
+      for (int32_t left; (left = due - micros()) > 0;) {
+        delayMicroseconds(left < 10000 ? left : 10000);  // Sleep instead of polling the bus
+      }                                                  // of for-next until due
+      while (!readConversionReady(ina)) {}  // Loop until the value is set
+    }  // of if this device needs to be set
+  }    // for-next each device loop
 }  // of method waitForConversion()
 bool INA_Class::alertOnConversion(const bool alertState, const uint8_t deviceNumber) {
   /*!
@@ -837,16 +2671,17 @@ bool INA_Class::alertOnConversion(const bool alertState, const uint8_t deviceNum
   {
     if (deviceNumber == UINT8_MAX || deviceNumber == i)  // If this device needs setting
     {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);  // Load device to ina structure
       switch (ina.type) {
         case INA226:
         case INA230:
         case INA231:
         case INA260:
-          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address);      // Get register
+          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address, ina.bus);      // Get register
           alertRegister &= INA_ALERT_MASK;                                      // Mask off all bits
           if (alertState) bitSet(alertRegister, INA_ALERT_CONVERSION_RDY_BIT);  // Turn on the bit
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);      // Write back
+          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address, ina.bus);      // Write back
           returnCode = true;
           break;
         default: returnCode = false;
@@ -872,20 +2707,21 @@ bool INA_Class::alertOnShuntOverVoltage(const bool alertState, const int32_t mil
   {
     if (deviceNumber == UINT8_MAX || deviceNumber == i)  // If this device needs to be processed
     {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);  // Load device to ina structure
       switch (ina.type) {
         case INA226:
         case INA230:
         case INA231:
-          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address);  // Get current register
+          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address, ina.bus);  // Get current register
           alertRegister &= INA_ALERT_MASK;                                  // Mask off all bits
           if (alertState)  // If true, then also set threshold
           {
             bitSet(alertRegister, INA_ALERT_SHUNT_OVER_VOLT_BIT);           // Turn on the bit
             uint16_t threshold = milliVolts * 1000 / ina.shuntVoltage_LSB;  // Compute using LSB
-            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address);    // Write register
+            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address, ina.bus);    // Write register
           }  // of if we are setting a value
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);  // Write register back
+          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address, ina.bus);  // Write register back
           returnCode = true;
           break;
         default: returnCode = false;
@@ -911,20 +2747,21 @@ bool INA_Class::alertOnShuntUnderVoltage(const bool alertState, const int32_t mi
     if (deviceNumber == UINT8_MAX ||
         deviceNumber % _DeviceCount == i)  // If this device needs setting
     {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);  // Load device to ina structure
       switch (ina.type) {
         case INA226:
         case INA230:
         case INA231:
-          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address);  // Get current register
+          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address, ina.bus);  // Get current register
           alertRegister &= INA_ALERT_MASK;                                  // Mask off all bits
           if (alertState)                                                   // Also set threshold
           {
             bitSet(alertRegister, INA_ALERT_SHUNT_UNDER_VOLT_BIT);          // Turn on the bit
             uint16_t threshold = milliVolts * 1000 / ina.shuntVoltage_LSB;  // Compute using LSB
-            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address);    // Write register
+            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address, ina.bus);    // Write register
           }  // of if we are setting a value
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);  // Write register back
+          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address, ina.bus);  // Write register back
           break;
         default: returnCode = false;
       }  // of switch type
@@ -950,22 +2787,23 @@ bool INA_Class::alertOnBusOverVoltage(const bool alertState, const int32_t milli
     if (deviceNumber == UINT8_MAX ||
         deviceNumber % _DeviceCount == i)  // If this device needs setting
     {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);  // Load device to ina structure
       switch (ina.type) {
         case INA226:  // Devices that have an alert pin
         case INA230:
         case INA231:
         case INA260:
           alertRegister =
-              readWord(INA_MASK_ENABLE_REGISTER, ina.address);  // Get the current register
+              readWord(INA_MASK_ENABLE_REGISTER, ina.address, ina.bus);  // Get the current register
           alertRegister &= INA_ALERT_MASK;                      // Mask off all bits
           if (alertState)                                       // Also set threshold
           {
             bitSet(alertRegister, INA_ALERT_BUS_OVER_VOLT_BIT);           // Turn on the bit
             uint16_t threshold = milliVolts * 100 / ina.busVoltage_LSB;   // Compute using LSB val
-            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address);  // Write register
+            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address, ina.bus);  // Write register
           }  // of if we are setting a value
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);  // Write register back
+          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address, ina.bus);  // Write register back
           break;
         default: returnCode = false;
       }  // of switch type
@@ -991,21 +2829,22 @@ bool INA_Class::alertOnBusUnderVoltage(const bool alertState, const int32_t mill
     if (deviceNumber == UINT8_MAX ||
         deviceNumber % _DeviceCount == i)  // If this device needs setting
     {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);  // Load device to ina structure
       switch (ina.type) {
         case INA226:  // Devices that have an alert pin
         case INA230:
         case INA231:
         case INA260:
-          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address);  // Get current register
+          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address, ina.bus);  // Get current register
           alertRegister &= INA_ALERT_MASK;                                  // Mask off all bits
           if (alertState)                                                   // Also set threshold
           {
             bitSet(alertRegister, INA_ALERT_BUS_UNDER_VOLT_BIT);          // Turn on the bit
             uint16_t threshold = milliVolts * 100 / ina.busVoltage_LSB;   // Compute using LSB val
-            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address);  // Write register
+            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address, ina.bus);  // Write register
           }  // of if we are setting a value
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);  // Write register back
+          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address, ina.bus);  // Write register back
           break;
         default: returnCode = false;
       }  // of switch type
@@ -1031,21 +2870,22 @@ bool INA_Class::alertOnPowerOverLimit(const bool alertState, const int32_t milli
     if (deviceNumber == UINT8_MAX ||
         deviceNumber % _DeviceCount == i)  // If this device needs setting
     {
-      readInafromEEPROM(i);  // Load EEPROM to ina structure
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);  // Load device to ina structure
       switch (ina.type) {
         case INA226:
         case INA230:
         case INA231:
         case INA260:  // Devices with alert pin
-          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address);  // Get current register
+          alertRegister = readWord(INA_MASK_ENABLE_REGISTER, ina.address, ina.bus);  // Get current register
           alertRegister &= INA_ALERT_MASK;                                  // Mask off all bits
           if (alertState)                                                   // Also set threshold
           {
             bitSet(alertRegister, INA_ALERT_POWER_OVER_WATT_BIT);         // Turn on the bit
             uint16_t threshold = milliAmps * 1000000 / ina.power_LSB;     // Compute using LSB val
-            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address);  // Write register
+            writeWord(INA_ALERT_LIMIT_REGISTER, threshold, ina.address, ina.bus);  // Write register
           }  // of if we are setting a value
-          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address);  // Write register back
+          writeWord(INA_MASK_ENABLE_REGISTER, alertRegister, ina.address, ina.bus);  // Write register back
           break;
         default: returnCode = false;
       }  // of switch type
@@ -1053,6 +2893,249 @@ bool INA_Class::alertOnPowerOverLimit(const bool alertState, const int32_t milli
   }      // for-next each device loop
   return (returnCode);
 }  // of method AlertOnPowerOverLimit
+uint8_t INA_Class::readChannels(inaMeasurement measurements[], const uint8_t deviceNumber) {
+  /*!
+  @brief     Reads all 3 channels of an INA3221 in one call
+  @details   The INA3221 converts its channels in turn and keeps all results until the next cycle,
+             so reading them together gives one consistent set. Calling readMeasurement() for each
+             channel would, in triggered mode, restart the conversion of all 3 channels after
+             each of them, here the next conversion is only triggered once, after all 6 registers
+             have been read
+  @param[out] measurements Array of 3 entries which receive channels 1 to 3
+  @param[in] deviceNumber Device number of any of the INA3221's channels
+  @return    Number of channels read, 0 if the device isn't an INA3221
+  */
+  if (deviceNumber >= _DeviceCount) return 0;  // Skip invalid devices
+  const inaDet &device = entry(deviceNumber);
+  if (device.type != INA3221_0 && device.type != INA3221_1 && device.type != INA3221_2) return 0;
+  INA_STATS_TIMER(deviceNumber, INA_STATS_MEASUREMENT);
+  uint8_t count{0};
+  uint8_t bus     = device.bus;  // Kept, the channels may replace the entry, see entry()
+  uint8_t address = device.address;
+  for (uint8_t i = 0; i < _DeviceCount; i++) {  // Loop for each device found
+    const inaDet &channel = entry(i);
+    if (channel.bus != bus || channel.address != address) continue;  // Other chip
+    readDevice(i, measurements[channel.type - INA3221_0]);
+    count++;
+  }  // for-next each device loop
+  const inaDet &trigger = entry(deviceNumber);
+  if (!bitRead(trigger.operatingMode, 2) && (trigger.operatingMode & 3))  // Triggered & active
+  {
+    triggerConversion(trigger);  // Write once to trigger next
+  }                              // of if-then triggered mode enabled
+  return count;
+}  // of method readChannels()
+bool INA_Class::setShuntSum(const bool included, const uint8_t deviceNumber) {
+  /*!
+  @brief     Includes INA3221 channels in or excludes them from the hardware shunt-voltage sum
+  @details   The INA3221 adds the shunt voltages of the selected channels after each conversion
+             cycle, see getShuntSumMicroVolts() and alertOnShuntSum(). Reading the mask/enable
+             register resets the conversion ready flag
+  @param[in] included "true" to add the channel's shunt voltage to the sum
+  @param[in] deviceNumber Channel to change (Optional, when not set all INA3221 channels)
+  @return    Returns "true" on success, "false" if a device isn't an INA3221
+  */
+  uint16_t maskRegister;
+  bool     returnCode = true;                 // assume success
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
+  {
+    if (deviceNumber == UINT8_MAX || deviceNumber == i)  // If this device needs setting
+    {
+      const inaDet &device = entry(i);
+      if (device.type != INA3221_0 && device.type != INA3221_1 && device.type != INA3221_2) {
+        returnCode = false;
+        continue;
+      }  // of if-then not an INA3221
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      maskRegister = readWord(INA3221_MASK_REGISTER, device.address, device.bus);
+      if (included) {
+        bitSet(maskRegister, INA3221_SUM_CONTROL_BIT - (device.type - INA3221_0));
+      } else {
+        bitClear(maskRegister, INA3221_SUM_CONTROL_BIT - (device.type - INA3221_0));
+      }  // of if-then-else channel included
+      writeWord(INA3221_MASK_REGISTER, maskRegister, device.address, device.bus);
+    }  // of if this device needs to be set
+  }    // for-next each device loop
+  return (returnCode);
+}  // of method setShuntSum()
+int32_t INA_Class::getShuntSumMicroVolts(const uint8_t deviceNumber) {
+  /*!
+  @brief     Returns the sum of the shunt voltages of the INA3221 channels selected by setShuntSum()
+  @details   A single register read replaces reading and adding up each channel's shunt voltage
+  @param[in] deviceNumber Device number of any of the INA3221's channels
+  @return    Microvolts in steps of 40, 0 if the device isn't an INA3221
+  */
+  if (deviceNumber >= _DeviceCount) return 0;  // Skip invalid devices
+  const inaDet &device = entry(deviceNumber);
+  if (device.type != INA3221_0 && device.type != INA3221_1 && device.type != INA3221_2) return 0;
+  INA_STATS_TIMER(deviceNumber, INA_STATS_READ);
+  int16_t raw = readWord(INA3221_SUM_REGISTER, device.address, device.bus);
+  return ((int32_t)(raw >> 1) * 40);  // 40uV LSB in bits 1-15, shift keeps the sign
+}  // of method getShuntSumMicroVolts()
+int32_t INA_Class::getSumMicroAmps(const uint8_t deviceNumber) {
+  /*!
+  @brief     Returns the total current of the INA3221 channels selected by setShuntSum()
+  @details   The summed shunt voltage is converted with the shunt resistance of the given device,
+             so the result is only the total current when all summed channels have the same shunt
+  @param[in] deviceNumber Device number of one of the INA3221's summed channels
+  @return    Microamps, 0 if the device isn't an INA3221
+  */
+  int32_t microVolts = getShuntSumMicroVolts(deviceNumber);
+  if (microVolts == 0) return 0;  // Also covers devices which aren't an INA3221
+  const inaDet &device = entry(deviceNumber);
+  return (scaleValue(microVolts, device.currentMult, device.currentShift));
+}  // of method getSumMicroAmps()
+bool INA_Class::alertOnShuntSum(const bool alertState, const int32_t microVolts,
+                                const uint8_t deviceNumber) {
+  /*!
+  @brief     Configures the INA3221 to pull the critical ALERT pin low when the shunt-voltage sum
+             exceeds the value given in the parameter in microvolts
+  @details   The limit is shared by the 3 channels of an INA3221 and is only written once per chip.
+             The sum only contains the channels selected by setShuntSum()
+  @param[in] alertState Boolean true or false to denote the requested setting
+  @param[in] microVolts alert level at which to trigger the alarm, in steps of 40
+  @param[in] deviceNumber to set (Optional, when not set all INA3221 devices are set)
+  @return    Returns "true" on success, "false" if a device isn't an INA3221
+  */
+  int32_t  limit = microVolts / 40;            // 40uV LSB
+  uint16_t lastAddress{UINT16_MAX};            // Bus and I2C address of the last chip written
+  bool     returnCode = true;                  // assume success
+  if (limit > 16383) limit = 16383;            // 15-bit signed value
+  if (limit < -16384) limit = -16384;
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
+  {
+    if (deviceNumber == UINT8_MAX || deviceNumber == i)  // If this device needs setting
+    {
+      const inaDet &device = entry(i);
+      if (device.type != INA3221_0 && device.type != INA3221_1 && device.type != INA3221_2) {
+        returnCode = false;
+        continue;
+      }  // of if-then not an INA3221
+      if (((device.bus << 8) | device.address) == lastAddress) continue;  // Already written
+      lastAddress = (device.bus << 8) | device.address;
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      writeWord(INA3221_SUM_LIMIT_REGISTER,
+                alertState ? (uint16_t)(limit << 1) : INA3221_SUM_LIMIT_DISABLED, device.address,
+                device.bus);
+    }  // of if this device needs to be set
+  }    // for-next each device loop
+  return (returnCode);
+}  // of method alertOnShuntSum()
+bool INA_Class::alertOnChannelCritical(const bool alertState, const int32_t microVolts,
+                                       const uint8_t deviceNumber) {
+  /*!
+  @brief     Configures the INA3221 to pull the critical ALERT pin low when a channel's shunt
+             voltage exceeds the value given in the parameter in microvolts
+  @details   The critical limit is compared with every single conversion of the channel, see
+             writeChannelLimit()
+  @param[in] alertState Boolean true or false to denote the requested setting
+  @param[in] microVolts alert level at which to trigger the alarm, in steps of 40
+  @param[in] deviceNumber Channel to set (Optional, when not set all INA3221 channels are set)
+  @return    Returns "true" on success, "false" if a device isn't an INA3221
+  */
+  return (writeChannelLimit(INA3221_CRITICAL_REGISTER, alertState, microVolts, deviceNumber));
+}  // of method alertOnChannelCritical()
+bool INA_Class::alertOnChannelWarning(const bool alertState, const int32_t microVolts,
+                                      const uint8_t deviceNumber) {
+  /*!
+  @brief     Configures the INA3221 to pull the warning ALERT pin low when a channel's averaged
+             shunt voltage exceeds the value given in the parameter in microvolts
+  @details   The warning limit is compared with the average of the channel's conversions, see
+             writeChannelLimit()
+  @param[in] alertState Boolean true or false to denote the requested setting
+  @param[in] microVolts alert level at which to trigger the alarm, in steps of 40
+  @param[in] deviceNumber Channel to set (Optional, when not set all INA3221 channels are set)
+  @return    Returns "true" on success, "false" if a device isn't an INA3221
+  */
+  return (writeChannelLimit(INA3221_WARNING_REGISTER, alertState, microVolts, deviceNumber));
+}  // of method alertOnChannelWarning()
+bool INA_Class::writeChannelLimit(const uint8_t limitRegister, const bool alertState,
+                                  const int32_t microVolts, const uint8_t deviceNumber) {
+  /*!
+  @brief     Writes the critical or warning shunt voltage limit of INA3221 channels
+  @details   Each channel has its own pair of limit registers, the first channel's at
+             limitRegister and the others 2 and 4 registers further. Turning an alert off writes
+             the reset value, the highest possible limit
+  @param[in] limitRegister INA3221_CRITICAL_REGISTER or INA3221_WARNING_REGISTER
+  @param[in] alertState Boolean true or false to denote the requested setting
+  @param[in] microVolts alert level at which to trigger the alarm, in steps of 40
+  @param[in] deviceNumber Channel to set, UINT8_MAX for all INA3221 channels
+  @return    Returns "true" on success, "false" if a device isn't an INA3221
+  */
+  int32_t limit      = microVolts / 40;        // 40uV LSB
+  bool    returnCode = true;                   // assume success
+  if (limit > 4095) limit = 4095;              // 13-bit signed value
+  if (limit < -4096) limit = -4096;
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
+  {
+    if (deviceNumber == UINT8_MAX || deviceNumber == i)  // If this device needs setting
+    {
+      const inaDet &device = entry(i);
+      if (device.type != INA3221_0 && device.type != INA3221_1 && device.type != INA3221_2) {
+        returnCode = false;
+        continue;
+      }  // of if-then not an INA3221
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      writeWord(limitRegister + (device.type - INA3221_0) * 2,
+                alertState ? (uint16_t)(limit << 3) : INA3221_LIMIT_DISABLED, device.address,
+                device.bus);
+    }  // of if this device needs to be set
+  }    // for-next each device loop
+  return (returnCode);
+}  // of method writeChannelLimit()
+bool INA_Class::setPowerValidLimits(const uint16_t upperMilliVolts, const uint16_t lowerMilliVolts,
+                                    const uint8_t deviceNumber) {
+  /*!
+  @brief     Sets the bus voltage window of the INA3221's power-valid output
+  @details   The power-valid flag and pin are set once all enabled channels' bus voltages are above
+             the upper limit and cleared when any of them drops below the lower limit, see
+             getPowerValid(). The limits are shared by the 3 channels and only written once per chip
+  @param[in] upperMilliVolts Bus voltage all channels must exceed, in steps of 8
+  @param[in] lowerMilliVolts Bus voltage below which power isn't valid, in steps of 8
+  @param[in] deviceNumber to set (Optional, when not set all INA3221 devices are set)
+  @return    Returns "true" on success, "false" if a device isn't an INA3221
+  */
+  uint16_t upper = (upperMilliVolts > INA3221_LIMIT_DISABLED ? INA3221_LIMIT_DISABLED
+                                                              : upperMilliVolts) &
+                   0xFFF8;  // 8mV LSB in bits 3-15
+  uint16_t lower = (lowerMilliVolts > INA3221_LIMIT_DISABLED ? INA3221_LIMIT_DISABLED
+                                                              : lowerMilliVolts) &
+                   0xFFF8;
+  uint16_t lastAddress{UINT16_MAX};           // Bus and I2C address of the last chip written
+  bool     returnCode = true;                 // assume success
+  for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
+  {
+    if (deviceNumber == UINT8_MAX || deviceNumber == i)  // If this device needs setting
+    {
+      const inaDet &device = entry(i);
+      if (device.type != INA3221_0 && device.type != INA3221_1 && device.type != INA3221_2) {
+        returnCode = false;
+        continue;
+      }  // of if-then not an INA3221
+      if (((device.bus << 8) | device.address) == lastAddress) continue;  // Already written
+      lastAddress = (device.bus << 8) | device.address;
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      writeWord(INA3221_VALID_UPPER_REGISTER, upper, device.address, device.bus);
+      writeWord(INA3221_VALID_LOWER_REGISTER, lower, device.address, device.bus);
+    }  // of if this device needs to be set
+  }    // for-next each device loop
+  return (returnCode);
+}  // of method setPowerValidLimits()
+bool INA_Class::getPowerValid(const uint8_t deviceNumber) {
+  /*!
+  @brief     Returns the INA3221's power-valid flag, see setPowerValidLimits()
+  @details   Reading the mask/enable register resets the conversion ready flag
+  @param[in] deviceNumber Device number of any of the INA3221's channels
+  @return    "true" when power is valid, "false" otherwise or if the device isn't an INA3221
+  */
+  if (deviceNumber >= _DeviceCount) return false;  // Skip invalid devices
+  const inaDet &device = entry(deviceNumber);
+  if (device.type != INA3221_0 && device.type != INA3221_1 && device.type != INA3221_2) {
+    return false;
+  }  // of if-then not an INA3221
+  INA_STATS_TIMER(deviceNumber, INA_STATS_READ);
+  return (readWord(INA3221_MASK_REGISTER, device.address, device.bus) & INA3221_POWER_VALID_FLAG);
+}  // of method getPowerValid()
 void INA_Class::setAveraging(const uint16_t averages, const uint8_t deviceNumber) {
   /*!
   @brief     sets the hardware averaging for one or all devices
@@ -1060,65 +3143,742 @@ void INA_Class::setAveraging(const uint16_t averages, const uint8_t deviceNumber
   @param[in] averages Number of  averages to set (0-128)
   @param[in] deviceNumber to reset (Optional, when not set all devices have their averaging changed)
   */
-  uint16_t averageIndex;
-  int16_t  configRegister;
+  uint16_t configRegister;
   for (uint8_t i = 0; i < _DeviceCount; i++)  // Loop for each device found
   {
     if (deviceNumber == UINT8_MAX ||
         deviceNumber % _DeviceCount == i)  // If this device needs setting
     {
-      readInafromEEPROM(i);                                                // Load EEPROM to struct
-      configRegister = readWord(INA_CONFIGURATION_REGISTER, ina.address);  // Get current register
-      switch (ina.type) {
-        case INA219:
-          if (averages >= 128)
-            averageIndex = 15;
-          else if (averages >= 64)
-            averageIndex = 14;
-          else if (averages >= 32)
-            averageIndex = 13;
-          else if (averages >= 16)
-            averageIndex = 12;
-          else if (averages >= 8)
-            averageIndex = 11;
-          else if (averages >= 4)
-            averageIndex = 10;
-          else if (averages >= 2)
-            averageIndex = 9;
-          else
-            averageIndex = 8;
-          configRegister &= ~INA219_CONFIG_AVG_MASK;  // zero out the averages part
-          configRegister |= averageIndex << 3;        // shift in the SADC averages
-          configRegister |= averageIndex << 7;        // shift in the BADC averages
-          break;
-        case INA226:
-        case INA230:
-        case INA231:
-        case INA3221_0:
-        case INA3221_1:
-        case INA3221_2:
-        case INA260:
-          if (averages >= 1024)
-            averageIndex = 7;
-          else if (averages >= 512)
-            averageIndex = 6;
-          else if (averages >= 256)
-            averageIndex = 5;
-          else if (averages >= 128)
-            averageIndex = 4;
-          else if (averages >= 64)
-            averageIndex = 3;
-          else if (averages >= 16)
-            averageIndex = 2;
-          else if (averages >= 4)
-            averageIndex = 1;
-          else
-            averageIndex = 0;
-          configRegister &= ~INA226_CONFIG_AVG_MASK;  // zero out the averages part
-          configRegister |= averageIndex << 9;        // shift in the averages to reg
-          break;
-      }                                                                    // of switch type
-      writeWord(INA_CONFIGURATION_REGISTER, configRegister, ina.address);  // Save new value
+      INA_STATS_TIMER(i, INA_STATS_CONFIGURE);
+      selectDevice(i);                                   // Load device to struct
+      configRegister = readSettings(ina);  // Get current register
+      configRegister = applyAveraging(ina.type, configRegister, averages);  // New value
+      writeSettings(ina, configRegister);  // Save new value
     }  // of if this device needs to be set
   }    // for-next each device loop
 }  // of method setAveraging()
+INA_Sampler::INA_Sampler(INA_Class &ina) : _ina(ina) {
+  /*!
+  @brief   Class constructor
+  @details Only stores the INA_Class instance, the devices are picked up by begin()
+  @param[in] ina INA_Class instance whose devices are to be sampled
+  */
+}  // of class constructor
+INA_Sampler::~INA_Sampler() {
+  /*!
+  @brief   Class destructor
+  @details Frees the memory allocated for the device states
+  */
+  delete[] _samples;
+}  // of class destructor
+uint8_t INA_Sampler::begin() {
+  /*!
+  @brief     Prepares sampling of all devices found by the INA_Class instance
+  @details   Must be called after "INA_Class::begin()" and again whenever the devices are changed.
+             All devices start in the trigger state with no readings available. If there is
+             insufficient memory for the device states no devices are sampled
+  @return    Number of devices being sampled
+  */
+  delete[] _samples;                               // Discard any previous states
+  _deviceCount = _ina._DeviceCount;                // Sample all devices found
+  _samples     = new inaSample[_deviceCount];      // Allocate one entry per device
+  if (_samples == nullptr) {
+    _deviceCount = 0;  // Without the states nothing can be sampled
+    return _deviceCount;
+  }                                           // of if-then allocation failed
+  for (uint8_t i = 0; i < _deviceCount; i++)  // Loop for each device found
+  {
+    _samples[i].state     = INA_SAMPLE_TRIGGER;
+    _samples[i].available = false;
+  }  // for-next each device loop
+  return _deviceCount;
+}  // of method begin()
+uint8_t INA_Sampler::poll() {
+  /*!
+  @brief     Advances every device by one step of the sampling state machine without blocking
+  @details   A device in the trigger state gets a conversion started if it is in triggered mode and
+             moves to the wait state. A waiting device has its conversion ready flag read once,
+             but not before its conversion is predicted to end, see "getConversionDue()", and, if
+             set, the registers are read into its measurement without triggering again and the
+             device returns to the trigger state. The INA3221 channels share one configuration
+             register and one ready flag, so consecutive channels at the same address are only
+             triggered and checked once per call
+  @return    Number of devices with a new measurement in this call
+  */
+  uint8_t  collected{0};         // Number of new measurements
+  uint16_t triggeredAddress{0};  // Last bus and address triggered in this call
+  uint16_t checkedAddress{0};    // Last bus and address whose ready flag was read in this call
+  bool     ready{false};         // Ready flag of checkedAddress
+  for (uint8_t i = 0; i < _deviceCount && i < _ina._DeviceCount; i++)  // Loop for each device
+  {
+    const inaDet &device  = _ina.entry(i);  // Use the table entry directly
+    inaSample    &sample  = _samples[i];
+    uint16_t      address = (device.bus << 8) | device.address;  // Unique on all buses
+    if (!_ina.isOnline(i)) continue;  // Marked offline by rescan()
+    switch (sample.state) {
+      case INA_SAMPLE_TRIGGER:
+        if (!bitRead(device.operatingMode, 2) && (device.operatingMode & 3) &&
+            address != triggeredAddress) {  // Triggered, active and not yet triggered
+          _ina.triggerConversion(device);
+          triggeredAddress = address;
+        }  // of if-then conversion needs triggering
+        sample.state = INA_SAMPLE_WAIT;
+        break;
+      case INA_SAMPLE_WAIT:
+        if (address != checkedAddress) {  // Reading the flag resets it, only read once
+          ready = (int32_t)(_ina.conversionDue(device) - micros()) <= 0 &&  // Not before due
+                  _ina.readConversionReady(device);
+          checkedAddress = address;
+        }  // of if-then flag not read yet
+        if (!ready) break;  // Keep on waiting
+        sample.state = INA_SAMPLE_COLLECT;
+        // fall through
+      case INA_SAMPLE_COLLECT:
+        _ina.readDevice(i, sample.measurement);  // Read without triggering
+        sample.available = true;
+        sample.state     = INA_SAMPLE_TRIGGER;
+        collected++;
+        break;
+    }  // of switch state
+  }    // for-next each device loop
+  return collected;
+}  // of method poll()
+bool INA_Sampler::available(const uint8_t deviceNumber) const {
+  /*!
+  @brief     Returns whether a device has a measurement which hasn't been read yet
+  @param[in] deviceNumber to check
+  @return    "true" if read() will return a new measurement
+  */
+  if (deviceNumber >= _deviceCount) return false;  // Skip invalid devices
+  return (_samples[deviceNumber].available);
+}  // of method available()
+bool INA_Sampler::read(inaMeasurement &measurement, const uint8_t deviceNumber) {
+  /*!
+  @brief     Returns the last measurement collected for a device
+  @details   The measurement is only returned once, until poll() collects the next one
+  @param[out] measurement Structure which receives the values
+  @param[in] deviceNumber to return the values for
+  @return    "true" if a new measurement was returned, otherwise "false" and the structure is
+             left unchanged
+  */
+  if (!available(deviceNumber)) return false;  // Nothing new
+  measurement                      = _samples[deviceNumber].measurement;
+  _samples[deviceNumber].available = false;
+  return true;
+}  // of method read()
+INA_AlertSampler::INA_AlertSampler(INA_Class &ina) : _ina(ina) {
+  /*!
+  @brief   Class constructor
+  @details Only stores the INA_Class instance, the devices are set up by begin()
+  @param[in] ina INA_Class instance whose devices are to be sampled
+  */
+}  // of class constructor
+INA_AlertSampler::~INA_AlertSampler() {
+  /*!
+  @brief   Class destructor
+  @details Frees the memory allocated for the device states
+  */
+  delete[] _samples;
+}  // of class destructor
+uint8_t INA_AlertSampler::begin(const uint8_t deviceNumber) {
+  /*!
+  @brief     Prepares sampling of the devices on the sampler's ALERT line
+  @details   Must be called after "INA_Class::begin()" and before the interrupt is attached. Each
+             device is set with "alertOnConversion()" to pull its ALERT pin low when a conversion
+             finishes, devices without that function are not sampled. Further devices sharing the
+             same open-drain line can be added with addDevice(). Any queued ALERT edges and
+             readings are discarded. If there is insufficient memory no devices are sampled
+  @param[in] deviceNumber [optional] Device on the line, when not specified all devices are
+  @return    Number of devices being sampled
+  */
+  delete[] _samples;                              // Discard any previous states
+  _deviceCount = _ina._DeviceCount;               // Keep a state for every device
+  _samples     = new inaAlertSample[_deviceCount]();  // Allocate zeroed entries
+  if (_samples == nullptr) _deviceCount = 0;      // Without the states nothing can be sampled
+  _head   = 0;
+  _tail   = 0;
+  _rescan = true;  // The line may already be low, so the first service() call scans it
+  uint8_t devices{0};  // Number of devices on the line
+  for (uint8_t i = 0; i < _deviceCount; i++)  // Loop for each device found
+  {
+    if ((deviceNumber == UINT8_MAX || deviceNumber == i) && addDevice(i)) devices++;
+  }  // for-next each device loop
+  return devices;
+}  // of method begin()
+bool INA_AlertSampler::addDevice(const uint8_t deviceNumber) {
+  /*!
+  @brief     Adds a device whose ALERT pin shares the sampler's line
+  @details   The device is set to pull its ALERT pin low when a conversion finishes, see begin()
+  @param[in] deviceNumber to add
+  @return    "true" if the device is sampled, "false" for an invalid device or one without a
+             conversion ready alert
+  */
+  if (deviceNumber >= _deviceCount) return false;  // Skip invalid devices
+  _samples[deviceNumber].onLine = _ina.alertOnConversion(true, deviceNumber);
+  return (_samples[deviceNumber].onLine);
+}  // of method addDevice()
+void INA_ISR_ATTR INA_AlertSampler::alertISR() {
+  /*!
+  @brief     Records an ALERT edge, to be called from the interrupt handler of the line
+  @details   Only stores micros() in the queue, no I2C transfers are made and interrupts are not
+             enabled. The queue index is published with release semantics so that service() sees
+             the stored time before the new index. When the queue is full the edge is only counted
+             in getOverruns(), the readings are not lost since every queued edge makes service()
+             check all devices on the line
+  */
+  uint8_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);      // Only changed here
+  uint8_t next = (head + 1) & (INA_ALERT_QUEUE_SIZE - 1);  // Queue index wraps around
+  if (next == __atomic_load_n(&_tail, __ATOMIC_ACQUIRE)) {     // Queue full
+    if (_overruns != UINT8_MAX) _overruns++;
+    return;
+  }  // of if-then queue full
+  _queue[head] = micros();
+  __atomic_store_n(&_head, next, __ATOMIC_RELEASE);  // Publish the entry
+}  // of method alertISR()
+uint8_t INA_AlertSampler::service() {
+  /*!
+  @brief     Reads the devices which have finished a conversion, called outside of the interrupt
+  @details   For each queued ALERT edge the conversion ready flags of all devices on the line are
+             read, which also releases their ALERT pins, and the registers of every device with the
+             flag set are read into its measurement with the time of the edge. If the device is in
+             triggered mode the next conversion is started. On a shared line a device finishing
+             while another still holds the line low causes no edge of its own, so after a scan
+             which found a device the line is scanned once more on the next call, even when no
+             edge is queued; readings found by that scan get the time of the scan
+  @return    Number of devices with a new measurement in this call
+  */
+  uint8_t collected{0};  // Number of new measurements
+  uint8_t tail = _tail;  // Only changed here
+  if (tail == __atomic_load_n(&_head, __ATOMIC_ACQUIRE) && _rescan) {
+    collected = scanLine(micros());  // Look for a device hidden behind another one
+    _rescan   = (collected != 0);
+  }  // of if-then no edge but a rescan is needed
+  while (tail != __atomic_load_n(&_head, __ATOMIC_ACQUIRE)) {  // Loop for each queued edge
+    uint32_t alertMicros = _queue[tail];
+    tail                 = (tail + 1) & (INA_ALERT_QUEUE_SIZE - 1);
+    __atomic_store_n(&_tail, tail, __ATOMIC_RELEASE);  // Entry can now be reused by alertISR()
+    uint8_t found = scanLine(alertMicros);
+    _rescan       = (found != 0);
+    collected += found;
+  }  // of while-loop each queued edge
+  return collected;
+}  // of method service()
+uint8_t INA_AlertSampler::scanLine(const uint32_t alertMicros) {
+  /*!
+  @brief     Reads the devices on the line which have finished a conversion
+  @param[in] alertMicros Time stored with the readings
+  @return    Number of devices with a new measurement
+  */
+  uint8_t collected{0};  // Number of new measurements
+  for (uint8_t i = 0; i < _deviceCount && i < _ina._DeviceCount; i++)  // Loop for each device
+  {
+    inaAlertSample &sample = _samples[i];
+    if (!sample.onLine || !_ina.isOnline(i)) continue;  // Other line or marked offline
+    if (!_ina.readConversionReady(_ina.entry(i))) continue;
+    _ina.readMeasurement(sample.measurement, i);  // Read and trigger if needed
+    sample.alertMicros = alertMicros;
+    sample.available   = true;
+    collected++;
+  }  // for-next each device loop
+  return collected;
+}  // of method scanLine()
+bool INA_AlertSampler::available(const uint8_t deviceNumber) const {
+  /*!
+  @brief     Returns whether a device has a measurement which hasn't been read yet
+  @param[in] deviceNumber to check
+  @return    "true" if read() will return a new measurement
+  */
+  if (deviceNumber >= _deviceCount) return false;  // Skip invalid devices
+  return (_samples[deviceNumber].available);
+}  // of method available()
+bool INA_AlertSampler::read(inaMeasurement &measurement, const uint8_t deviceNumber,
+                            uint32_t *alertMicros) {
+  /*!
+  @brief     Returns the last measurement collected for a device
+  @details   The measurement is only returned once, until service() collects the next one
+  @param[out] measurement Structure which receives the values
+  @param[in] deviceNumber to return the values for
+  @param[out] alertMicros [optional] Receives the micros() value of the ALERT edge
+  @return    "true" if a new measurement was returned, otherwise "false" and the structure is
+             left unchanged
+  */
+  if (!available(deviceNumber)) return false;  // Nothing new
+  measurement = _samples[deviceNumber].measurement;
+  if (alertMicros != nullptr) *alertMicros = _samples[deviceNumber].alertMicros;
+  _samples[deviceNumber].available = false;
+  return true;
+}  // of method read()
+uint8_t INA_AlertSampler::getOverruns() const {
+  /*!
+  @brief     Returns the number of ALERT edges which came in while the queue was full
+  @return    Number of edges, stops counting at 255
+  */
+  return (__atomic_load_n(&_overruns, __ATOMIC_RELAXED));
+}  // of method getOverruns()
+bool INA_SampleRing::push(const inaRawSample &sample) {
+  /*!
+  @brief     Adds a sample, only to be called by the producer
+  @details   The sample is copied into the ring before the new head index is published, so the
+             consumer never sees a partly written sample. When the ring is full the sample is
+             dropped and counted
+  @param[in] sample Sample to add
+  @return    "true" if the sample was added, "false" if it was dropped
+  */
+  uint8_t head = _head;                                // Only changed here
+  uint8_t next = (head + 1) & (INA_RING_SIZE - 1);  // Index wraps around
+  if (next == __atomic_load_n(&_tail, __ATOMIC_ACQUIRE)) {  // Ring full
+    if (_dropped != UINT16_MAX) _dropped++;
+    return false;
+  }  // of if-then ring full
+  _ring[head]         = sample;
+  _ring[head].dropped = _dropped > UINT8_MAX ? UINT8_MAX : _dropped;  // Report the overruns
+  _dropped            = 0;
+  __atomic_store_n(&_head, next, __ATOMIC_RELEASE);  // Publish the entry
+  return true;
+}  // of method push()
+bool INA_SampleRing::full() const {
+  /*!
+  @brief     Returns whether push() would drop a sample, only to be called by the producer
+  @details   Lets a producer which can wait, e.g. a task reading a sensor without deadline, wait
+             for room instead of dropping samples
+  @return    "true" if the ring is full
+  */
+  return (((_head + 1) & (INA_RING_SIZE - 1)) == __atomic_load_n(&_tail, __ATOMIC_ACQUIRE));
+}  // of method full()
+uint8_t INA_SampleRing::drain(inaRawSample samples[], const uint8_t maxSamples) {
+  /*!
+  @brief     Takes the oldest samples out of the ring, only to be called by the consumer
+  @details   All samples available, up to maxSamples, are copied with one acquire load of the head
+             index and the entries are released to the producer with one store of the tail index
+  @param[out] samples Array which receives the samples, oldest first
+  @param[in] maxSamples Number of entries in the array
+  @return    Number of samples copied
+  */
+  uint8_t tail = _tail;                                 // Only changed here
+  uint8_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+  uint8_t count{0};                                     // Number of samples copied
+  while (tail != head && count < maxSamples) {
+    samples[count] = _ring[tail];
+    _overruns += samples[count++].dropped;
+    tail = (tail + 1) & (INA_RING_SIZE - 1);
+  }  // of while-loop samples to copy
+  __atomic_store_n(&_tail, tail, __ATOMIC_RELEASE);  // Entries can now be reused by push()
+  return count;
+}  // of method drain()
+uint8_t INA_SampleRing::available() const {
+  /*!
+  @brief     Returns the number of samples drain() can take out, only to be called by the consumer
+  @return    Number of samples in the ring
+  */
+  return ((__atomic_load_n(&_head, __ATOMIC_ACQUIRE) - _tail) & (INA_RING_SIZE - 1));
+}  // of method available()
+uint32_t INA_SampleRing::getOverruns() const {
+  /*!
+  @brief     Returns the number of samples dropped because the ring was full
+  @details   Only to be called by the consumer. Counts the drops reported in the samples drain()
+             has taken out, drops after the last of those are reported with the next sample
+  @return    Number of dropped samples
+  */
+  return _overruns;
+}  // of method getOverruns()
+INA_LatestTable::INA_LatestTable(INA_Class &ina) : _ina(ina) {
+  /*!
+  @brief   Class constructor
+  @details Only stores the INA_Class instance, the table is allocated by begin()
+  @param[in] ina INA_Class instance whose devices are to be stored
+  */
+}  // of class constructor
+INA_LatestTable::~INA_LatestTable() {
+  /*!
+  @brief   Class destructor
+  @details Frees the memory allocated for the table
+  */
+  delete[] _latest;
+}  // of class destructor
+uint8_t INA_LatestTable::begin() {
+  /*!
+  @brief     Allocates an empty entry for each device found by the INA_Class instance
+  @details   Must be called after "INA_Class::begin()" and before any readers use the table. If
+             there is insufficient memory for the table no devices are stored
+  @return    Number of entries
+  */
+  delete[] _latest;                              // Discard any previous table
+  _deviceCount = _ina._DeviceCount;              // One entry for every device found
+  _latest      = new inaLatest[_deviceCount]();  // Allocate zeroed entries
+  if (_latest == nullptr) _deviceCount = 0;      // Without the table nothing can be stored
+  return _deviceCount;
+}  // of method begin()
+bool INA_LatestTable::update(const uint8_t deviceNumber) {
+  /*!
+  @brief     Reads a device with "readMeasurement()" and stores the readings, writer only
+  @param[in] deviceNumber to read
+  @return    "true" if the device was read, "false" for an invalid device number
+  */
+  inaMeasurement measurement;  // New readings
+  uint32_t       readMicros = micros();
+  if (deviceNumber >= _deviceCount || !_ina.readMeasurement(measurement, deviceNumber)) {
+    return false;
+  }  // of if-then invalid device
+  return publish(deviceNumber, measurement, readMicros);
+}  // of method update()
+bool INA_LatestTable::publish(const uint8_t deviceNumber, const inaMeasurement &measurement,
+                              const uint32_t readMicros) {
+  /*!
+  @brief     Stores readings taken elsewhere, e.g. by an INA_Sampler, writer only
+  @details   The sequence counter is made odd before and even again after the entry is written,
+             with release ordering so that a reader seeing the final count also sees the readings.
+             The even count skips 0, which marks an entry which was never written. A reader would
+             take a copy for consistent when the count wrapped round to the same value during
+             it, so the count is 32 bits wide except on the AVR, see "inaSequence"
+  @param[in] deviceNumber Device the readings are from
+  @param[in] measurement Readings to store
+  @param[in] readMicros micros() when the readings were taken
+  @return    "true" if the readings were stored, "false" for an invalid device number
+  */
+  if (deviceNumber >= _deviceCount) return false;  // Skip invalid devices
+  inaLatest  &entry    = _latest[deviceNumber];
+  inaSequence sequence = entry.sequence;  // Only changed here
+  __atomic_store_n(&entry.sequence, (inaSequence)(sequence + 1), __ATOMIC_RELAXED);  // Odd, busy
+  __atomic_thread_fence(__ATOMIC_RELEASE);  // Readers see the odd count before new data
+  entry.measurement = measurement;
+  entry.micros      = readMicros;
+  sequence += 2;
+  if (sequence == 0) sequence = 2;  // 0 is kept for entries never written
+  __atomic_store_n(&entry.sequence, sequence, __ATOMIC_RELEASE);  // Even, done
+  return true;
+}  // of method publish()
+bool INA_ISR_ATTR INA_LatestTable::read(inaMeasurement &measurement, const uint8_t deviceNumber,
+                                        uint32_t *readMicros, const uint8_t retries) const {
+  /*!
+  @brief     Returns the latest readings of a device without any I2C traffic
+  @details   Can be called from any task or interrupt while the writer updates the table. The
+             entry is copied and the copy is only returned when the sequence counter was even and
+             unchanged during the copy, otherwise the copy is repeated up to "retries" times
+  @param[out] measurement Structure which receives the readings
+  @param[in] deviceNumber to return the readings of
+  @param[out] readMicros [optional] Receives the micros() value when the readings were taken
+  @param[in] retries [optional] Number of copies to try, see INA_LATEST_RETRIES
+  @return    "true" if consistent readings were returned, "false" for an invalid device number, a
+             device not yet written or when the writer was busy with the entry on every try
+  */
+  if (deviceNumber >= _deviceCount) return false;  // Skip invalid devices
+  const inaLatest &entry = _latest[deviceNumber];
+  for (uint8_t attempt = 0; attempt < retries; attempt++) {
+    inaSequence before = __atomic_load_n(&entry.sequence, __ATOMIC_ACQUIRE);
+    if (before == 0) return false;  // Never written
+    if (before & 1) continue;       // Writer busy
+    inaMeasurement copy  = entry.measurement;
+    uint32_t       taken = entry.micros;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);  // Copy completes before the count is read again
+    if (__atomic_load_n(&entry.sequence, __ATOMIC_RELAXED) != before) continue;  // Overwritten
+    measurement = copy;
+    if (readMicros != nullptr) *readMicros = taken;
+    return true;
+  }  // for-next each attempt
+  return false;
+}  // of method read()
+#if defined(INA_BACKGROUND)
+INA_BackgroundSampler::INA_BackgroundSampler(INA_Class &ina) : _ina(ina) {
+  /*!
+  @brief   Class constructor
+  @details Only stores the INA_Class instance, the schedule is allocated by begin()
+  @param[in] ina INA_Class instance whose devices are to be sampled
+  */
+}  // of class constructor
+INA_BackgroundSampler::~INA_BackgroundSampler() {
+  /*!
+  @brief   Class destructor
+  @details Stops the task and frees the memory allocated for the schedule
+  */
+  stop();
+  delete[] _schedule;
+}  // of class destructor
+uint8_t INA_BackgroundSampler::begin(const uint32_t periodMicros) {
+  /*!
+  @brief     Allocates the schedule and sets every device found by the INA_Class to one period
+  @details   Must be called after "INA_Class::begin()" and "setI2CSpeed()" while the sampler is
+             stopped. The first reading of each device is due at once. Devices are added in order
+             as long as the bus time allows, see setPeriod(), the others get a period of 0. If
+             there is insufficient memory for the schedule no devices are sampled
+  @param[in] periodMicros [optional] Time between the readings of each device, 0 to sample none
+  @return    Number of devices in the schedule
+  */
+  delete[] _schedule;                              // Discard any previous schedule
+  _deviceCount = _ina._DeviceCount;                // One entry for every device found
+  _schedule    = new inaSchedule[_deviceCount]();  // Allocate zeroed entries
+  if (_schedule == nullptr) _deviceCount = 0;      // Without the schedule nothing is sampled
+  _nowMicros = micros();
+  for (uint8_t i = 0; i < _deviceCount; i++) {
+    _schedule[i].dueMicros   = _nowMicros;
+    _schedule[i].statsMicros = _nowMicros;
+    setPeriod(i, periodMicros);
+  }  // for-next each device
+  return _deviceCount;
+}  // of method begin()
+bool INA_BackgroundSampler::setPeriod(const uint8_t deviceNumber, const uint32_t periodMicros) {
+  /*!
+  @brief     Sets the time between the readings of a device
+  @details   The period is refused when the readings of all devices would then need more than
+             INA_SCHEDULE_UTILIZATION percent of the bus time, with "getReadMicros()" as the time
+             of one reading. Can be called while the sampler runs from one other task at a time,
+             the period is stored with a single atomic write and the task uses it from its next
+             pass
+  @param[in] deviceNumber Device to change
+  @param[in] periodMicros Time between readings, 0 stops sampling the device
+  @return    "true" if the period was set, "false" for an invalid device number or when the bus
+             capacity would be exceeded
+  */
+  if (deviceNumber >= _deviceCount) return false;  // Skip invalid devices
+  uint32_t cost = _ina.getReadMicros(deviceNumber);
+  if (periodMicros != 0 && utilization(deviceNumber) + ((uint64_t)cost * 1000 + periodMicros - 1) /
+                                                             periodMicros >
+                               (uint32_t)INA_SCHEDULE_UTILIZATION * 10) {
+    return false;
+  }  // of if-then bus capacity exceeded
+  __atomic_store_n(&_schedule[deviceNumber].costMicros, cost, __ATOMIC_RELAXED);
+  __atomic_store_n(&_schedule[deviceNumber].periodMicros, periodMicros, __ATOMIC_RELAXED);
+  return true;
+}  // of method setPeriod()
+uint32_t INA_BackgroundSampler::getPeriod(const uint8_t deviceNumber) const {
+  /*!
+  @brief     Returns the time between the readings of a device
+  @param[in] deviceNumber Device to return the period of
+  @return    Period in microseconds, 0 if the device isn't sampled or is invalid
+  */
+  if (deviceNumber >= _deviceCount) return 0;  // Skip invalid devices
+  return __atomic_load_n(&_schedule[deviceNumber].periodMicros, __ATOMIC_RELAXED);
+}  // of method getPeriod()
+uint32_t INA_BackgroundSampler::utilization(const uint8_t skipDevice) const {
+  /*!
+  @brief     Returns the share of the bus time the sampled devices need
+  @param[in] skipDevice Device to leave out, UINT8_MAX for none
+  @return    Bus time in permille, each device's share rounded up
+  */
+  uint32_t permille{0};
+  for (uint8_t i = 0; i < _deviceCount; i++) {
+    uint32_t period = __atomic_load_n(&_schedule[i].periodMicros, __ATOMIC_RELAXED);
+    if (i == skipDevice || period == 0) continue;
+    uint32_t cost = __atomic_load_n(&_schedule[i].costMicros, __ATOMIC_RELAXED);
+    permille += ((uint64_t)cost * 1000 + period - 1) / period;
+  }  // for-next each device
+  return permille;
+}  // of method utilization()
+uint8_t INA_BackgroundSampler::getUtilization() const {
+  /*!
+  @brief     Returns the share of the bus time the current schedule needs
+  @return    Percent of the bus time, at most INA_SCHEDULE_UTILIZATION
+  */
+  return (utilization(UINT8_MAX) + 9) / 10;
+}  // of method getUtilization()
+bool INA_BackgroundSampler::readScheduleStats(inaScheduleStats &stats, const uint8_t deviceNumber,
+                                              const bool reset) {
+  /*!
+  @brief     Returns the readings, missed deadlines and achieved rate of a device
+  @details   Can be called from any task while the sampler runs. The rate is computed over the
+             time from the last reset to the last run(). A reset is done by the next run()
+  @param[out] stats Structure which receives the statistics
+  @param[in] deviceNumber Device to return the statistics of
+  @param[in] reset [optional] Restart the statistics of the device
+  @return    "true" if the statistics were returned, "false" for an invalid device number
+  */
+  if (deviceNumber >= _deviceCount) return false;  // Skip invalid devices
+  inaSchedule &entry = _schedule[deviceNumber];
+  stats.readings     = __atomic_load_n(&entry.readings, __ATOMIC_RELAXED);
+  stats.missed       = __atomic_load_n(&entry.missed, __ATOMIC_RELAXED);
+  uint32_t elapsed   = __atomic_load_n(&_nowMicros, __ATOMIC_RELAXED) -
+                     __atomic_load_n(&entry.statsMicros, __ATOMIC_RELAXED);
+  stats.milliHertz = elapsed ? (uint64_t)stats.readings * 1000000000 / elapsed : 0;
+  if (reset) __atomic_store_n(&entry.resetPending, true, __ATOMIC_RELEASE);
+  return true;
+}  // of method readScheduleStats()
+void INA_BackgroundSampler::setRing(INA_SampleRing *ring) {
+  /*!
+  @brief     Sets the ring which receives the raw sample of every reading, only while stopped
+  @param[in] ring Ring to push the samples to, nullptr for none
+  */
+  _ring = ring;
+}  // of method setRing()
+void INA_BackgroundSampler::setTable(INA_LatestTable *table) {
+  /*!
+  @brief     Sets the table which receives every reading, only while stopped
+  @param[in] table Table to publish the readings to, nullptr for none. It must have been begun
+  */
+  _table = table;
+}  // of method setTable()
+void INA_BackgroundSampler::setCallback(inaSampleCallback callback) {
+  /*!
+  @brief     Sets the function called with every reading, only while stopped
+  @details   The function is called on the sampler's task and delays the following readings, so it
+             should only pass the values on
+  @param[in] callback Function to call, nullptr for none
+  */
+  _callback = callback;
+}  // of method setCallback()
+uint32_t INA_BackgroundSampler::run(const uint32_t nowMicros) {
+  /*!
+  @brief     Scheduling core, reads every device whose reading is due, earliest deadline first
+  @details   Called in a loop by the task started with start(), or directly by a program which
+             samples on its own loop or thread. A reading is due one period after the previous one
+             was due, so the rate doesn't drift, and its deadline is when the next one is due. The
+             clock isn't read again during the call: the time is advanced by the estimate of
+             "getReadMicros()" after each reading, so that the schedule follows a simulated clock
+             as well. A reading finished after its deadline by that estimate counts as missed, as
+             do the readings skipped when a device has fallen more than a period behind, instead
+             of catching up in a burst. The missed deadlines are therefore modelled, not measured:
+             retries, bus contention or a preempted task which make a reading take longer only
+             show up in the next call's "nowMicros". A device marked offline by "rescan()" keeps
+             its schedule, but its failed readings are neither counted as readings nor as missed.
+             At most one reading per device is taken in each call
+  @param[in] nowMicros Current micros(), from a simulated clock when testing
+  @return    Microseconds until the next reading is due, at most INA_BACKGROUND_IDLE_MICROS
+  */
+  uint32_t now = nowMicros;
+  for (uint8_t i = 0; i < _deviceCount; i++) {
+    inaSchedule &entry = _schedule[i];
+    entry.taken        = false;
+    if (__atomic_load_n(&entry.resetPending, __ATOMIC_ACQUIRE)) {
+      __atomic_store_n(&entry.readings, 0, __ATOMIC_RELAXED);
+      __atomic_store_n(&entry.missed, 0, __ATOMIC_RELAXED);
+      __atomic_store_n(&entry.statsMicros, now, __ATOMIC_RELAXED);
+      __atomic_store_n(&entry.resetPending, false, __ATOMIC_RELEASE);
+    }  // of if-then statistics reset requested
+  }    // for-next each device
+  for (uint8_t pass = 0; pass < _deviceCount; pass++) {
+    uint8_t  next{UINT8_MAX};  // Device with the earliest deadline
+    int32_t  earliest{INT32_MAX};
+    uint32_t period{0};
+    for (uint8_t i = 0; i < _deviceCount; i++) {
+      inaSchedule &entry      = _schedule[i];
+      uint32_t     thisPeriod = __atomic_load_n(&entry.periodMicros, __ATOMIC_RELAXED);
+      if (thisPeriod == 0) {
+        entry.dueMicros = now;  // Read at once when the device is sampled again
+        continue;
+      }  // of if-then device not sampled
+      if (entry.taken || (int32_t)(now - entry.dueMicros) < 0) continue;  // Read or not due
+      int32_t deadline = entry.dueMicros + thisPeriod - now;
+      if (deadline < earliest) {
+        earliest = deadline;
+        next     = i;
+        period   = thisPeriod;
+      }  // of if-then earlier deadline
+    }    // for-next each device
+    if (next == UINT8_MAX) break;  // Nothing due
+    inaSchedule &entry = _schedule[next];
+    entry.taken        = true;                             // Once per call, even when late
+    inaRawSample sample;                                   // Register values read
+    bool         read = _ina.readRawSample(sample, next);  // "false" while marked offline
+    if (read && _ring != nullptr) _ring->push(sample);
+    if (read && (_table != nullptr || _callback != nullptr)) {
+      inaMeasurement measurement;  // Converted values
+      _ina.convertSample(sample, measurement);
+      if (_table != nullptr) _table->publish(next, measurement, sample.micros);
+      if (_callback != nullptr) _callback(next, measurement, sample.micros);
+    }  // of if-then readings wanted
+    if (read) now += __atomic_load_n(&entry.costMicros, __ATOMIC_RELAXED);  // No bus time if not
+    uint32_t missed = entry.missed;
+    entry.dueMicros += period;  // Deadline of this reading and due time of the next
+    int32_t behind = now - entry.dueMicros;
+    if (behind > 0 && read) missed++;  // Finished late
+    if (behind >= (int32_t)period) {
+      uint32_t skipped = behind / period;  // Readings whose deadlines have passed as well
+      if (read) missed += skipped;
+      entry.dueMicros += skipped * period;
+    }  // of if-then readings skipped
+    if (!read) continue;  // A device marked offline is neither read nor late, only rescheduled
+    __atomic_store_n(&entry.readings, entry.readings + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry.missed, missed, __ATOMIC_RELAXED);
+  }  // for-next each reading
+  __atomic_store_n(&_nowMicros, now, __ATOMIC_RELAXED);
+  uint32_t wait = INA_BACKGROUND_IDLE_MICROS;
+  for (uint8_t i = 0; i < _deviceCount; i++) {
+    if (__atomic_load_n(&_schedule[i].periodMicros, __ATOMIC_RELAXED) == 0) continue;
+    int32_t left = _schedule[i].dueMicros - now;
+    if (left <= 0) return 0;  // Already due
+    if ((uint32_t)left < wait) wait = left;
+  }  // for-next each device
+  return wait;
+}  // of method run()
+void INA_BackgroundSampler::task(void *parameter) {
+  /*!
+  @brief     Body of the task or thread started by start()
+  @details   Calls run() until stop() clears "_run" and sleeps until the next reading is due. On
+             FreeRTOS waits shorter than a tick are spent in delayMicroseconds(), so periods below
+             the tick period keep the task busy and its priority should allow for that
+  @param[in] parameter The INA_BackgroundSampler instance
+  */
+  INA_BackgroundSampler *sampler = static_cast<INA_BackgroundSampler *>(parameter);
+  while (__atomic_load_n(&sampler->_run, __ATOMIC_ACQUIRE)) {
+    uint32_t wait = sampler->run(micros());
+  #if defined(INA_LINUX)
+    delayMicroseconds(wait);
+  #else
+    TickType_t ticks = wait / (portTICK_PERIOD_MS * 1000);
+    if (ticks > 0) {
+      vTaskDelay(ticks);
+    } else {
+      delayMicroseconds(wait);
+    }  // of if-then-else wait at least a tick
+  #endif
+  }  // of while-loop running
+  #if !defined(INA_LINUX)
+  __atomic_store_n(&sampler->_task, (TaskHandle_t) nullptr, __ATOMIC_RELEASE);
+  vTaskDelete(nullptr);  // FreeRTOS tasks must not return
+  #endif
+}  // of method task()
+  #if defined(INA_LINUX)
+bool INA_BackgroundSampler::start() {
+  /*!
+  @brief     Starts sampling on a new thread
+  @return    "true" if the thread was started, "false" if the sampler was already running
+  */
+  if (running()) return false;
+  __atomic_store_n(&_run, true, __ATOMIC_RELEASE);
+  _thread = std::thread(task, this);
+  return true;
+}  // of method start()
+  #else
+bool INA_BackgroundSampler::start(const BaseType_t core, const UBaseType_t priority,
+                                  const uint32_t stackSize) {
+  /*!
+  @brief     Starts sampling on a new FreeRTOS task
+  @param[in] core [optional] Core to pin the task to, "tskNO_AFFINITY" to let FreeRTOS choose
+  @param[in] priority [optional] FreeRTOS priority of the task
+  @param[in] stackSize [optional] Stack size of the task in bytes, the callback runs on this stack
+  @return    "true" if the task was started, "false" if it was already running or couldn't be
+             created
+  */
+  if (running()) return false;
+  __atomic_store_n(&_run, true, __ATOMIC_RELEASE);
+  if (xTaskCreatePinnedToCore(task, "INA", stackSize, this, priority, &_task, core) != pdPASS) {
+    __atomic_store_n(&_run, false, __ATOMIC_RELEASE);
+    _task = nullptr;
+    return false;
+  }  // of if-then task not created
+  return true;
+}  // of method start()
+  #endif
+void INA_BackgroundSampler::stop() {
+  /*!
+  @brief     Stops sampling and waits for the task to end, callable from any other task
+  @details   The task finishes its current pass of run() first. Afterwards the INA_Class instance
+             can be used by other tasks again
+  */
+  __atomic_store_n(&_run, false, __ATOMIC_RELEASE);
+  #if defined(INA_LINUX)
+  if (_thread.joinable()) _thread.join();
+  #else
+  while (__atomic_load_n(&_task, __ATOMIC_ACQUIRE) != nullptr) vTaskDelay(1);
+  #endif
+}  // of method stop()
+bool INA_BackgroundSampler::running() const {
+  /*!
+  @brief     Returns whether the sampler's task is running
+  @return    "true" between start() and stop()
+  */
+  #if defined(INA_LINUX)
+  return _thread.joinable();
+  #else
+  return __atomic_load_n(&_task, __ATOMIC_ACQUIRE) != nullptr;
+  #endif
+}  // of method running()
+#endif
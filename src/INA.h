@@ -151,19 +151,69 @@ Written by Arnd <Arnd@Zanduino.Com> at https://www.github.com/SV-Zanshin
 | 1.0.0b  | 2018-06-17 | SV-Zanshin  | Continued coding, tested on INA219 and INA226
 | 1.0.0a  | 2018-06-10 | SV-Zanshin  | Initial coding began
 */
+#ifndef INA__Class_h
+/*! Guard code definition to prevent multiple includes */
+#define INA__Class_h
+#if !defined(ARDUINO) && defined(__linux__)
+  /*! Native Linux build using the i2c-dev interface, see "INA_LinuxI2C" */
+  #define INA_LINUX
+#endif
 #ifndef ARDUINO
 /*! Define macro if not defined yet */
 #define ARDUINO 0
 #endif
-#if ARDUINO >= 100 /* Use old library if IDE is prior to V1.0 */
+#if defined(INA_LINUX) /* Provide the few Arduino definitions the library uses */
+  #include <stdint.h>
+  #include <time.h>
+  #include <linux/i2c.h>
+  #include <linux/i2c-dev.h>
+  #ifndef bitRead
+    #define bitRead(value, bit) (((value) >> (bit)) & 0x01)     ///< Arduino bit read macro
+    #define bitSet(value, bit) ((value) |= (1UL << (bit)))      ///< Arduino bit set macro
+    #define bitClear(value, bit) ((value) &= ~(1UL << (bit)))  ///< Arduino bit clear macro
+  #endif
+  #define B111 7       ///< Arduino binary constant
+  #define B00000111 7  ///< Arduino binary constant
+inline uint32_t micros() {
+  /*! @brief  Arduino "micros()", microseconds from a monotonic clock wrapping at 32 bits */
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}  // of function micros()
+inline uint32_t millis() {
+  /*! @brief  Arduino "millis()", milliseconds from a monotonic clock wrapping at 32 bits */
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}  // of function millis()
+inline void delayMicroseconds(const uint32_t microseconds) {
+  /*! @brief  Arduino "delayMicroseconds()", sleeps for at least the given time */
+  struct timespec wait{(time_t)(microseconds / 1000000), (long)(microseconds % 1000000) * 1000};
+  nanosleep(&wait, nullptr);
+}  // of function delayMicroseconds()
+  #include <thread>  // Runs the INA_BackgroundSampler
+#elif ARDUINO >= 100 /* Use old library if IDE is prior to V1.0 */
   #include "Arduino.h"
 #else
   #include "WProgram.h"
 #endif
 
-#ifndef INA__Class_h
-/*! Guard code definition to prevent multiple includes */
-#define INA__Class_h
+#if !defined(INA_LINUX)
+  #include <Wire.h>  // I2C Library definition
+#endif
+#if defined(ESP32) || defined(INA_LINUX)
+  /*! The INA_BackgroundSampler can run as a FreeRTOS task or as a std::thread */
+  #define INA_BACKGROUND
+#endif
+#ifndef INA_MAX_BUSES
+  #if defined(__AVR__)
+    #define INA_MAX_BUSES 1  ///< Maximum number of I2C buses, see "INA_Class::addBus()"
+  #else
+    #define INA_MAX_BUSES 4  ///< Maximum number of I2C buses, see "INA_Class::addBus()"
+  #endif
+#endif
+/* Define INA_STATS, e.g. with "-DINA_STATS" in the compiler flags, to have the library count the
+   register accesses and time the calls of each device, see "inaStats" and INA_Class::readStats() */
 /*! typedef contains a packed bit-level defs of information stored per device */
 typedef struct {
   uint8_t  type : 4;           ///< 0-15        see enumerated "ina_Type" for details
@@ -171,19 +221,138 @@ typedef struct {
   uint32_t address : 7;        ///< 0-127       I2C Address of device
   uint32_t maxBusAmps : 10;    ///< 0-1023      Store initialization value
   uint32_t microOhmR : 20;     ///< 0-1,048,575 Store initialization value
+  uint32_t bus : 3;            ///< 0-7         Index of the I2C bus, see "INA_Class::addBus()"
 } inaEEPROM;                   // of structure
 /*! typedef contains a packed bit-level definition of information stored on a device */
 typedef struct inaDet : inaEEPROM {
   uint8_t  busVoltageRegister : 3;    ///< 0- 7, Bus Voltage Register
   uint8_t  shuntVoltageRegister : 3;  ///< 0- 7, Shunt Voltage Register
   uint8_t  currentRegister : 3;       ///< 0- 7, Current Register
+  uint8_t  shuntRange : 2;            ///< 0- 3, INA219 PGA or INA228 ADCRANGE, 0 the smallest
+  uint8_t  autoRange : 1;             ///< 0- 1, Range follows the readings, see setAutoRange()
   uint16_t shuntVoltage_LSB;          ///< Device dependent LSB factor
   uint16_t busVoltage_LSB;            ///< Device dependent LSB factor
   uint32_t current_LSB;               ///< Amperage LSB
   uint32_t power_LSB;                 ///< Wattage LSB
+  uint64_t currentMult;               ///< Precomputed multiplier for microamps
+  uint64_t powerMult;                 ///< Precomputed multiplier for microwatts
+  uint8_t  busVoltageMult;            ///< Precomputed multiplier for bus millivolts
+  uint8_t  busVoltageShift;           ///< Right shift applied after busVoltageMult
+  uint8_t  shuntVoltageMult;          ///< Precomputed multiplier for shunt microvolts
+  uint8_t  shuntVoltageShift;         ///< Right shift applied after shuntVoltageMult
+  uint8_t  currentShift;              ///< Right shift applied after currentMult
+  uint8_t  powerShift;                ///< Right shift applied after powerMult
   inaDet();                           ///< struct constructor
   inaDet(inaEEPROM& inaEE);           ///< for ina = inaEE; assignment
 } inaDet;                             // of structure
+/*! typedef contains one complete set of converted readings for a device, see readMeasurement() */
+typedef struct {
+  uint16_t busMilliVolts;    ///< Bus voltage in millivolts
+  int32_t  shuntMicroVolts;  ///< Shunt voltage in microvolts
+  int32_t  busMicroAmps;     ///< Bus current in microamps
+  int64_t  busMicroWatts;    ///< Bus power in microwatts
+  bool     rangeSwitch;      ///< Set when the reading may mix two shunt ranges, see setAutoRange()
+} inaMeasurement;            // of structure
+/*! typedef contains the register values of one reading of a device, see readRawSample() */
+typedef struct {
+  uint32_t micros;        ///< micros() when the registers were read
+  uint32_t busRaw;        ///< Bus voltage register, aligned as returned by getBusRaw()
+  int32_t  shuntRaw;      ///< Shunt voltage register, aligned and scaled as by getShuntRaw()
+  int32_t  currentRaw;    ///< Current register
+  uint32_t powerRaw;      ///< Power register
+  uint8_t  deviceNumber;  ///< Device the registers were read from
+  uint8_t  dropped;       ///< Samples an INA_SampleRing dropped just before this one, up to 255
+  bool     rangeSwitch;   ///< Set when the reading may mix two shunt ranges, see setAutoRange()
+} inaRawSample;           // of structure
+#if defined(__AVR__)
+typedef uint8_t inaSequence;  ///< INA_LatestTable counter, the only width an AVR reads atomically
+#else
+typedef uint32_t inaSequence;  ///< INA_LatestTable counter, too wide to wrap while a reader copies
+#endif
+/*! typedef contains the latest readings of a device in an INA_LatestTable */
+typedef struct {
+  inaMeasurement measurement;  ///< Latest complete set of readings
+  uint32_t       micros;       ///< micros() when the readings were taken
+  inaSequence    sequence;     ///< Odd while being written, 0 until first written
+} inaLatest;                   // of structure
+const uint8_t INA_LATEST_RETRIES{4};  ///< Default attempts of INA_LatestTable::read()
+/*! typedef contains the energy and charge a device has measured, see "INA_Class::readEnergy()".
+    Only complete readings, e.g. of readMeasurement() or readRawSample(), are accumulated */
+typedef struct {
+  int64_t  microJoules;       ///< Energy, the integral of the power readings
+  int64_t  microCoulombs;     ///< Charge, the integral of the current readings
+  uint64_t integratedMicros;  ///< Time covered since the accumulator was reset
+} inaEnergy;                  // of structure
+/*! typedef contains the state of a device's software energy and charge accumulator */
+typedef struct {
+  inaEnergy totals;           ///< Whole microjoules and microcoulombs accumulated
+  int32_t   energyRemainder;  ///< Picojoules (uW*us) not yet added to "totals", under 10^6
+  int32_t   chargeRemainder;  ///< Picocoulombs (uA*us) not yet added to "totals", under 10^6
+  uint32_t  lastMicros;       ///< micros() of the last reading or of the reset
+  bool      enabled;          ///< Set by "resetEnergy()" for the device
+} inaAccumulator;             // of structure
+/*! typedef contains the state of a device's automatic shunt range, see "setAutoRange()" */
+typedef struct {
+  uint32_t switchMicros;  ///< micros() of the last range switch
+  uint32_t settleMicros;  ///< Time after the switch until the first reading in the new range
+  uint8_t  quietSamples;  ///< Consecutive readings which would fit the next smaller range
+  uint32_t peakLevel;     ///< Largest absolute shunt reading of those readings
+  bool     settling;      ///< Set from a switch until a reading after "settleMicros"
+} inaRangeState;          // of structure
+const uint8_t INA_RANGE_SAMPLES{8};  ///< Readings which must fit a smaller range to switch down
+/*! Function called by an INA_BackgroundSampler with each new reading */
+typedef void (*inaSampleCallback)(const uint8_t deviceNumber, const inaMeasurement& measurement,
+                                  const uint32_t readMicros);
+/*! typedef contains the schedule of a device in an INA_BackgroundSampler */
+typedef struct {
+  uint32_t periodMicros;  ///< Time between readings, 0 when the device isn't sampled
+  uint32_t costMicros;    ///< Bus time of one reading when the period was set
+  uint32_t dueMicros;     ///< micros() when the next reading is due, its deadline is a period later
+  uint32_t readings;      ///< Readings taken since the statistics were reset
+  uint32_t missed;        ///< Deadlines missed since the statistics were reset
+  uint32_t statsMicros;   ///< micros() when the statistics were reset
+  bool     resetPending;  ///< Set by readScheduleStats() for run() to reset the statistics
+  bool     taken;         ///< Set by run() when it has read the device in the current call
+} inaSchedule;            // of structure
+/*! typedef contains the statistics of a device returned by INA_BackgroundSampler */
+typedef struct {
+  uint32_t readings;    ///< Readings taken
+  uint32_t missed;      ///< Readings modelled to finish after their deadline, or skipped
+  uint32_t milliHertz;  ///< Rate achieved, in readings per 1000 seconds
+} inaScheduleStats;     // of structure
+const uint32_t INA_BACKGROUND_IDLE_MICROS{10000};  ///< Longest wait of the background sampler
+const uint8_t  INA_SCHEDULE_UTILIZATION{90};       ///< Percent of the bus time a schedule may use
+#ifndef INA_RING_SIZE
+  #define INA_RING_SIZE 16  ///< Entries in an INA_SampleRing, a power of 2 up to 128
+#endif
+static_assert(INA_RING_SIZE > 0 && (INA_RING_SIZE & (INA_RING_SIZE - 1)) == 0 &&
+                  INA_RING_SIZE <= 128,
+              "INA_RING_SIZE has to be a power of 2 up to 128 for the ring's uint8_t indices");
+/*! Enumerated list of the states a device goes through in the "INA_Sampler" class */
+enum ina_SampleState {
+  INA_SAMPLE_TRIGGER,  ///< Start a conversion, nothing to do in continuous mode
+  INA_SAMPLE_WAIT,     ///< Waiting for the conversion ready flag
+  INA_SAMPLE_COLLECT   ///< Conversion finished, read the registers
+};                     // of enumerated type
+/*! typedef contains the sampling state and the last readings of a device, see "INA_Sampler" */
+typedef struct {
+  inaMeasurement measurement;  ///< Last complete set of readings
+  uint8_t        state;        ///< see enumerated "ina_SampleState" for details
+  bool           available;    ///< Set when "measurement" has not yet been read
+} inaSample;                   // of structure
+/*! typedef contains the last readings of a device on an ALERT line, see "INA_AlertSampler" */
+typedef struct {
+  inaMeasurement measurement;  ///< Last complete set of readings
+  uint32_t       alertMicros;  ///< micros() when the ALERT edge reporting "measurement" came in
+  bool           onLine;       ///< Set when the device's ALERT pin is on the sampler's line
+  bool           available;    ///< Set when "measurement" has not yet been read
+} inaAlertSample;              // of structure
+const uint8_t INA_ALERT_QUEUE_SIZE{8};  ///< ALERT edges an INA_AlertSampler holds, a power of 2
+#if defined(IRAM_ATTR)
+  #define INA_ISR_ATTR IRAM_ATTR  ///< ESP32 and ESP8266 interrupt code has to be in RAM
+#else
+  #define INA_ISR_ATTR  ///< Other platforms need no attribute for interrupt code
+#endif
 /*! Enumerated list detailing the names of all supported INA devices. The INA3221 is stored
     as 3 distinct devices each with their own enumerated type. */
 enum ina_Type {
@@ -225,6 +394,7 @@ const uint8_t  INA_POWER_REGISTER{3};               ///< Power Register address
 const uint8_t  INA_CALIBRATION_REGISTER{5};         ///< Calibration Register address
 const uint8_t  INA_MASK_ENABLE_REGISTER{6};         ///< Mask enable Register (some devices)
 const uint8_t  INA_ALERT_LIMIT_REGISTER{7};         ///< Alert Limit Register (some devices)
+const uint8_t  INA_ALERT_RESPONSE_ADDRESS{0x0C};    ///< SMBus Alert Response Address
 const uint8_t  INA_MANUFACTURER_ID_REGISTER{0xFE};  ///< Mfgr ID Register (some devices)
 const uint8_t  INA_DIE_ID_REGISTER{0xFF};           ///< Die ID Register (some devices)
 const uint16_t INA_RESET_DEVICE{0x8000};            ///< Write to config to reset device
@@ -237,6 +407,8 @@ const uint8_t  INA_ALERT_BUS_OVER_VOLT_BIT{13};     ///< Register bit
 const uint8_t  INA_ALERT_BUS_UNDER_VOLT_BIT{12};    ///< Register bit
 const uint8_t  INA_ALERT_POWER_OVER_WATT_BIT{11};   ///< Register bit
 const uint8_t  INA_ALERT_CONVERSION_RDY_BIT{10};    ///< Register bit
+const uint16_t INA_ALERT_FUNCTION_FLAG{0x0010};     ///< Mask register bit 4, alert limit exceeded
+const uint16_t INA_CONVERSION_READY_FLAG{0x0008};   ///< Mask register bit 3, conversion ready
 const uint8_t  INA_DEFAULT_OPERATING_MODE{B111};    ///< Default continuous mode
 const uint8_t  INA219_SHUNT_VOLTAGE_REGISTER{1};    ///< INA219 Shunt Voltage Register
 const uint8_t  INA219_CURRENT_REGISTER{4};          ///< INA219 Current Register
@@ -260,26 +432,158 @@ const uint16_t INA226_CONFIG_SADC_MASK{0x0038};     ///< INA226 Bits 3-4
 const uint8_t  INA228_DIE_ID_REGISTER{0x3F};        ///< INA228 Device_ID  Register
 const uint16_t INA228_DIE_ID_VALUE{0x2280};         ///< INA228 Hard-coded Die ID for INA228
 const uint8_t  INA228_BUS_VOLTAGE_REGISTER{0x5};    ///< INA228 Bus Voltage Register
+const uint8_t  INA228_DIAG_ALERT_REGISTER{0xB};     ///< INA228 Diagnostic flags and alert
+const uint16_t INA228_ALERT_FLAGS{0x0EFC};          ///< INA228 Limit and overflow flags
+const uint16_t INA228_ALERT_CONVERSION{0x4000};     ///< INA228 Alert on conversion ready
+const uint16_t INA228_CONVERSION_READY_FLAG{0x0002};  ///< INA228 Conversion ready flag
 const uint16_t INA228_BUS_VOLTAGE_LSB{195};           ///< INA228 LSB in uV *100 1953125uV, extra code
 const uint8_t  INA228_SHUNT_VOLTAGE_REGISTER{4};    ///< INA228 Shunt Voltage Register
-const uint8_t  xINA228_CURRENT_REGISTER{4};          ///< INA228 Current Register
-const uint16_t xINA228_CONFIG_AVG_MASK{0x0E00};      ///< INA228 Bits 9-11
-const uint16_t xINA228_CONFIG_BADC_MASK{0x01C0};     ///< INA228 Bits 6-8 masked
-const uint16_t xINA228_CONFIG_SADC_MASK{0x0038};     ///< INA228 Bits 3-4
+const uint8_t  INA228_ADC_CONFIG_REGISTER{0x1};     ///< INA228 Mode, conversion times, averages
+const uint8_t  INA228_SHUNT_CAL_REGISTER{0x2};      ///< INA228 Shunt calibration Register
+const uint8_t  INA228_DIE_TEMP_REGISTER{0x6};       ///< INA228 Die temperature Register
+const uint8_t  INA228_CURRENT_REGISTER{0x7};        ///< INA228 Current Register
+const uint8_t  INA228_POWER_REGISTER{0x8};          ///< INA228 Power Register
+const uint8_t  INA228_ENERGY_REGISTER{0x9};         ///< INA228 40-bit Energy Register
+const uint8_t  INA228_CHARGE_REGISTER{0xA};         ///< INA228 40-bit Charge Register
+const uint8_t  INA228_CONFIG_ADCRANGE_BIT{4};       ///< INA228 +-40.96mV shunt range when set
+const uint16_t INA228_CONFIG_RSTACC{0x4000};        ///< INA228 Reset energy and charge
+const uint16_t INA228_ADCRANGE_MICROVOLTS{40960};   ///< INA228 Full scale of the low shunt range
+const uint16_t INA228_SHUNT_CAL_MAX{0x7FFF};        ///< INA228 15-bit shunt calibration
+const uint16_t INA228_CONFIG_MODE_MASK{0xF000};     ///< INA228 Bits 12-15 of ADC_CONFIG
+const uint16_t INA228_CONFIG_AVG_MASK{0x0007};      ///< INA228 Bits 0-2 of ADC_CONFIG
+const uint16_t INA228_CONFIG_BADC_MASK{0x0E00};     ///< INA228 Bits 9-11 of ADC_CONFIG
+const uint16_t INA228_CONFIG_SADC_MASK{0x01C0};     ///< INA228 Bits 6-8 of ADC_CONFIG
+const uint16_t INA228_CONFIG_TADC_MASK{0x0038};     ///< INA228 Bits 3-5 of ADC_CONFIG
 
 const uint8_t  INA260_SHUNT_VOLTAGE_REGISTER{0};    ///< INA260 Register doesn't exist
 const uint8_t  INA260_CURRENT_REGISTER{1};          ///< INA260 Current Register
 const uint16_t INA260_BUS_VOLTAGE_LSB{125};         ///< INA260 LSB in uV *100 1.25mV
 const uint16_t INA260_CONFIG_BADC_MASK{0x01C0};     ///< INA260 Bits 6-8  masked
 const uint16_t INA260_CONFIG_SADC_MASK{0x0038};     ///< INA260 Bits 3-5  masked
+const uint16_t INA260_DIE_ID_VALUE{0x2270};         ///< INA260 Hard-coded Die ID
 const uint8_t  INA3221_SHUNT_VOLTAGE_REGISTER{1};   ///< INA3221 Register number 1
 const uint16_t INA3221_BUS_VOLTAGE_LSB{800};        ///< INA3221 LSB in uV *100 8mV
 const uint16_t INA3221_SHUNT_VOLTAGE_LSB{400};      ///< INA3221 LSB in uV *10  40uV
 const uint16_t INA3221_CONFIG_BADC_MASK{0x01C0};    ///< INA3221 Bits 7-10  masked
+const uint16_t INA3221_DIE_ID_VALUE{0x3220};        ///< INA3221 Hard-coded Die ID
 const uint8_t  INA3221_MASK_REGISTER{0xF};          ///< INA32219 Mask register
+const uint16_t INA3221_ALERT_FLAGS{0x03F8};         ///< INA3221 Critical, sum and warning flags
+const uint8_t  INA3221_CRITICAL_REGISTER{0x7};      ///< INA3221 Channel 1 critical limit, +2 each
+const uint8_t  INA3221_WARNING_REGISTER{0x8};       ///< INA3221 Channel 1 warning limit, +2 each
+const uint8_t  INA3221_SUM_REGISTER{0xD};           ///< INA3221 Shunt-voltage sum
+const uint8_t  INA3221_SUM_LIMIT_REGISTER{0xE};     ///< INA3221 Shunt-voltage sum limit
+const uint8_t  INA3221_VALID_UPPER_REGISTER{0x10};  ///< INA3221 Power-valid upper limit
+const uint8_t  INA3221_VALID_LOWER_REGISTER{0x11};  ///< INA3221 Power-valid lower limit
+const uint8_t  INA3221_SUM_CONTROL_BIT{14};         ///< INA3221 Channel 1 summation bit, -1 each
+const uint16_t INA3221_POWER_VALID_FLAG{0x0004};    ///< INA3221 All bus voltages above the limit
+const uint16_t INA3221_LIMIT_DISABLED{0x7FF8};      ///< INA3221 Channel limit reset value
+const uint16_t INA3221_SUM_LIMIT_DISABLED{0x7FFE};  ///< INA3221 Sum limit reset value
 const uint8_t  I2C_DELAY{10};                       ///< Microsecond delay on I2C writes
 // clang-format on
 
+class INA_Transport {
+  /*!
+   * @class   INA_Transport
+   * @brief   Interface to one I2C bus used by the INA_Class
+   * @details Each call is one complete I2C transaction. Derive from this class to use buses other
+   *          than the "TwoWire" objects supported by "INA_TwoWire"
+   */
+ public:
+  virtual ~INA_Transport() {}
+  virtual void    begin()                             = 0;  ///< Initialize the bus
+  virtual void    setClock(const uint32_t clockSpeed) = 0;  ///< Set the bus speed in Herz
+  virtual uint8_t write(const uint8_t deviceAddress, const uint8_t* data,
+                        const uint8_t length) = 0;  ///< Write bytes, returns 0 on success
+  virtual uint8_t read(const uint8_t deviceAddress, uint8_t* data,
+                       const uint8_t length) = 0;  ///< Read bytes, returns number read
+  virtual uint8_t readRegister(const uint8_t deviceAddress, const uint8_t reg, uint8_t* data,
+                               const uint8_t length);
+};  // of INA_Transport definition
+#if defined(INA_LINUX)
+class INA_LinuxI2C : public INA_Transport {
+  /*!
+   * @class   INA_LinuxI2C
+   * @brief   INA_Transport for the Linux i2c-dev interface, e.g. "/dev/i2c-1"
+   * @details All transfers are made with the I2C_RDWR ioctl(), so register reads are a single
+   *          combined write and read transaction. The adapter must support plain I2C transfers,
+   *          SMBus-only adapters such as the "i2c-stub" module don't. Derived classes can
+   *          override transfer() to run against a simulated bus
+   */
+ public:
+  INA_LinuxI2C(const uint8_t adapter);
+  INA_LinuxI2C(const char* device);
+  ~INA_LinuxI2C();
+  void    begin();
+  void    setClock(const uint32_t clockSpeed);
+  uint8_t write(const uint8_t deviceAddress, const uint8_t* data, const uint8_t length);
+  uint8_t read(const uint8_t deviceAddress, uint8_t* data, const uint8_t length);
+  uint8_t readRegister(const uint8_t deviceAddress, const uint8_t reg, uint8_t* data,
+                       const uint8_t length);
+
+ protected:
+  virtual int transfer(struct i2c_msg* messages, const uint8_t count);
+
+ private:
+  char _device[32];  ///< Path of the device file
+  int  _fd{-1};      ///< File descriptor of the open device file
+};  // of INA_LinuxI2C definition
+#else
+class INA_TwoWire : public INA_Transport {
+  /*!
+   * @class   INA_TwoWire
+   * @brief   INA_Transport for the Arduino "TwoWire" objects, e.g. "Wire" and "Wire1"
+   */
+ public:
+  INA_TwoWire(TwoWire& wire = Wire);
+  void    begin();
+  void    setClock(const uint32_t clockSpeed);
+  uint8_t write(const uint8_t deviceAddress, const uint8_t* data, const uint8_t length);
+  uint8_t read(const uint8_t deviceAddress, uint8_t* data, const uint8_t length);
+
+ private:
+  TwoWire& _wire;  ///< Bus used for all transactions
+};  // of INA_TwoWire definition
+#endif
+/*! typedef contains the state the library keeps for each I2C bus */
+typedef struct {
+  INA_Transport* transport;             ///< Transport used for the bus
+  uint8_t        registerPointer[16];   ///< Last register pointer for devices 0x40-0x4F
+  uint16_t       registerPointerValid;  ///< Bit set when registerPointer entry is known
+  uint16_t       configShadow[16];      ///< Configuration registers for devices 0x40-0x4F
+  uint16_t       configShadowValid;     ///< Bit set when configShadow entry is known
+  uint16_t       sweepPending;          ///< Bit set while a sweep waits for the address
+  uint16_t       offline;               ///< Bit set when a known device stopped answering
+  uint16_t       foreign;               ///< Bit set when a device isn't an INA, see rescan()
+  uint32_t       clockSpeed;            ///< Speed set by setI2CSpeed(), 0 for the default
+  uint32_t       conversionStart[16];   ///< micros() when the conversion of 0x40-0x4F started
+#if defined(INA_STATS)
+  uint8_t statsDevice[16];  ///< Device number counting the accesses to 0x40-0x4F, see "inaStats"
+#endif
+} inaBus;  // of structure
+#if defined(INA_STATS)
+const uint8_t INA_STATS_BUCKETS{16};  ///< Histogram bucket n counts 2^(n-1) to 2^n-1 microseconds
+/*! Enumerated list of the groups of public methods timed in the "inaStats" latency histograms */
+enum ina_StatsApi {
+  INA_STATS_READ,         ///< getBus...() and getShunt...() methods
+  INA_STATS_MEASUREMENT,  ///< readMeasurement() and readRawSample()
+  INA_STATS_CONFIGURE,    ///< reset(), setMode(), setAveraging(), set...Conversion(), configure()
+                          ///< and alertOn...() methods
+  INA_STATS_WAIT,         ///< conversionFinished() and waitForConversion()
+  INA_STATS_APIS          ///< Number of groups
+};                        // of enumerated type
+/*! typedef contains the statistics the library keeps for each device when INA_STATS is defined.
+    The register counts of the 3 INA3221 channels are all kept with the first channel. The
+    histogram counts stop at their maximum value */
+typedef struct {
+  uint32_t registerReads;   ///< Registers read
+  uint32_t registerWrites;  ///< Registers written
+  uint16_t naks;            ///< Transactions the device didn't acknowledge
+  uint16_t shortReads;      ///< Reads returning fewer bytes than requested
+  uint16_t eepromReads;     ///< Device structure loaded from EEPROM, see readInafromEEPROM()
+  uint32_t waitMicros;      ///< Time spent in the INA_STATS_WAIT methods
+  uint16_t latency[INA_STATS_APIS][INA_STATS_BUCKETS];  ///< Call duration histogram per group
+} inaStats;                                              // of structure
+#endif
 class INA_Class {
   /*!
    * @class   INA_Class
@@ -288,21 +592,52 @@ class INA_Class {
  public:
   INA_Class(uint8_t expectedDevices = 0);
   ~INA_Class();
+  uint8_t     addBus(INA_Transport& transport);
   uint8_t     begin(const uint16_t maxBusAmps, const uint32_t microOhmR,
                     const uint8_t deviceNumber = UINT8_MAX);
+  uint8_t     beginFromStored(const uint16_t maxBusAmps, const uint32_t microOhmR);
+  uint8_t     rescan(const uint16_t maxBusAmps, const uint32_t microOhmR);
+  bool        isOnline(const uint8_t deviceNumber = 0) const;
   void        setI2CSpeed(const uint32_t i2cSpeed = INA_I2C_STANDARD_MODE) const;
   void        setMode(const uint8_t mode, const uint8_t deviceNumber = UINT8_MAX);
   void        setAveraging(const uint16_t averages, const uint8_t deviceNumber = UINT8_MAX);
   void        setBusConversion(const uint32_t convTime, const uint8_t deviceNumber = UINT8_MAX);
   void        setShuntConversion(const uint32_t convTime, const uint8_t deviceNumber = UINT8_MAX);
+  void        configure(const uint8_t mode, const uint16_t averages, const uint32_t busConv,
+                        const uint32_t shuntConv, const uint8_t deviceNumber = UINT8_MAX);
   uint16_t    getBusMilliVolts(const uint8_t deviceNumber = 0);
   uint32_t    getBusRaw(const uint8_t deviceNumber = 0);
   int32_t     getShuntMicroVolts(const uint8_t deviceNumber = 0);
   int32_t     getShuntRaw(const uint8_t deviceNumber = 0);
   int32_t     getBusMicroAmps(const uint8_t deviceNumber = 0);
   int64_t     getBusMicroWatts(const uint8_t deviceNumber = 0);
+  bool        readMeasurement(inaMeasurement& measurement, const uint8_t deviceNumber = 0);
+  bool        readRawSample(inaRawSample& sample, const uint8_t deviceNumber = 0);
+  bool        convertSample(const inaRawSample& sample, inaMeasurement& measurement) const;
+  void        startSweep(const uint8_t bus = UINT8_MAX);
+  bool        sweepFinished(const uint8_t bus = UINT8_MAX);
+  uint8_t     readSweep(inaMeasurement measurements[], const uint8_t bus = UINT8_MAX);
+  uint8_t     sweep(inaMeasurement measurements[], const uint8_t bus = UINT8_MAX);
   const char* getDeviceName(const uint8_t deviceNumber = 0);
   uint8_t     getDeviceAddress(const uint8_t deviceNumber = 0);
+  uint8_t     getDeviceBus(const uint8_t deviceNumber = 0);
+  uint32_t    getI2CSpeed(const uint8_t bus = 0) const;
+  uint32_t    getReadMicros(const uint8_t deviceNumber = 0) const;
+  uint32_t    getConversionMicros(const uint8_t deviceNumber = 0) const;
+  uint32_t    getConversionDue(const uint8_t deviceNumber = 0) const;
+  uint8_t     getAlertingDevice(const uint8_t bus = 0, uint16_t* flags = nullptr);
+  bool        readEnergy(inaEnergy& energy, const uint8_t deviceNumber = 0, const bool reset = false);
+  void        resetEnergy(const uint8_t deviceNumber = UINT8_MAX);
+  int64_t     getEnergyMicroJoules(const uint8_t deviceNumber = 0);
+  int64_t     getChargeMicroCoulombs(const uint8_t deviceNumber = 0);
+  int32_t     getDieMilliCelsius(const uint8_t deviceNumber = 0);
+  void        resetAccumulators(const uint8_t deviceNumber = UINT8_MAX);
+  bool        setAutoRange(const bool enabled, const uint8_t deviceNumber = UINT8_MAX);
+  uint8_t     getShuntRange(const uint8_t deviceNumber = 0) const;
+  #if defined(INA_STATS)
+  bool        readStats(inaStats& stats, const uint8_t deviceNumber, const bool reset = false);
+  void        resetStats(const uint8_t deviceNumber = UINT8_MAX);
+  #endif
   void        reset(const uint8_t deviceNumber = 0);
   bool        conversionFinished(const uint8_t deviceNumber = 0);
   void        waitForConversion(const uint8_t deviceNumber = UINT8_MAX);
@@ -317,22 +652,101 @@ class INA_Class {
                                      const uint8_t deviceNumber = UINT8_MAX);
   bool        alertOnPowerOverLimit(const bool alertState, const int32_t milliAmps,
                                     const uint8_t deviceNumber = UINT8_MAX);
+  uint8_t     readChannels(inaMeasurement measurements[], const uint8_t deviceNumber = 0);
+  bool        setShuntSum(const bool included, const uint8_t deviceNumber = UINT8_MAX);
+  int32_t     getShuntSumMicroVolts(const uint8_t deviceNumber = 0);
+  int32_t     getSumMicroAmps(const uint8_t deviceNumber = 0);
+  bool        alertOnShuntSum(const bool alertState, const int32_t microVolts,
+                              const uint8_t deviceNumber = UINT8_MAX);
+  bool        alertOnChannelCritical(const bool alertState, const int32_t microVolts,
+                                     const uint8_t deviceNumber = UINT8_MAX);
+  bool        alertOnChannelWarning(const bool alertState, const int32_t microVolts,
+                                    const uint8_t deviceNumber = UINT8_MAX);
+  bool        setPowerValidLimits(const uint16_t upperMilliVolts, const uint16_t lowerMilliVolts,
+                                  const uint8_t deviceNumber = UINT8_MAX);
+  bool        getPowerValid(const uint8_t deviceNumber = 0);
   uint16_t    _EEPROM_offset = 0;  ///< Offset to all EEPROM addresses, GitHub issue #41
   #if defined(ESP32) || defined(ESP8266)
   uint16_t _EEPROM_size = 512;  ///< Default EEPROM reserved space for ESP32 and ESP8266
   #endif
  private:
-  int16_t    readWord(const uint8_t addr, const uint8_t deviceAddress) const;
-  int32_t    read3Bytes(const uint8_t addr, const uint8_t deviceAddress) const;
-  void       writeWord(const uint8_t addr, const uint16_t data, const uint8_t deviceAddress) const;
-  void       readInafromEEPROM(const uint8_t deviceNumber);
+  friend class INA_Sampler;  ///< Sampler drives the devices directly through the private methods
+  friend class INA_AlertSampler;  ///< Reads the conversion ready flags of the devices it samples
+  friend class INA_LatestTable;   ///< Sizes its table from the number of devices found
+  friend class INA_BackgroundSampler;  ///< Sizes its schedule from the number of devices found
+  bool       readRegister(const uint8_t addr, const uint8_t deviceAddress, const uint8_t bus,
+                          uint8_t* data, const uint8_t length) const;
+  void       invalidateRegisterPointer(const uint8_t deviceAddress, const uint8_t bus) const;
+  void       invalidateConfigShadow(const uint8_t deviceAddress, const uint8_t bus) const;
+  uint16_t   readConfigRegister(const uint8_t deviceAddress, const uint8_t bus) const;
+  uint16_t   readSettings(const inaDet& device) const;
+  void       writeSettings(const inaDet& device, const uint16_t settings) const;
+  uint16_t   applyMode(const uint8_t type, uint16_t configRegister, const uint8_t mode) const;
+  uint16_t   applyBusConversion(const uint8_t type, uint16_t configRegister,
+                                const uint32_t convTime) const;
+  uint16_t   applyShuntConversion(const uint8_t type, uint16_t configRegister,
+                                  const uint32_t convTime) const;
+  uint16_t   applyAveraging(const uint8_t type, uint16_t configRegister,
+                            const uint16_t averages) const;
+  int16_t    readWord(const uint8_t addr, const uint8_t deviceAddress, const uint8_t bus) const;
+  int32_t    read3Bytes(const uint8_t addr, const uint8_t deviceAddress, const uint8_t bus) const;
+  uint64_t   read5Bytes(const uint8_t addr, const uint8_t deviceAddress, const uint8_t bus) const;
+  void       writeWord(const uint8_t addr, const uint16_t data, const uint8_t deviceAddress,
+                       const uint8_t bus) const;
+  uint8_t    identifyDevice(const uint8_t deviceAddress, const uint8_t bus);
+  bool       probeDevice(const uint8_t deviceAddress, const uint8_t bus, bool& answered) const;
+  bool       verifyDevice(const inaEEPROM& device) const;
+  uint8_t    storageCapacity();
+  void       startBuses();
+  bool       growDeviceTable(const uint8_t deviceCount);
+  void       readInafromEEPROM(const uint8_t deviceNumber) const;
   void       writeInatoEEPROM(const uint8_t deviceNumber);
+  void       writeEndMarker(const uint8_t deviceNumber);
+  void       buildDeviceTable();
+  void       selectDevice(const uint8_t deviceNumber);
+  const inaDet& entry(const uint8_t deviceNumber) const;
   void       initDevice(const uint8_t deviceNumber);
+  uint32_t   readBusRegister(const inaDet& device) const;
+  int32_t    readShuntRegister(const inaDet& device) const;
+  int32_t    readCurrentRegister(const inaDet& device) const;
+  uint32_t   readPowerRegister(const inaDet& device) const;
+  void       triggerConversion(const inaDet& device) const;
+  bool       readConversionReady(const inaDet& device) const;
+  uint32_t   conversionMicros(const inaDet& device) const;
+  uint32_t   conversionDue(const inaDet& device) const;
+  void       readDevice(const uint8_t deviceNumber, inaMeasurement& measurement);
+  void       readRawDevice(const uint8_t deviceNumber, inaRawSample& sample);
+  void       convertRawDevice(const uint8_t deviceNumber, const inaRawSample& sample,
+                              inaMeasurement& measurement) const;
+  void       accumulate(const uint8_t deviceNumber, const inaRawSample& sample);
+  uint16_t   rangeCalibration(const inaDet& device) const;
+  void       writeRange(const inaDet& device) const;
+  void       checkRange(const uint8_t deviceNumber, inaRawSample& sample);
+  bool       writeChannelLimit(const uint8_t limitRegister, const bool alertState,
+                               const int32_t microVolts, const uint8_t deviceNumber);
+  inaAccumulator* _energy{nullptr};  ///< Dynamic array with the accumulators, see resetEnergy()
+  inaRangeState*  _range{nullptr};   ///< Dynamic array with the range states, see setAutoRange()
+  #if defined(INA_STATS)
+  friend class inaStatsTimer;  ///< Times the public methods for recordLatency()
+  inaStats*  deviceStats(const uint8_t deviceAddress, const uint8_t bus) const;
+  void       recordLatency(const uint8_t deviceNumber, const uint8_t api,
+                        const uint32_t elapsedMicros);
+  inaStats*  _stats{nullptr};  ///< Dynamic array with the statistics of each device
+  uint8_t    _statsDepth{0};   ///< Number of timed public methods currently running
+  #endif
   uint8_t    _DeviceCount{0};         ///< Total number of devices detected
   uint8_t    _currentINA{UINT8_MAX};  ///< Stores current INA device number
   uint8_t    _expectedDevices{0};     ///< If 0 use EEPROM, otherwise use RAM for INA structures
   inaEEPROM* _DeviceArray;            ///< Pointer to dynamic array of devices if not using EEPROM
-  inaEEPROM  inaEE;                   ///< INA device structure
+  inaDet*    _DeviceTable{nullptr};   ///< Resident table of fully computed device structures
+  mutable inaDet  _storedEntry;              ///< Entry used without the table, see entry()
+  mutable uint8_t _storedNumber{UINT8_MAX};  ///< Device number of _storedEntry
+  uint8_t    _busCount{0};            ///< Number of buses added, see addBus()
+  mutable inaBus _bus[INA_MAX_BUSES]{};  ///< State of each bus
+  #if !defined(INA_LINUX)
+  INA_TwoWire _defaultBus;  ///< Transport for "Wire" when no buses are added
+  #endif
+  mutable inaEEPROM inaEE;            ///< INA device structure, also loaded by entry()
   inaDet     ina;                     ///< INA device structure
   #if defined(__AVR__) || defined(CORE_TEENSY) || defined(ESP32) || defined(ESP8266) || \
       defined(__STM32F1__)
@@ -340,4 +754,171 @@ class INA_Class {
   inaEEPROM _EEPROMEmulation[32];  ///< Actual array of up to 32 devices
   #endif
 };  // of INA_Class definition
+class INA_Sampler {
+  /*!
+   * @class   INA_Sampler
+   * @brief   Non-blocking sampling of all devices of an INA_Class instance
+   * @details Each device is advanced through the trigger, wait and collect states of
+   *          "ina_SampleState" by repeated calls to poll(), which never waits for a conversion to
+   *          finish. All devices therefore convert at the same time and the program can do other
+   *          work in between. Completed readings are retrieved with read()
+   */
+ public:
+  INA_Sampler(INA_Class& ina);
+  ~INA_Sampler();
+  uint8_t begin();
+  uint8_t poll();
+  bool    available(const uint8_t deviceNumber) const;
+  bool    read(inaMeasurement& measurement, const uint8_t deviceNumber);
+
+ private:
+  INA_Class& _ina;                ///< Instance owning the devices
+  uint8_t    _deviceCount{0};     ///< Number of devices being sampled
+  inaSample* _samples{nullptr};   ///< Dynamic array with the state of each device
+};  // of INA_Sampler definition
+class INA_AlertSampler {
+  /*!
+   * @class   INA_AlertSampler
+   * @brief   Interrupt-driven sampling of the devices sharing one ALERT line
+   * @details The devices are set to pull their ALERT pin low when a conversion finishes. The
+   *          program's interrupt handler for the falling edge of the line only calls alertISR(),
+   *          which stores the time of the edge in a lock-free single producer, single consumer
+   *          queue and returns. All I2C transfers are made later by service(), called from loop()
+   *          or a task, which reads the conversion ready flags of the devices on the line and the
+   *          registers of those which have finished. Devices on different ALERT lines are handled
+   *          by one INA_AlertSampler for each line
+   */
+ public:
+  INA_AlertSampler(INA_Class& ina);
+  ~INA_AlertSampler();
+  uint8_t begin(const uint8_t deviceNumber = UINT8_MAX);
+  bool    addDevice(const uint8_t deviceNumber);
+  void    alertISR();
+  uint8_t service();
+  bool    available(const uint8_t deviceNumber) const;
+  bool    read(inaMeasurement& measurement, const uint8_t deviceNumber,
+               uint32_t* alertMicros = nullptr);
+  uint8_t getOverruns() const;
+
+ private:
+  uint8_t         scanLine(const uint32_t alertMicros);
+  INA_Class&      _ina;                           ///< Instance owning the devices
+  uint8_t         _deviceCount{0};                ///< Number of entries in _samples
+  inaAlertSample* _samples{nullptr};              ///< Dynamic array with the state of each device
+  uint32_t        _queue[INA_ALERT_QUEUE_SIZE]{};  ///< micros() of each ALERT edge not serviced
+  uint8_t         _head{0};      ///< Next queue entry, only changed by alertISR()
+  uint8_t         _tail{0};      ///< Oldest queue entry, only changed by service()
+  uint8_t         _overruns{0};  ///< ALERT edges which found the queue full, stops at 255
+  bool            _rescan{false};  ///< Set when the line may still be held low by a device
+};  // of INA_AlertSampler definition
+class INA_SampleRing {
+  /*!
+   * @class   INA_SampleRing
+   * @brief   Lock-free ring buffer passing raw samples from one producer to one consumer
+   * @details The producer, e.g. a task sampling the devices on one ESP32 core, adds samples with
+   *          push() while the consumer, e.g. a logging task on the other core or loop() with an
+   *          interrupt as the producer, takes them out in batches with drain(). Each side only
+   *          writes its own index, which is published with release and read with acquire
+   *          ordering, so no locks or critical sections are needed. The ring holds up to
+   *          INA_RING_SIZE - 1 samples and uses no dynamic memory. When it is full the new sample
+   *          is dropped, the count is passed to the consumer in the "dropped" field of the next
+   *          sample added and totalled by getOverruns()
+   */
+ public:
+  bool     push(const inaRawSample& sample);
+  bool     full() const;
+  uint8_t  drain(inaRawSample samples[], const uint8_t maxSamples);
+  uint8_t  available() const;
+  uint32_t getOverruns() const;
+
+ private:
+  inaRawSample _ring[INA_RING_SIZE];  ///< Samples, written by push() and read by drain()
+  uint8_t      _head{0};              ///< Next entry, only changed by push()
+  uint8_t      _tail{0};              ///< Oldest entry, only changed by drain()
+  uint16_t     _dropped{0};           ///< Samples dropped since the last push(), producer only
+  uint32_t     _overruns{0};          ///< Dropped samples reported to drain(), consumer only
+};  // of INA_SampleRing definition
+class INA_LatestTable {
+  /*!
+   * @class   INA_LatestTable
+   * @brief   Table of the latest readings of each device, readable without locks or I2C traffic
+   * @details One writer, e.g. the loop or task sampling the devices, stores each new reading
+   *          with update() or publish(). Any number of readers in other tasks or interrupts get
+   *          the latest reading of a device with read(), which only copies it from memory. Each
+   *          entry is protected by a sequence counter which is odd while the entry is being
+   *          written, a reader retries when the counter was odd or changed during its copy. The
+   *          retries are limited, so an interrupt which preempted the writer in the middle of an
+   *          entry gets "false" instead of waiting forever
+   */
+ public:
+  INA_LatestTable(INA_Class& ina);
+  ~INA_LatestTable();
+  uint8_t begin();
+  bool    update(const uint8_t deviceNumber);
+  bool    publish(const uint8_t deviceNumber, const inaMeasurement& measurement,
+                  const uint32_t readMicros);
+  bool    read(inaMeasurement& measurement, const uint8_t deviceNumber,
+               uint32_t* readMicros = nullptr, const uint8_t retries = INA_LATEST_RETRIES) const;
+
+ private:
+  INA_Class& _ina;               ///< Instance owning the devices
+  uint8_t    _deviceCount{0};    ///< Number of entries in _latest
+  inaLatest* _latest{nullptr};   ///< Dynamic array with the entry of each device
+};  // of INA_LatestTable definition
+#if defined(INA_BACKGROUND)
+class INA_BackgroundSampler {
+  /*!
+   * @class   INA_BackgroundSampler
+   * @brief   Samples each device at its own rate on a FreeRTOS task or, on Linux, a std::thread
+   * @details The scheduling core run() reads the devices whose readings are due, earliest
+   *          deadline first, and passes them on to an INA_SampleRing, an INA_LatestTable and a
+   *          callback function, whichever are set. A reading's deadline is the time the next one
+   *          is due. setPeriod() refuses periods which would need more than
+   *          INA_SCHEDULE_UTILIZATION percent of the bus time, see "getReadMicros()". The missed
+   *          deadlines counted are modelled from that bus time rather than measured, see "run()".
+   *          start() runs the core in a loop on its own task, which then owns the bus: the
+   *          INA_Class instance must not be used by any other task until stop() returns. The
+   *          periods can be changed with setPeriod() from any task while the sampler runs. The
+   *          ring, table and callback are only to be set while it is stopped
+   */
+ public:
+  INA_BackgroundSampler(INA_Class& ina);
+  ~INA_BackgroundSampler();
+  uint8_t  begin(const uint32_t periodMicros = 100000);
+  bool     setPeriod(const uint8_t deviceNumber, const uint32_t periodMicros);
+  uint32_t getPeriod(const uint8_t deviceNumber) const;
+  uint8_t  getUtilization() const;
+  bool     readScheduleStats(inaScheduleStats& stats, const uint8_t deviceNumber,
+                             const bool reset = false);
+  void     setRing(INA_SampleRing* ring);
+  void     setTable(INA_LatestTable* table);
+  void     setCallback(inaSampleCallback callback);
+  uint32_t run(const uint32_t nowMicros);
+  #if defined(INA_LINUX)
+  bool start();
+  #else
+  bool start(const BaseType_t core = tskNO_AFFINITY, const UBaseType_t priority = 1,
+             const uint32_t stackSize = 4096);
+  #endif
+  void stop();
+  bool running() const;
+
+ private:
+  static void       task(void* parameter);
+  uint32_t          utilization(const uint8_t skipDevice) const;
+  INA_Class&        _ina;                 ///< Instance owning the devices
+  uint8_t           _deviceCount{0};      ///< Number of entries in _schedule
+  inaSchedule*      _schedule{nullptr};   ///< Dynamic array with the schedule of each device
+  INA_SampleRing*   _ring{nullptr};       ///< Receives the raw samples when set
+  INA_LatestTable*  _table{nullptr};      ///< Receives the readings when set
+  inaSampleCallback _callback{nullptr};   ///< Called with the readings when set
+  bool              _run{false};          ///< Cleared by stop() to end the task
+  uint32_t          _nowMicros{0};        ///< Time of the last run(), for the achieved rates
+  #if defined(INA_LINUX)
+  std::thread _thread;  ///< Thread running task()
+  #else
+  TaskHandle_t _task{nullptr};  ///< FreeRTOS task running task(), cleared when it ends
+  #endif
+};  // of INA_BackgroundSampler definition
+#endif
 #endif
@@ -0,0 +1,604 @@
+/*!
+ * @file INA_Simulator.cpp
+ *
+ * @section INA_Simulator_intro_section Description
+ *
+ * Simulated INA devices for testing the INA library without hardware\n\n
+ * See main library header file "INA.h" for details and license information
+ *
+ */
+#include <INA_Simulator.h>  ///< Include the simulator definition
+/*! Conversion times in microseconds of the INA226, INA230, INA231, INA260 and INA3221 */
+static const uint16_t INA226_CONVERSION_MICROS[8]{140, 204, 332, 588, 1100, 2116, 4156, 8244};
+/*! Conversion times in microseconds of the INA228 */
+static const uint16_t INA228_CONVERSION_MICROS[8]{50, 84, 150, 280, 540, 1052, 2074, 4120};
+/*! INA219 conversion times in microseconds of the BADC and SADC settings 0-15 */
+static const uint32_t INA219_CONVERSION_MICROS[16]{84,  148,  276,  532,  84,   148,   276,   532,
+                                                   532, 1060, 2130, 4260, 8510, 17020, 34050, 68100};
+/*! Number of averages of the averaging settings of all types except the INA219 */
+static const uint16_t AVERAGES[8]{1, 4, 16, 64, 128, 256, 512, 1024};
+static int32_t clampValue(const int64_t value, const int32_t minimum, const int32_t maximum,
+                          bool &overflow) {
+  /*! @brief     Limit a value to the range of a register
+      @param[in] value Value to limit
+      @param[in] minimum Smallest value of the register
+      @param[in] maximum Largest value of the register
+      @param[in,out] overflow Set when the value was out of range, left unchanged otherwise
+      @return    Limited value */
+  if (value < minimum) {
+    overflow = true;
+    return minimum;
+  }  // of if-then value too small
+  if (value > maximum) {
+    overflow = true;
+    return maximum;
+  }  // of if-then value too large
+  return (int32_t)value;
+}  // of function clampValue()
+bool INA_Simulator::addDevice(const uint8_t deviceAddress, const uint8_t type) {
+  /*! @brief     Adds a simulated device to the bus
+      @details   The device starts with its power-on reset register values and converting
+                 continuously. Any of the INA3221_0, INA3221_1 and INA3221_2 types adds an INA3221
+      @param[in] deviceAddress I2C address of the device
+      @param[in] type Device type, see "ina_Type"
+      @return    false if the simulator is full, the address is in use or the type is unknown */
+  if (_deviceCount >= INA_SIM_MAX_DEVICES || type >= INA_UNKNOWN) return false;
+  if (findDevice(deviceAddress) != nullptr) return false;  // Address already used
+  inaSimDevice &device = _devices[_deviceCount++];
+  device                 = inaSimDevice();                   // Inputs all start at 0
+  device.type            = (type >= INA3221_0) ? (uint8_t)INA3221_0 : type;
+  device.address         = deviceAddress;
+  device.dieMilliCelsius = 25000;  // Room temperature
+  resetDevice(device);
+  return true;
+}  // of method addDevice()
+bool INA_Simulator::setInputs(const uint8_t deviceAddress, const int32_t busMicroVolts,
+                              const int32_t shuntNanoVolts, const uint8_t channel) {
+  /*! @brief     Sets the voltages the device measures
+      @details   The values are used from the next conversion to finish on. The INA260 measures
+                 the voltage across its 2 milli-Ohm internal shunt, so 1A is 2000000nV
+      @param[in] deviceAddress I2C address of the device
+      @param[in] busMicroVolts Bus voltage in microvolts
+      @param[in] shuntNanoVolts Shunt voltage in nanovolts
+      @param[in] channel INA3221 channel 0-2, has to be 0 for all other types
+      @return    false if there is no device at the address or the channel doesn't exist */
+  inaSimDevice *device = findDevice(deviceAddress);
+  if (device == nullptr || channel > (device->type == INA3221_0 ? 2 : 0)) return false;
+  update(*device);  // Conversions already finished use the old values
+  device->busMicroVolts[channel]  = busMicroVolts;
+  device->shuntNanoVolts[channel] = shuntNanoVolts;
+  return true;
+}  // of method setInputs()
+bool INA_Simulator::setDieTemperature(const uint8_t deviceAddress, const int32_t milliCelsius) {
+  /*! @brief     Sets the die temperature the INA228 measures, the default is 25 degrees
+      @param[in] deviceAddress I2C address of the device
+      @param[in] milliCelsius Temperature in thousandths of a degree Celsius
+      @return    false if there is no INA228 at the address */
+  inaSimDevice *device = findDevice(deviceAddress);
+  if (device == nullptr || device->type != INA228) return false;
+  update(*device);
+  device->dieMilliCelsius = milliCelsius;
+  return true;
+}  // of method setDieTemperature()
+bool INA_Simulator::alertAsserted(const uint8_t deviceAddress) {
+  /*! @brief     Returns the state of the device's alert pin
+      @details   The INA219 has no alert pin. The INA3221 pin is the combination of its critical
+                 and warning pins. The polarity bits are ignored
+      @param[in] deviceAddress I2C address of the device
+      @return    true when the alert is active */
+  inaSimDevice *device = findDevice(deviceAddress);
+  if (device == nullptr) return false;
+  update(*device);
+  const uint32_t *registers = device->registers;
+  switch (device->type) {
+    case INA219: return false;
+    case INA228:
+      return (registers[0xB] & 0x0EFC) ||  // Overflow and limit flags
+             ((registers[0xB] & 0x4000) && (registers[0xB] & 0x0002));  // Conversion ready
+    case INA3221_0: return (registers[INA3221_MASK_REGISTER] & 0x03F8) != 0;  // CF, SF and WF
+    default:
+      return (registers[INA_MASK_ENABLE_REGISTER] & 0x0010) ||  // Alert function flag
+             ((registers[INA_MASK_ENABLE_REGISTER] & 0x0400) &&
+              (registers[INA_MASK_ENABLE_REGISTER] & 0x0008));  // Conversion ready
+  }  // of switch type
+}  // of method alertAsserted()
+uint32_t INA_Simulator::getConversionMicros(const uint8_t deviceAddress) {
+  /*! @brief     Returns how long a conversion takes with the device's current settings
+      @param[in] deviceAddress I2C address of the device
+      @return    Conversion time in microseconds, 0 if there is no device or it is shut down */
+  inaSimDevice *device = findDevice(deviceAddress);
+  if (device == nullptr) return 0;
+  return conversionMicros(*device);
+}  // of method getConversionMicros()
+void INA_Simulator::advance(const uint32_t microSeconds) {
+  /*! @brief     Advances the virtual clock, e.g. to let conversions finish
+      @param[in] microSeconds Time to advance by */
+  _nanos += (uint64_t)microSeconds * 1000;
+}  // of method advance()
+uint64_t INA_Simulator::getNanos() const {
+  /*! @brief     Returns the virtual clock
+      @return    Nanoseconds since the simulator was created */
+  return _nanos;
+}  // of method getNanos()
+uint32_t INA_Simulator::getTransactions() const {
+  /*! @brief     Returns the number of I2C transactions since the last resetCounters() call
+      @return    Number of transactions */
+  return _transactions;
+}  // of method getTransactions()
+uint32_t INA_Simulator::getBytes() const {
+  /*! @brief     Returns the number of bytes transferred since the last resetCounters() call
+      @details   The address byte of each transaction is included
+      @return    Number of bytes */
+  return _bytes;
+}  // of method getBytes()
+void INA_Simulator::resetCounters() {
+  /*! @brief     Sets the transaction and byte counts to 0 */
+  _transactions = 0;
+  _bytes        = 0;
+}  // of method resetCounters()
+void INA_Simulator::begin() {
+  /*! @brief     Nothing to initialize, the devices are added with addDevice() */
+}  // of method begin()
+void INA_Simulator::setClock(const uint32_t clockSpeed) {
+  /*! @brief     Sets the bus speed used to compute how long the transactions take
+      @param[in] clockSpeed Speed in Herz */
+  if (clockSpeed != 0) _clockSpeed = clockSpeed;
+}  // of method setClock()
+uint8_t INA_Simulator::write(const uint8_t deviceAddress, const uint8_t *data,
+                             const uint8_t length) {
+  /*! @brief     Writes bytes to a simulated device
+      @details   The first byte sets the register pointer and the next 2 are written to the register
+      @param[in] deviceAddress I2C address of the device
+      @param[in] data Bytes to write
+      @param[in] length Number of bytes, 0 just addresses the device
+      @return    0 on success, 2 when there is no device at the address */
+  inaSimDevice *device = findDevice(deviceAddress);
+  busTransaction(device != nullptr ? length : 0);  // No data is sent after an address NAK
+  if (device == nullptr) return 2;
+  if (length >= 1) device->pointer = data[0];
+  if (length >= 3) writeRegisterValue(*device, device->pointer, (data[1] << 8) | data[2]);
+  return 0;
+}  // of method write()
+uint8_t INA_Simulator::read(const uint8_t deviceAddress, uint8_t *data, const uint8_t length) {
+  /*! @brief     Reads the register the device's register pointer points to
+      @details   The register is sent MSB first, bytes read beyond its width are 0xFF. A read from
+                 the SMBus Alert Response Address is answered by the alerting INA226, INA230,
+                 INA231 or INA260 with the lowest address, which wins the bus arbitration, with its
+                 address in the upper 7 bits. The response doesn't release the alert
+      @param[in] deviceAddress I2C address of the device
+      @param[out] data Buffer for the bytes read
+      @param[in] length Number of bytes to read
+      @return    Number of bytes read, 0 when there is no device at the address */
+  if (deviceAddress == INA_ALERT_RESPONSE_ADDRESS) {
+    uint8_t responder{UINT8_MAX};  // Lowest address of an alerting device
+    for (uint8_t i = 0; i < _deviceCount; i++) {
+      uint8_t type = _devices[i].type;
+      if ((type == INA226 || type == INA230 || type == INA231 || type == INA260) &&
+          _devices[i].address < responder && alertAsserted(_devices[i].address)) {
+        responder = _devices[i].address;
+      }  // of if-then an alerting device with a lower address
+    }    // for-next each device
+    busTransaction(responder != UINT8_MAX ? length : 0);
+    if (responder == UINT8_MAX || length == 0) return 0;
+    data[0] = responder << 1;
+    for (uint8_t i = 1; i < length; i++) data[i] = 0xFF;
+    return length;
+  }  // of if-then Alert Response Address
+  inaSimDevice *device = findDevice(deviceAddress);
+  busTransaction(device != nullptr ? length : 0);
+  if (device == nullptr) return 0;
+  uint8_t  width = registerWidth(*device, device->pointer);
+  uint64_t value = readRegisterValue(*device, device->pointer);
+  for (uint8_t i = 0; i < length; i++) {
+    data[i] = (i < width) ? (uint8_t)(value >> (8 * (width - 1 - i))) : 0xFF;
+  }  // for-next each byte
+  return length;
+}  // of method read()
+inaSimDevice *INA_Simulator::findDevice(const uint8_t deviceAddress) {
+  /*! @brief     Returns the simulated device at an address
+      @param[in] deviceAddress I2C address of the device
+      @return    Pointer to the device, nullptr if there is none */
+  for (uint8_t i = 0; i < _deviceCount; i++) {
+    if (_devices[i].address == deviceAddress) return &_devices[i];
+  }  // for-next each device
+  return nullptr;
+}  // of method findDevice()
+void INA_Simulator::busTransaction(const uint8_t bytes) {
+  /*! @brief     Counts a transaction and advances the virtual clock by the time it takes
+      @details   A transaction is a start bit, the address and data bytes with their acknowledge
+                 bits and a stop bit
+      @param[in] bytes Number of data bytes */
+  _transactions++;
+  _bytes += bytes + 1;
+  _nanos += ((uint64_t)(bytes + 1) * 9 + 2) * 1000000000 / _clockSpeed;
+}  // of method busTransaction()
+void INA_Simulator::resetDevice(inaSimDevice &device) {
+  /*! @brief     Sets the power-on reset values of the device's registers and starts converting
+      @param[in,out] device Device to reset */
+  uint32_t *registers = device.registers;
+  for (uint8_t i = 0; i < INA_SIM_REGISTERS; i++) registers[i] = 0;
+  device.pointer = INA_CONFIGURATION_REGISTER;
+  device.energy  = 0;
+  device.charge  = 0;
+  switch (device.type) {
+    case INA219: registers[INA_CONFIGURATION_REGISTER] = 0x399F; break;
+    case INA228:
+      registers[0x01] = 0xFB68;  // ADC_CONFIG, continuous bus, shunt and temperature
+      registers[0x02] = 0x1000;  // SHUNT_CAL
+      registers[0x0B] = 0x0001;  // DIAG_ALRT, MEMSTAT
+      registers[0x0C] = 0x7FFF;  // SOVL
+      registers[0x0D] = 0x8000;  // SUVL
+      registers[0x0E] = 0x7FFF;  // BOVL
+      registers[0x10] = 0x7FFF;  // TEMP_LIMIT
+      registers[0x11] = 0xFFFF;  // PWR_LIMIT
+      break;
+    case INA260: registers[INA_CONFIGURATION_REGISTER] = 0x6127; break;
+    case INA3221_0:
+      registers[INA_CONFIGURATION_REGISTER] = 0x7127;
+      for (uint8_t i = 0x07; i <= 0x0C; i++) registers[i] = 0x7FF8;  // Critical & warning limits
+      registers[0x0E]                  = 0x7FFE;                   // Shunt-voltage sum limit
+      registers[INA3221_MASK_REGISTER] = 0x0002;                   // Timing control flag
+      registers[0x10]                  = 0x2710;                   // Power-valid upper limit
+      registers[0x11]                  = 0x2328;                   // Power-valid lower limit
+      break;
+    default: registers[INA_CONFIGURATION_REGISTER] = 0x4127;  // INA226, INA230 and INA231
+  }  // of switch type
+  startConversion(device);
+}  // of method resetDevice()
+void INA_Simulator::startConversion(inaSimDevice &device, const uint32_t delayMicros) {
+  /*! @brief     Starts a conversion, aborting one which is still running
+      @param[in,out] device Device to start
+      @param[in] delayMicros Delay before the conversion starts */
+  uint32_t duration    = conversionMicros(device);
+  device.converting    = duration != 0;  // Nothing is converted when shut down
+  device.conversionEnd = _nanos + ((uint64_t)delayMicros + duration) * 1000;
+}  // of method startConversion()
+void INA_Simulator::update(inaSimDevice &device) {
+  /*! @brief     Finishes the conversions which the virtual clock has passed
+      @details   In continuous mode the next conversion starts when one finishes, in triggered mode
+                 the device then waits for the next write to its configuration register
+      @param[in,out] device Device to update */
+  if (!device.converting || device.conversionEnd > _nanos) return;
+  uint64_t duration   = conversionMicros(device);
+  uint64_t count      = 1;  // Number of conversions finished
+  bool     continuous = (device.type == INA228) ? (device.registers[0x01] & 0x8000)  // MODE bit 3
+                                                : (device.registers[0] & 4);        // MODE bit 2
+  if (continuous) {
+    count += (_nanos - device.conversionEnd) / (duration * 1000);
+    device.conversionEnd += count * duration * 1000;
+  } else {
+    device.converting = false;
+  }  // of if-then-else continuous mode
+  latchResults(device, count * duration);
+}  // of method update()
+void INA_Simulator::latchResults(inaSimDevice &device, const uint64_t elapsedMicros) {
+  /*! @brief     Stores the results of a finished conversion and sets the ready and alert flags
+      @details   Only the values enabled by the operating mode are converted, the others keep
+                 their last value. The results are truncated to the register LSB and limited to
+                 the register range
+      @param[in,out] device Device which finished converting
+      @param[in] elapsedMicros Time since the last conversion finished, for the accumulators */
+  uint32_t *registers = device.registers;
+  uint16_t  config    = registers[INA_CONFIGURATION_REGISTER];
+  uint8_t   mode      = config & INA_CONFIG_MODE_MASK;
+  bool      overflow  = false;
+  switch (device.type) {
+    case INA219: {
+      int32_t  shunt   = (int16_t)registers[INA219_SHUNT_VOLTAGE_REGISTER];
+      uint16_t busRaw  = registers[INA_BUS_VOLTAGE_REGISTER] >> 3;
+      int32_t  range   = 4000L << ((config >> INA219_PG_FIRST_BIT) & 3);  // 40-320mV in 10uV
+      bool     clipped = false;  // Saturated inputs don't set the math overflow flag
+      if (mode & 1) shunt = clampValue(device.shuntNanoVolts[0] / 10000, -range, range, clipped);
+      if (mode & 2) {
+        busRaw = clampValue(device.busMicroVolts[0] / 4000, 0,
+                            bitRead(config, INA219_BRNG_BIT) ? 8191 : 4000, clipped);
+      }  // of if-then bus converted
+      int32_t current =
+          clampValue((int64_t)shunt * registers[INA_CALIBRATION_REGISTER] / 4096, INT16_MIN,
+                     INT16_MAX, overflow);
+      uint16_t power = clampValue((int64_t)(current < 0 ? -current : current) * busRaw / 5000, 0,
+                                  UINT16_MAX, overflow);
+      registers[INA219_SHUNT_VOLTAGE_REGISTER] = (uint16_t)shunt;
+      registers[INA_BUS_VOLTAGE_REGISTER]      = (busRaw << 3) | 2 | (overflow ? 1 : 0);  // CNVR
+      registers[INA_POWER_REGISTER]            = power;
+      registers[INA219_CURRENT_REGISTER]       = (uint16_t)current;
+      break;
+    }  // of INA219
+    case INA228: {
+      uint16_t adcConfig = registers[0x01];
+      int32_t  shunt     = (int32_t)(registers[0x04] << 8) >> 12;  // Sign extend 20 bits
+      int32_t  busRaw    = registers[0x05] >> 4;
+      bool     clipped   = false;
+      if (adcConfig & 0x2000) {  // Shunt converted, 312.5nV or 78.125nV LSB with ADCRANGE
+        shunt = clampValue((int64_t)device.shuntNanoVolts[0] * ((config & 0x10) ? 8 : 2) / 625,
+                           -524288, 524287, clipped);
+      }                          // of if-then shunt converted
+      if (adcConfig & 0x1000) {  // Bus converted, 195.3125uV LSB
+        busRaw = clampValue((int64_t)device.busMicroVolts[0] * 16 / 3125, 0, 524287, clipped);
+      }                          // of if-then bus converted
+      if (adcConfig & 0x4000) {  // Temperature converted, 7.8125 milli-degree LSB
+        registers[0x06] = (uint16_t)clampValue((int64_t)device.dieMilliCelsius * 16 / 125,
+                                               INT16_MIN, INT16_MAX, clipped);
+      }  // of if-then temperature converted
+      uint16_t calibration = registers[0x02];
+      int32_t  current =
+          calibration ? clampValue((int64_t)shunt * 4096 / calibration, -524288, 524287, overflow)
+                       : 0;
+      uint32_t power = clampValue((int64_t)(current < 0 ? -current : current) * busRaw / 16384, 0,
+                                  0xFFFFFF, overflow);
+      registers[0x04] = ((uint32_t)shunt & 0xFFFFF) << 4;
+      registers[0x05] = (uint32_t)busRaw << 4;
+      registers[0x07] = ((uint32_t)current & 0xFFFFF) << 4;
+      registers[0x08] = power;
+      device.energy += (int64_t)power * elapsedMicros;  // ENERGY = sum(POWER * seconds) / 16
+      device.charge += (int64_t)current * elapsedMicros;  // CHARGE = sum(CURRENT * seconds)
+      uint16_t diagnostics = registers[0x0B];  // ENERGYOF isn't modelled, at full scale the
+                                               // ENERGY register takes 12 days to overflow
+      if (device.charge >= (int64_t)1000000 << 39 || device.charge < -((int64_t)1000000 << 39)) {
+        device.charge += (device.charge < 0 ? 1 : -1) * ((int64_t)1000000 << 40);
+        diagnostics |= 0x0400;  // CHARGEOF
+      }                         // of if-then charge overflow
+      uint16_t alerts{0};
+      if (shunt / 16 > (int16_t)registers[0x0C]) alerts |= 0x0040;       // SHNTOL
+      if (shunt / 16 < (int16_t)registers[0x0D]) alerts |= 0x0020;       // SHNTUL
+      if (busRaw / 16 > (int32_t)registers[0x0E]) alerts |= 0x0010;      // BUSOL
+      if (busRaw / 16 < (int32_t)registers[0x0F]) alerts |= 0x0008;      // BUSUL
+      if (power / 256 > registers[0x11]) alerts |= 0x0004;               // POL
+      if ((int16_t)registers[0x06] > (int16_t)registers[0x10]) alerts |= 0x0080;  // TMPOL
+      if (!(diagnostics & 0x8000)) diagnostics &= ~0x00FC;  // Transparent, flags follow values
+      diagnostics = (diagnostics & ~0x0200) | alerts | (overflow ? 0x0200 : 0) | 0x0002;  // CNVRF
+      registers[0x0B] = diagnostics;
+      break;
+    }  // of INA228
+    case INA3221_0: {
+      uint16_t mask = registers[INA3221_MASK_REGISTER];
+      uint16_t critical{0}, warning{0};
+      int32_t  sum{0};
+      bool     allValid{true}, anyInvalid{false};
+      for (uint8_t channel = 0; channel < 3; channel++) {
+        if (!(config & (0x4000 >> channel))) continue;  // Channel disabled
+        uint8_t shuntRegister = INA3221_SHUNT_VOLTAGE_REGISTER + channel * 2;
+        if (mode & 1) {  // 40uV LSB in bits 3-15
+          registers[shuntRegister] = (uint16_t)(
+              clampValue(device.shuntNanoVolts[channel] / 40000, -4096, 4095, overflow) * 8);
+        }                // of if-then shunt converted
+        if (mode & 2) {  // 8mV LSB in bits 3-15
+          registers[shuntRegister + 1] = (uint16_t)(
+              clampValue(device.busMicroVolts[channel] / 8000, -4096, 4095, overflow) * 8);
+        }  // of if-then bus converted
+        int16_t shunt = (int16_t)registers[shuntRegister] / 8;
+        int16_t bus   = (int16_t)registers[shuntRegister + 1] / 8;
+        if (shunt > (int16_t)registers[0x07 + channel * 2] / 8) critical |= 0x0200 >> channel;
+        if (shunt > (int16_t)registers[0x08 + channel * 2] / 8) warning |= 0x0020 >> channel;
+        if (mask & (0x4000 >> channel)) sum += shunt;  // Channel included in the sum
+        if (bus <= (int16_t)registers[0x10] / 8) allValid = false;
+        if (bus < (int16_t)registers[0x11] / 8) anyInvalid = true;
+      }  // for-next each channel
+      sum              = clampValue(sum, -16384, 16383, overflow);
+      registers[0x0D]  = (uint16_t)(sum * 2);  // 40uV LSB in bits 1-15
+      if (sum > (int16_t)registers[0x0E] / 2) critical |= 0x0040;  // Summation alert flag
+      if (!(mask & 0x0400)) mask &= ~0x03C0;  // Critical alerts not latched
+      if (!(mask & 0x0800)) mask &= ~0x0038;  // Warning alerts not latched
+      if (allValid) mask |= 0x0004;           // Power-valid flag
+      if (anyInvalid) mask &= ~0x0004;
+      registers[INA3221_MASK_REGISTER] = mask | critical | warning | 0x0001;  // CVRF
+      break;
+    }  // of INA3221
+    default: {  // INA226, INA230, INA231 and INA260
+      int32_t  shunt   = (int16_t)registers[1];  // Shunt voltage, current for the INA260
+      uint16_t busRaw  = registers[INA_BUS_VOLTAGE_REGISTER];
+      bool     clipped = false;
+      if (mode & 1) {
+        shunt = clampValue(device.shuntNanoVolts[0] / 2500, INT16_MIN, INT16_MAX, clipped);
+      }  // of if-then shunt converted
+      if (mode & 2) busRaw = clampValue(device.busMicroVolts[0] / 1250, 0, INT16_MAX, clipped);
+      int32_t current = shunt;  // The INA260 measures the current directly
+      if (device.type != INA260) {
+        current = clampValue((int64_t)shunt * registers[INA_CALIBRATION_REGISTER] / 2048,
+                             INT16_MIN, INT16_MAX, overflow);
+        registers[INA226_CURRENT_REGISTER] = (uint16_t)current;
+      }  // of if-then not an INA260
+      uint16_t power =
+          clampValue((int64_t)(current < 0 ? -current : current) * busRaw /
+                         (device.type == INA260 ? 6400 : 20000),
+                     0, UINT16_MAX, overflow);
+      registers[1]                        = (uint16_t)shunt;
+      registers[INA_BUS_VOLTAGE_REGISTER] = busRaw;
+      registers[INA_POWER_REGISTER]       = power;
+      uint16_t mask  = registers[INA_MASK_ENABLE_REGISTER];
+      uint16_t limit = registers[INA_ALERT_LIMIT_REGISTER];
+      bool     alert{false};  // Only the highest enabled alert function is used
+      if (mask & 0x8000) {
+        alert = shunt > (int16_t)limit;  // Shunt over-voltage, over-current on the INA260
+      } else if (mask & 0x4000) {
+        alert = shunt < (int16_t)limit;  // Shunt under-voltage, under-current on the INA260
+      } else if (mask & 0x2000) {
+        alert = busRaw > limit;  // Bus over-voltage
+      } else if (mask & 0x1000) {
+        alert = busRaw < limit;  // Bus under-voltage
+      } else if (mask & 0x0800) {
+        alert = power > limit;  // Power over-limit
+      }                         // of if-then-else alert functions
+      if (!(mask & 0x0001)) mask &= ~0x0010;  // Transparent mode, flag follows the last result
+      mask = (mask & ~0x0004) | (alert ? 0x0010 : 0) | (overflow ? 0x0004 : 0) | 0x0008;  // CVRF
+      registers[INA_MASK_ENABLE_REGISTER] = mask;
+    }  // of INA226, INA230, INA231 and INA260
+  }    // of switch type
+}  // of method latchResults()
+uint32_t INA_Simulator::conversionMicros(const inaSimDevice &device) const {
+  /*! @brief     Computes how long a conversion takes with the device's current settings
+      @details   The conversion time is the sum of the conversion times of the enabled values
+                 multiplied by the number of averages, the INA3221 converts each enabled channel
+      @param[in] device Device to compute the time for
+      @return    Conversion time in microseconds, 0 when shut down */
+  uint16_t config = device.registers[INA_CONFIGURATION_REGISTER];
+  uint32_t duration{0};
+  switch (device.type) {
+    case INA219:
+      if (config & 1) duration += INA219_CONVERSION_MICROS[(config >> 3) & 0xF];  // SADC
+      if (config & 2) duration += INA219_CONVERSION_MICROS[(config >> 7) & 0xF];  // BADC
+      break;
+    case INA228: {
+      uint16_t adcConfig = device.registers[0x01];
+      if (adcConfig & 0x1000) duration += INA228_CONVERSION_MICROS[(adcConfig >> 9) & 7];  // VBUSCT
+      if (adcConfig & 0x2000) duration += INA228_CONVERSION_MICROS[(adcConfig >> 6) & 7];  // VSHCT
+      if (adcConfig & 0x4000) duration += INA228_CONVERSION_MICROS[(adcConfig >> 3) & 7];  // VTCT
+      duration *= AVERAGES[adcConfig & 7];
+      break;
+    }  // of INA228
+    default:  // INA226, INA230, INA231, INA260 and INA3221 share the register layout
+      if (config & 1) duration += INA226_CONVERSION_MICROS[(config >> 3) & 7];  // Shunt
+      if (config & 2) duration += INA226_CONVERSION_MICROS[(config >> 6) & 7];  // Bus
+      duration *= AVERAGES[(config >> 9) & 7];
+      if (device.type == INA3221_0) {
+        duration *= ((config >> 14) & 1) + ((config >> 13) & 1) + ((config >> 12) & 1);
+      }  // of if-then each enabled INA3221 channel converted
+  }      // of switch type
+  return duration;
+}  // of method conversionMicros()
+uint8_t INA_Simulator::registerWidth(const inaSimDevice &device, const uint8_t reg) const {
+  /*! @brief     Returns the number of bytes of a register
+      @param[in] device Device the register belongs to
+      @param[in] reg Register number
+      @return    Width in bytes, only the INA228 has registers wider than 2 bytes */
+  if (device.type == INA228) {
+    if (reg == 0x04 || reg == 0x05 || reg == 0x07 || reg == 0x08) return 3;
+    if (reg == 0x09 || reg == 0x0A) return 5;
+  }  // of if-then an INA228
+  return 2;
+}  // of method registerWidth()
+uint64_t INA_Simulator::readRegisterValue(inaSimDevice &device, const uint8_t reg) {
+  /*! @brief     Returns a register's value, clearing the flags which are cleared by reading it
+      @details   Registers which the device doesn't have read as 0. The INA230 and INA231 have no
+                 die ID register, "begin()" tells them apart by register 0xFF reading as non-zero
+                 on an INA230, which the model follows
+      @param[in,out] device Device to read
+      @param[in] reg Register number
+      @return    Register value */
+  update(device);
+  uint32_t *registers = device.registers;
+  uint64_t  value{0};
+  switch (device.type) {
+    case INA219:
+      if (reg <= INA_CALIBRATION_REGISTER) value = registers[reg];
+      if (reg == INA_POWER_REGISTER) registers[INA_BUS_VOLTAGE_REGISTER] &= ~2;  // Clear CNVR
+      break;
+    case INA228:
+      if (reg == 0x09) {
+        value = (uint64_t)device.energy / 16000000;
+        registers[0x0B] &= ~0x0800;  // Clear ENERGYOF
+      } else if (reg == 0x0A) {
+        value = (uint64_t)(device.charge / 1000000) & 0xFFFFFFFFFFULL;  // 40 bit 2's complement
+        registers[0x0B] &= ~0x0400;                                     // Clear CHARGEOF
+      } else if (reg == 0x3E) {
+        value = 0x5449;  // Manufacturer ID "TI"
+      } else if (reg == INA228_DIE_ID_REGISTER) {
+        value = 0x2281;  // Device 0x228, revision 1
+      } else if (reg < INA_SIM_REGISTERS) {
+        value = registers[reg];
+      }  // of if-then-else register
+      if (reg == 0x0B) {
+        registers[0x0B] &= ~0x0002;                                // Clear CNVRF
+        if (registers[0x0B] & 0x8000) registers[0x0B] &= ~0x00FC;  // Clear latched alerts
+      }  // of if-then DIAG_ALRT read
+      break;
+    case INA3221_0:
+      if (reg < INA_SIM_REGISTERS) value = registers[reg];
+      if (reg == INA_MANUFACTURER_ID_REGISTER) value = 0x5449;
+      if (reg == INA_DIE_ID_REGISTER) value = 0x3220;
+      if (reg == INA3221_MASK_REGISTER) {
+        uint16_t mask = registers[INA3221_MASK_REGISTER] & ~0x0001;  // Clear CVRF
+        if (mask & 0x0400) mask &= ~0x03C0;                          // Clear latched critical
+        if (mask & 0x0800) mask &= ~0x0038;                          // Clear latched warning
+        registers[INA3221_MASK_REGISTER] = mask;
+      }  // of if-then mask register read
+      break;
+    default:  // INA226, INA230, INA231 and INA260
+      if (reg <= INA_ALERT_LIMIT_REGISTER) value = registers[reg];
+      if (reg == INA_MANUFACTURER_ID_REGISTER && (device.type == INA226 || device.type == INA260)) {
+        value = 0x5449;
+      }  // of if-then manufacturer ID
+      if (reg == INA_DIE_ID_REGISTER) {
+        switch (device.type) {
+          case INA226: value = INA226_DIE_ID_VALUE; break;
+          case INA230: value = 0xFFFF; break;
+          case INA260: value = 0x2270; break;
+        }  // of switch type
+      }    // of if-then die ID
+      if (reg == INA_MASK_ENABLE_REGISTER) {
+        uint16_t mask = registers[INA_MASK_ENABLE_REGISTER] & ~0x0008;  // Clear CVRF
+        if (mask & 0x0001) mask &= ~0x0010;  // Clear latched alert function flag
+        registers[INA_MASK_ENABLE_REGISTER] = mask;
+      }  // of if-then mask register read
+  }      // of switch type
+  return value;
+}  // of method readRegisterValue()
+void INA_Simulator::writeRegisterValue(inaSimDevice &device, const uint8_t reg,
+                                       const uint16_t value) {
+  /*! @brief     Writes a register, read-only bits and registers are left unchanged
+      @details   Setting the reset bit of the configuration register resets the device. Writing
+                 the configuration register, the ADC_CONFIG register on the INA228, clears the
+                 conversion ready flag and restarts the conversion
+      @param[in,out] device Device to write
+      @param[in] reg Register number
+      @param[in] value Value to write */
+  update(device);
+  uint32_t *registers = device.registers;
+  if (reg == INA_CONFIGURATION_REGISTER && (value & INA_RESET_DEVICE)) {
+    resetDevice(device);
+    return;
+  }  // of if-then reset
+  switch (device.type) {
+    case INA219:
+      if (reg == INA_CONFIGURATION_REGISTER) {
+        registers[reg] = value & 0x3FFF;
+        registers[INA_BUS_VOLTAGE_REGISTER] &= ~2;  // Clear CNVR
+        startConversion(device);
+      }  // of if-then configuration
+      if (reg == INA_CALIBRATION_REGISTER) registers[reg] = value & 0xFFFE;
+      break;
+    case INA228:
+      if (reg == INA_CONFIGURATION_REGISTER) {
+        if (value & 0x4000) device.energy = device.charge = 0;  // RSTACC
+        registers[reg] = value & 0x3FF0;
+      } else if (reg == 0x01) {
+        registers[reg] = value;
+        registers[0x0B] &= ~0x0002;                            // Clear CNVRF
+        startConversion(device, ((registers[0] >> 6) & 0xFF) * 2000UL);  // CONVDLY in 2ms steps
+      } else if (reg == 0x02) {
+        registers[reg] = value & 0x7FFF;
+      } else if (reg == 0x03) {
+        registers[reg] = value & 0x3FFF;
+      } else if (reg == 0x0B) {
+        registers[reg] = (value & 0xF000) | (registers[reg] & 0x0FFF);
+      } else if (reg >= 0x0C && reg <= 0x11) {
+        registers[reg] = value;
+      }  // of if-then-else register
+      break;
+    case INA3221_0:
+      if (reg == INA_CONFIGURATION_REGISTER) {
+        registers[reg] = value;
+        registers[INA3221_MASK_REGISTER] &= ~0x0001;  // Clear CVRF
+        startConversion(device);
+      } else if ((reg >= 0x07 && reg <= 0x0C) || reg == 0x10 || reg == 0x11) {
+        registers[reg] = value & 0xFFF8;
+      } else if (reg == 0x0E) {
+        registers[reg] = value & 0xFFFE;
+      } else if (reg == INA3221_MASK_REGISTER) {
+        registers[reg] = (value & 0x7C00) | (registers[reg] & 0x03FF);
+      }  // of if-then-else register
+      break;
+    default:  // INA226, INA230, INA231 and INA260
+      if (reg == INA_CONFIGURATION_REGISTER) {
+        registers[reg] = (value & 0x0FFF) | (registers[reg] & 0x7000);  // Bits 12-14 fixed
+        registers[INA_MASK_ENABLE_REGISTER] &= ~0x0008;                 // Clear CVRF
+        startConversion(device);
+      } else if (reg == INA_CALIBRATION_REGISTER && device.type != INA260) {
+        registers[reg] = value & 0x7FFF;
+      } else if (reg == INA_MASK_ENABLE_REGISTER) {
+        registers[reg] = (value & 0xFC03) | (registers[reg] & 0x001C);
+      } else if (reg == INA_ALERT_LIMIT_REGISTER) {
+        registers[reg] = value;
+      }  // of if-then-else register
+  }      // of switch type
+}  // of method writeRegisterValue()
@@ -0,0 +1,91 @@
+/*!
+ @file INA_Simulator.h
+
+ @brief Simulated INA devices for testing the INA library without hardware
+
+ @section INA_Simulator_intro_section Description
+
+ The INA_Simulator class is an INA_Transport which answers the I2C transactions of the INA_Class
+ with register-accurate models of the INA219, INA226, INA228, INA230, INA231, INA260 and INA3221
+ instead of sending them to a bus. Each model has the device's register map with its reset
+ values, the identification registers read by "begin()", conversions which take as long as the
+ averaging and conversion time settings in the configuration register dictate, and the
+ conversion ready and alert flags. The models run on a virtual clock which advances with the time
+ the transactions would take on the bus at the speed set with "setI2CSpeed()" and with calls to
+ "advance()", so tests using the simulator give the same results on every run.\n\n
+
+ The simulator is added to the library like any other bus:\n
+ INA_Simulator simulator;\n
+ simulator.addDevice(0x40, INA226);\n
+ simulator.setInputs(0x40, 12000000, 2500000);  // 12V bus, 2.5mV across the shunt\n
+ INA.addBus(simulator);\n
+ INA.begin(1, 100000);\n
+
+ See main library header file "INA.h" for details and license information
+*/
+#ifndef INA_Simulator_h
+/*! Guard code definition to prevent multiple includes */
+#define INA_Simulator_h
+#include <INA.h>  // INA Library definitions
+#ifndef INA_SIM_MAX_DEVICES
+  #define INA_SIM_MAX_DEVICES 16  ///< Devices per simulator, one for each address 0x40-0x4F
+#endif
+const uint8_t INA_SIM_REGISTERS{0x12};  ///< Registers 0x00-0x11 are modelled for all types
+/*! typedef contains the state of one simulated INA device */
+typedef struct {
+  uint8_t  type;                          ///< see enumerated "ina_Type", INA3221_0 for INA3221
+  uint8_t  address;                       ///< I2C address of the device
+  uint8_t  pointer;                       ///< Register pointer
+  bool     converting;                    ///< Set while a conversion is running
+  uint64_t conversionEnd;                 ///< Virtual time in ns when the conversion finishes
+  uint32_t registers[INA_SIM_REGISTERS];  ///< Register contents, up to 24 bits
+  int64_t  energy;                        ///< INA228 energy accumulator, POWER LSB * us
+  int64_t  charge;                        ///< INA228 charge accumulator, CURRENT LSB * us
+  int32_t  busMicroVolts[3];              ///< Input bus voltage of each channel
+  int32_t  shuntNanoVolts[3];             ///< Input shunt voltage of each channel
+  int32_t  dieMilliCelsius;               ///< Input die temperature, INA228 only
+} inaSimDevice;                           // of structure
+class INA_Simulator : public INA_Transport {
+  /*!
+   * @class   INA_Simulator
+   * @brief   INA_Transport with simulated INA devices
+   * @details Only one conversion result is latched when the virtual clock passes several
+   *          conversions at once, the INA228 accumulators still count all of them
+   */
+ public:
+  bool     addDevice(const uint8_t deviceAddress, const uint8_t type);
+  bool     setInputs(const uint8_t deviceAddress, const int32_t busMicroVolts,
+                     const int32_t shuntNanoVolts, const uint8_t channel = 0);
+  bool     setDieTemperature(const uint8_t deviceAddress, const int32_t milliCelsius);
+  bool     alertAsserted(const uint8_t deviceAddress);
+  uint32_t getConversionMicros(const uint8_t deviceAddress);
+  void     advance(const uint32_t microSeconds);
+  uint64_t getNanos() const;
+  uint32_t getTransactions() const;
+  uint32_t getBytes() const;
+  void     resetCounters();
+  void     begin();
+  void     setClock(const uint32_t clockSpeed);
+  uint8_t  write(const uint8_t deviceAddress, const uint8_t* data, const uint8_t length);
+  uint8_t  read(const uint8_t deviceAddress, uint8_t* data, const uint8_t length);
+
+ private:
+  inaSimDevice* findDevice(const uint8_t deviceAddress);
+  void          busTransaction(const uint8_t bytes);
+  void          resetDevice(inaSimDevice& device);
+  void          startConversion(inaSimDevice& device, const uint32_t delayMicros = 0);
+  void          update(inaSimDevice& device);
+  void          latchResults(inaSimDevice& device, const uint64_t elapsedMicros);
+  uint32_t      conversionMicros(const inaSimDevice& device) const;
+  uint8_t       registerWidth(const inaSimDevice& device, const uint8_t reg) const;
+  uint64_t      readRegisterValue(inaSimDevice& device, const uint8_t reg);
+  void          writeRegisterValue(inaSimDevice& device, const uint8_t reg,
+                              const uint16_t value);
+  uint32_t      _clockSpeed{INA_I2C_STANDARD_MODE};  ///< Bus speed used for the transaction time
+  uint64_t      _nanos{0};                           ///< Virtual clock in nanoseconds
+  uint32_t      _transactions{0};                    ///< Transactions since resetCounters()
+  uint32_t      _bytes{0};                           ///< Bytes since resetCounters()
+  uint8_t       _deviceCount{0};                     ///< Number of devices added
+  inaSimDevice  _devices[INA_SIM_MAX_DEVICES];       ///< State of the simulated devices
+};  // of INA_Simulator definition
+#endif